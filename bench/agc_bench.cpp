@@ -0,0 +1,96 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark of the AGC (CAgc) at the channel rates used by the receivers.
+ *
+ * The input is an AM modulated carrier with noise, processed in blocks of
+ * 4096 samples with the default settings of the narrow band receiver. The
+ * time per complex sample is printed for each rate.
+ *
+ * Usage: agc_bench [seconds of signal per rate]
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "dsp/agc_impl.h"
+
+#define BENCH_BLOCK 4096
+
+static double bench_rate(double rate, double seconds)
+{
+    std::vector<TYPECPX>    in((size_t)(rate * seconds));
+    std::vector<TYPECPX>    out(BENCH_BLOCK);
+    std::mt19937            gen(1);
+    std::normal_distribution<float> noise(0.f, 1.0e-3f);
+    CAgc                    agc;
+
+    // 1 kHz tone at 50% modulation on a carrier 3 kHz off centre
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        double t = i / rate;
+        float  a = 0.1f * (1.f + 0.5f * (float)sin(2.0 * M_PI * 1000.0 * t));
+        double p = 2.0 * M_PI * 3000.0 * t;
+
+        in[i] = TYPECPX(a * (float)cos(p) + noise(gen),
+                        a * (float)sin(p) + noise(gen));
+    }
+
+    agc.SetParameters(true, false, -100, 0, 0, 500, rate);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i + BENCH_BLOCK <= in.size(); i += BENCH_BLOCK)
+        agc.ProcessData(BENCH_BLOCK, &in[i], &out[0]);
+    auto stop = std::chrono::steady_clock::now();
+
+    size_t samples = in.size() - in.size() % BENCH_BLOCK;
+    std::chrono::duration<double, std::nano> ns = stop - start;
+
+    return ns.count() / samples;
+}
+
+int main(int argc, char **argv)
+{
+    const double rates[] = { 96000.0, 240000.0 };
+    double seconds = (argc > 1) ? atof(argv[1]) : 20.0;
+
+    if (seconds <= 0.0)
+    {
+        fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    for (double rate : rates)
+    {
+        double ns = bench_rate(rate, seconds);
+
+        printf("%6.0f kHz: %6.1f ns/sample, %5.2f%% of a core\n",
+               rate / 1000.0, ns, ns * rate * 1.0e-7);
+    }
+
+    return 0;
+}
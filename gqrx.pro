@@ -98,27 +98,36 @@ SOURCES += \
     src/applications/gqrx/file_resources.cpp \
     src/applications/gqrx/remote_control.cpp \
     src/applications/gqrx/remote_control_settings.cpp \
+    src/applications/gqrx/scanner.cpp \
     src/dsp/afsk1200/cafsk12.cpp \
     src/dsp/afsk1200/costabf.c \
     src/dsp/agc_impl.cpp \
     src/dsp/correct_iq_cc.cpp \
     src/dsp/filter/fir_decim.cpp \
     src/dsp/downconverter.cpp \
-    src/dsp/fm_deemph.cpp \
+    src/dsp/filter_designer.cpp \
+    src/dsp/fm_discriminator.cpp \
+    src/dsp/iq_format.cpp \
     src/dsp/lpf.cpp \
     src/dsp/rds/decoder_impl.cc \
     src/dsp/rds/parser_impl.cc \
     src/dsp/resampler_xx.cpp \
     src/dsp/rx_agc_xx.cpp \
+    src/dsp/rx_anf.cpp \
+    src/dsp/rx_channel_strip.cpp \
     src/dsp/rx_demod_am.cpp \
     src/dsp/rx_demod_fm.cpp \
     src/dsp/rx_fft.cpp \
     src/dsp/rx_filter.cpp \
     src/dsp/rx_meter.cpp \
     src/dsp/rx_noise_blanker_cc.cpp \
+    src/dsp/rx_nr.cpp \
     src/dsp/rx_rds.cpp \
+    src/dsp/rx_sql.cpp \
+    src/dsp/rx_sweep.cpp \
     src/dsp/sniffer_f.cpp \
     src/dsp/stereo_demod.cpp \
+    src/interfaces/async_file_sink.cpp \
     src/interfaces/udp_sink_f.cpp \
     src/qtgui/afsk1200win.cpp \
     src/qtgui/agc_options.cpp \
@@ -136,12 +145,14 @@ SOURCES += \
     src/qtgui/dockfft.cpp \
     src/qtgui/freqctrl.cpp \
     src/qtgui/ioconfig.cpp \
+    src/qtgui/iq_meta.cpp \
     src/qtgui/iq_tool.cpp \
     src/qtgui/meter.cpp \
     src/qtgui/nb_options.cpp \
     src/qtgui/plotter.cpp \
     src/qtgui/qtcolorpicker.cpp \
     src/receivers/nbrx.cpp \
+    src/receivers/nbrx_fused.cpp \
     src/receivers/receiver_base.cpp \
     src/receivers/wfmrx.cpp
 
@@ -151,6 +162,7 @@ HEADERS += \
     src/applications/gqrx/receiver.h \
     src/applications/gqrx/remote_control.h \
     src/applications/gqrx/remote_control_settings.h \
+    src/applications/gqrx/scanner.h \
     src/dsp/afsk1200/cafsk12.h \
     src/dsp/afsk1200/filter.h \
     src/dsp/afsk1200/filter-i386.h \
@@ -159,7 +171,9 @@ HEADERS += \
     src/dsp/filter/fir_decim.h \
     src/dsp/filter/fir_decim_coef.h \
     src/dsp/downconverter.h \
-    src/dsp/fm_deemph.h \
+    src/dsp/filter_designer.h \
+    src/dsp/fm_discriminator.h \
+    src/dsp/iq_format.h \
     src/dsp/lpf.h \
     src/dsp/rds/api.h \
     src/dsp/rds/parser.h \
@@ -170,15 +184,21 @@ HEADERS += \
     src/dsp/rds/tmc_events.h \
     src/dsp/resampler_xx.h \
     src/dsp/rx_agc_xx.h \
+    src/dsp/rx_anf.h \
+    src/dsp/rx_channel_strip.h \
     src/dsp/rx_demod_am.h \
     src/dsp/rx_demod_fm.h \
     src/dsp/rx_fft.h \
     src/dsp/rx_filter.h \
     src/dsp/rx_meter.h \
     src/dsp/rx_noise_blanker_cc.h \
+    src/dsp/rx_nr.h \
     src/dsp/rx_rds.h \
+    src/dsp/rx_sql.h \
+    src/dsp/rx_sweep.h \
     src/dsp/sniffer_f.h \
     src/dsp/stereo_demod.h \
+    src/interfaces/async_file_sink.h \
     src/interfaces/udp_sink_f.h \
     src/qtgui/afsk1200win.h \
     src/qtgui/agc_options.h \
@@ -197,12 +217,14 @@ HEADERS += \
     src/qtgui/dockrxopt.h \
     src/qtgui/freqctrl.h \
     src/qtgui/ioconfig.h \
+    src/qtgui/iq_meta.h \
     src/qtgui/iq_tool.h \
     src/qtgui/meter.h \
     src/qtgui/nb_options.h \
     src/qtgui/plotter.h \
     src/qtgui/qtcolorpicker.h \
     src/receivers/nbrx.h \
+    src/receivers/nbrx_fused.h \
     src/receivers/receiver_base.h \
     src/receivers/wfmrx.h
 
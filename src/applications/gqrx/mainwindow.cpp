@@ -31,13 +31,16 @@
 #include <QDesktopServices>
 #include <QDebug>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QFile>
+#include <QFormLayout>
 #include <QGroupBox>
 #include <QKeySequence>
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QResource>
+#include <QSpinBox>
 #include <QString>
 #include <QTextBrowser>
 #include <QTextCursor>
@@ -98,6 +101,9 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     // remote controller
     remote = new RemoteControl();
 
+    // frequency scanner
+    scanner = new Scanner(this);
+
     /* meter timer */
     meter_timer = new QTimer(this);
     connect(meter_timer, SIGNAL(timeout()), this, SLOT(meterTimeout()));
@@ -214,6 +220,8 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(uiDockRxOpt, SIGNAL(agcGainChanged(int)), this, SLOT(setAgcGain(int)));
     connect(uiDockRxOpt, SIGNAL(agcDecayChanged(int)), this, SLOT(setAgcDecay(int)));
     connect(uiDockRxOpt, SIGNAL(noiseBlankerChanged(int,bool,float)), this, SLOT(setNoiseBlanker(int,bool,float)));
+    connect(uiDockRxOpt, SIGNAL(noiseReductionChanged(bool,float)), this, SLOT(setNoiseReduction(bool,float)));
+    connect(uiDockRxOpt, SIGNAL(autoNotchToggled(bool)), this, SLOT(setAutoNotch(bool)));
     connect(uiDockRxOpt, SIGNAL(sqlLevelChanged(double)), this, SLOT(setSqlLevel(double)));
     connect(uiDockRxOpt, SIGNAL(sqlAutoClicked()), this, SLOT(setSqlLevelAuto()));
     connect(uiDockAudio, SIGNAL(audioGainChanged(float)), this, SLOT(setAudioGain(float)));
@@ -261,11 +269,12 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
 
 
     // I/Q playback
-    connect(iq_tool, SIGNAL(startRecording(QString)), this, SLOT(startIqRecording(QString)));
+    connect(iq_tool, SIGNAL(startRecording(QString,QString)), this, SLOT(startIqRecording(QString,QString)));
     connect(iq_tool, SIGNAL(stopRecording()), this, SLOT(stopIqRecording()));
-    connect(iq_tool, SIGNAL(startPlayback(QString,float)), this, SLOT(startIqPlayback(QString,float)));
+    connect(iq_tool, SIGNAL(startPlayback(QString,float,QString)), this, SLOT(startIqPlayback(QString,float,QString)));
     connect(iq_tool, SIGNAL(stopPlayback()), this, SLOT(stopIqPlayback()));
     connect(iq_tool, SIGNAL(seek(qint64)), this,SLOT(seekIqFile(qint64)));
+    connect(iq_tool, SIGNAL(timeMachineChanged(int,QString)), this, SLOT(setIqTimeMachine(int,QString)));
 
     // remote control
     connect(remote, SIGNAL(newFilterOffset(qint64)), this, SLOT(setFilterOffset(qint64)));
@@ -283,8 +292,18 @@ MainWindow::MainWindow(const QString cfgfile, bool edit_conf, QWidget *parent) :
     connect(ui->plotter, SIGNAL(newFilterFreq(int, int)), remote, SLOT(setPassband(int, int)));
     connect(remote, SIGNAL(newPassband(int)), this, SLOT(setPassband(int)));
     connect(remote, SIGNAL(gainChanged(QString, double)), uiDockInputCtl, SLOT(setGain(QString,double)));
+    connect(remote, SIGNAL(startScannerEvent()), this, SLOT(startScanner()));
+    connect(remote, SIGNAL(stopScannerEvent()), this, SLOT(stopScanner()));
+    connect(remote, SIGNAL(startIqRecorderEvent()), iq_tool, SLOT(startRecorder()));
+    connect(remote, SIGNAL(stopIqRecorderEvent()), iq_tool, SLOT(stopRecorder()));
+
+    // scanner
+    connect(scanner, SIGNAL(newCenterFreq(qint64)), this, SLOT(scannerNewCenterFreq(qint64)));
+    connect(scanner, SIGNAL(newChannel(qint64, QString, int)), this, SLOT(scannerNewChannel(qint64, QString, int)));
+    connect(scanner, SIGNAL(scannerStateChanged(bool)), this, SLOT(scannerStateChanged(bool)));
 
     rds_timer = new QTimer(this);
+    rds_version = 0;
     connect(rds_timer, SIGNAL(timeout()), this, SLOT(rdsTimeout()));
 
     // enable frequency tooltips on FFT plot
@@ -518,6 +537,10 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
     QString outdev = m_settings->value("output/device", "").toString();
     rx->set_output_device(outdev.toStdString());
 
+    int_val = m_settings->value("output/sample_rate", 48000).toInt(&conv_ok);
+    if (conv_ok && (int_val >= 0))
+        rx->set_audio_rate(int_val);
+
     int_val = m_settings->value("input/sample_rate", 0).toInt(&conv_ok);
     if (conv_ok && (int_val > 0))
     {
@@ -587,6 +610,9 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
         qDebug() << "Actual bandwidth   :" << actual_bw << "Hz";
     }
 
+    // must be set before the demodulator is selected
+    rx->set_fused_nbrx(m_settings->value("receiver/fused_nbrx", false).toBool());
+
     uiDockInputCtl->readSettings(m_settings); // this will also update freq range
     uiDockRxOpt->readSettings(m_settings);
     uiDockFft->readSettings(m_settings);
@@ -618,6 +644,7 @@ bool MainWindow::loadConfig(const QString cfgfile, bool check_crash,
     }
 
     iq_tool->readSettings(m_settings);
+    scanner->readSettings(m_settings);
 
     /*
      * Initialization the remote control at the end.
@@ -709,6 +736,7 @@ void MainWindow::storeSession()
         uiDockAudio->saveSettings(m_settings);
 
         remote->saveSettings(m_settings);
+        scanner->saveSettings(m_settings);
         iq_tool->saveSettings(m_settings);
 
         {
@@ -720,6 +748,11 @@ void MainWindow::storeSession()
                 m_settings->setValue("receiver/filter_high_cut", fhi);
             }
         }
+
+        if (rx->get_fused_nbrx())
+            m_settings->setValue("receiver/fused_nbrx", true);
+        else
+            m_settings->remove("receiver/fused_nbrx");
     }
 }
 
@@ -1070,7 +1103,7 @@ void MainWindow::selectDemod(int mode_idx)
     case DockRxOpt::MODE_WFM_STEREO_OIRT:
         /* Broadcast FM */
         ui->plotter->setDemodRanges(-120e3, -10000, 10000, 120e3, true);
-        uiDockAudio->setFftRange(0,24000);  /** FIXME: get audio rate from rx **/
+        uiDockAudio->setFftRange(0,24000);
         click_res = 1000;
         if (mode_idx == DockRxOpt::MODE_WFM_MONO)
             rx->set_demod(receiver::RX_DEMOD_WFM_M);
@@ -1133,6 +1166,22 @@ void MainWindow::selectDemod(int mode_idx)
     rx->set_filter((double)flo, (double)fhi, d_filter_shape);
     rx->set_cw_offset(cwofs);
     rx->set_sql_level(uiDockRxOpt->currentSquelchLevel());
+    uiDockAudio->setSampleRate((int)rx->get_audio_rate());
+
+    // design the other filter presets of this mode in the background
+    if (mode_idx != DockRxOpt::MODE_OFF)
+    {
+        int lo, hi;
+
+        for (int preset = FILTER_PRESET_WIDE; preset <= FILTER_PRESET_NARROW; preset++)
+        {
+            if (preset == filter_preset)
+                continue;
+
+            uiDockRxOpt->getFilterPreset(mode_idx, preset, &lo, &hi);
+            rx->prefetch_filter((double)lo, (double)hi, d_filter_shape);
+        }
+    }
 
     remote->setMode(mode_idx);
     remote->setPassband(flo, fhi);
@@ -1243,6 +1292,30 @@ void MainWindow::setNoiseBlanker(int nbid, bool on, float threshold)
     rx->set_nb_threshold(nbid, threshold);
 }
 
+/**
+ * @brief Noise reduction configuration changed.
+ * @param on Noise reduction ON/OFF.
+ * @param strength Noise reduction strength between 0.0 and 1.0.
+ */
+void MainWindow::setNoiseReduction(bool on, float strength)
+{
+    qDebug() << "Noise reduction ON:" << on << "STRENGTH:" << strength;
+
+    rx->set_nr_strength(strength);
+    rx->set_nr_on(on);
+}
+
+/**
+ * @brief Automatic notch toggled.
+ * @param on Automatic notch ON/OFF.
+ */
+void MainWindow::setAutoNotch(bool on)
+{
+    qDebug() << "Automatic notch ON:" << on;
+
+    rx->set_anf_on(on);
+}
+
 /**
  * @brief Squelch level changed.
  * @param level_db The new squelch level in dBFS.
@@ -1259,7 +1332,10 @@ void MainWindow::setSqlLevel(double level_db)
  */
 double MainWindow::setSqlLevelAuto()
 {
-    double level = rx->get_signal_pwr(true) + 1.0;
+    rx_meter_stats stats;
+
+    rx->get_signal_stats(stats);
+    double level = 10.0 * log10(stats.rms + 1.0e-20) + 1.0;
     if (level > -10.0)  // avoid 0 dBFS
         level = uiDockRxOpt->getSqlLevel();
 
@@ -1270,11 +1346,36 @@ double MainWindow::setSqlLevelAuto()
 /** Signal strength meter timeout. */
 void MainWindow::meterTimeout()
 {
+    rx_meter_stats stats;
     float level;
 
-    level = rx->get_signal_pwr(true);
+    // one snapshot for all consumers so they see the same level
+    rx->get_signal_stats(stats);
+    level = 10.f * log10f(stats.rms + 1.0e-20f);
     ui->sMeter->setLevel(level);
     remote->setSignalLevel(level);
+    scanner->setSignalLevel(level, uiDockRxOpt->getSqlLevel());
+
+    if (rx->is_recording_iq())
+    {
+        uint64_t samples, clipped, dropped, write_errors;
+        float    fill;
+
+        rx->get_iq_recording_stats(samples, clipped, dropped, fill,
+                                   write_errors);
+        iq_tool->setRecordingStats(samples, clipped, dropped, fill,
+                                   write_errors);
+
+        // squelch events are only meaningful when the squelch is used
+        int lo, hi;
+        float sql_level = uiDockRxOpt->getSqlLevel();
+        qint64 rx_freq = ui->freqCtrl->getFrequency();
+
+        ui->plotter->getHiLowCutFrequencies(&lo, &hi);
+        iq_meta.update(samples, rx->get_rf_freq() + d_lnb_lo,
+                       sql_level > -150.f && level >= sql_level,
+                       rx_freq + lo, rx_freq + hi);
+    }
 }
 
 #define LOG2_10 3.321928094887362
@@ -1287,6 +1388,22 @@ void MainWindow::iqFftTimeout()
     float           pwr_scale;
     std::complex<float> pt;     /* a single FFT point used in calculations */
 
+    // the receiver stops the sweep when the input changes
+    if (ui->actionSweep->isChecked() && !rx->is_sweep_active())
+        stopSweep();
+
+    if (rx->is_sweep_active())
+    {
+        double  start, stop;
+
+        // display is limited to some reasonable number of points
+        fftsize = 65536;
+        rx->get_sweep_data(d_realFftData, fftsize, start, stop);
+        if (fftsize > 0)
+            ui->plotter->setNewFftData(d_realFftData, d_realFftData, fftsize);
+        return;
+    }
+
     // FIXME: fftsize is a reference
     rx->get_iq_fft_data(d_fftData, fftsize);
 
@@ -1307,6 +1424,10 @@ void MainWindow::iqFftTimeout()
     volk_32f_log2_32f(d_realFftData, d_realFftData, fftsize);
     volk_32f_s32f_multiply_32f(d_realFftData, d_realFftData, 10 / LOG2_10, fftsize);
 
+    if (scanner->isRunning())
+        scanner->processFftData(d_realFftData, fftsize, d_hw_freq + d_lnb_lo,
+                                (qint64)rx->get_quad_rate());
+
     for (i = 0; i < fftsize; i++)
     {
         /* FFT averaging */
@@ -1328,6 +1449,8 @@ void MainWindow::audioFftTimeout()
     if (!d_have_audio || !uiDockAudio->isVisible())
         return;
 
+    // the audio rate follows the filter width when set to auto
+    uiDockAudio->setSampleRate((int)rx->get_audio_rate());
     rx->get_audio_fft_data(d_fftData, fftsize);
 
     if (fftsize == 0)
@@ -1361,16 +1484,65 @@ void MainWindow::audioFftTimeout()
     uiDockAudio->setNewFftData(d_realFftData, fftsize);
 }
 
-/** RDS message display timeout. */
+/**
+ * RDS display timeout.
+ *
+ * Gets a snapshot of the RDS station state and updates the fields that
+ * have changed since the last snapshot.
+ */
 void MainWindow::rdsTimeout()
 {
-    std::string buffer;
-    int num;
-
-    rx->get_rds_data(buffer, num);
-    while(num!=-1) {
-        rx->get_rds_data(buffer, num);
-        uiDockRDS->updateRDS(QString::fromStdString(buffer), num);
+    gr::rds::station_state  state;
+    unsigned int            changed;
+
+    rx->get_rds_state(state);
+    changed = state.changed_since(rds_version);
+    rds_version = state.version;
+
+    if (changed & (1 << gr::rds::RDS_PI))
+        uiDockRDS->updateRDS(state.pi ? QString("%1").arg(state.pi, 4, 16, QChar('0')).toUpper()
+                                      : QString(""), gr::rds::RDS_PI);
+    if (changed & (1 << gr::rds::RDS_PS))
+        uiDockRDS->updateRDS(QString::fromLatin1(state.ps), gr::rds::RDS_PS);
+    if (changed & (1 << gr::rds::RDS_PTY))
+        uiDockRDS->updateRDS(QString::fromLatin1(state.pty_name), gr::rds::RDS_PTY);
+    if (changed & (1 << gr::rds::RDS_FLAGS))
+    {
+        QString flags;
+
+        flags += state.tp ? '1' : '0';
+        flags += state.ta ? '1' : '0';
+        flags += state.music_speech ? '1' : '0';
+        flags += state.mono_stereo ? '1' : '0';
+        flags += state.artificial_head ? '1' : '0';
+        flags += state.compressed ? '1' : '0';
+        flags += state.static_pty ? '1' : '0';
+        uiDockRDS->updateRDS(flags, gr::rds::RDS_FLAGS);
+    }
+    if (changed & (1 << gr::rds::RDS_RT))
+        uiDockRDS->updateRDS(QString::fromLatin1(state.rt).trimmed(), gr::rds::RDS_RT);
+    if ((changed & (1 << gr::rds::RDS_CT)) && state.ct_year)
+        uiDockRDS->updateRDS(QString("%1.%2.%3, %4:%5 (%6%7h)")
+                             .arg(state.ct_day, 2, 10, QChar('0'))
+                             .arg(state.ct_month, 2, 10, QChar('0'))
+                             .arg(state.ct_year)
+                             .arg(state.ct_hour, 2, 10, QChar('0'))
+                             .arg(state.ct_minute, 2, 10, QChar('0'))
+                             .arg(state.ct_offset < 0 ? '-' : '+')
+                             .arg(qAbs(state.ct_offset), 0, 'f', 1),
+                             gr::rds::RDS_CT);
+    if (changed & (1 << gr::rds::RDS_AF))
+    {
+        QStringList afs;
+
+        for (unsigned int i = 0; i < state.num_af; i++)
+        {
+            if (state.af[i] > 80e3)
+                afs << QString("%1MHz").arg(state.af[i] / 1e3, 0, 'f', 2);
+            else
+                afs << QString("%1kHz").arg((int)state.af[i]);
+        }
+        uiDockRDS->updateRDS(afs.join(", "), gr::rds::RDS_AF);
     }
 }
 
@@ -1465,20 +1637,23 @@ void MainWindow::stopAudioStreaming()
 }
 
 /** Start I/Q recording. */
-void MainWindow::startIqRecording(const QString recdir)
+void MainWindow::startIqRecording(const QString recdir, const QString format)
 {
     qDebug() << __func__;
-    // generate file name using date, time, rf freq in kHz and BW in Hz
+    // generate file name using date, time, rf freq in kHz, BW in Hz and
+    // sample format
     // gqrx_iq_yyyymmdd_hhmmss_freq_bw_fc.raw
     qint64 freq = (qint64)(rx->get_rf_freq());
     qint64 sr = (qint64)(rx->get_input_rate());
     qint32 dec = (quint32)(rx->get_input_decim());
-    QString lastRec = QDateTime::currentDateTimeUtc().
-            toString("%1/gqrx_yyyyMMdd_hhmmss_%2_%3_fc.'raw'")
-            .arg(recdir).arg(freq).arg(sr/dec);
+    iq_format fmt = iq_format_from_name(format.toStdString());
+    QDateTime start_time = QDateTime::currentDateTimeUtc();
+    QString lastRec = start_time.
+            toString("%1/gqrx_yyyyMMdd_hhmmss_%2_%3_%4.'raw'")
+            .arg(recdir).arg(freq).arg(sr/dec).arg(iq_format_name(fmt));
 
     // start recorder; fails if recording already in progress
-    if (rx->start_iq_recording(lastRec.toStdString()))
+    if (rx->start_iq_recording(lastRec.toStdString(), fmt, iqRecBufferSize()))
     {
         // reset action status
         ui->statusBar->showMessage(tr("Error starting I/Q recoder"));
@@ -1493,6 +1668,18 @@ void MainWindow::startIqRecording(const QString recdir)
     }
     else
     {
+        // the recording may start with samples from the time machine
+        uint64_t samples, clipped, dropped, write_errors;
+        float    fill;
+        rx->get_iq_recording_stats(samples, clipped, dropped, fill,
+                                   write_errors);
+        start_time = start_time.addMSecs(-(qint64)(samples * 1000 / (sr / dec)));
+
+        iq_meta.start(lastRec, iq_format_name(fmt), (double)(sr/dec),
+                      (double)(freq + d_lnb_lo), start_time,
+                      m_settings->value("input/device", "").toString());
+        remote->setIqRecorderStatus(true);
+
         ui->statusBar->showMessage(tr("Recording I/Q data to: %1").arg(lastRec),
                                    5000);
     }
@@ -1503,13 +1690,70 @@ void MainWindow::stopIqRecording()
 {
     qDebug() << __func__;
 
+    uint64_t samples, clipped, dropped, write_errors;
+    float    fill;
+    rx->get_iq_recording_stats(samples, clipped, dropped, fill, write_errors);
+    iq_meta.stop(samples);
+    remote->setIqRecorderStatus(false);
+
     if (rx->stop_iq_recording())
+    {
         ui->statusBar->showMessage(tr("Error stopping I/Q recoder"));
+    }
+    else
+    {
+        // the rest of the buffer is written in the background
+        ui->statusBar->showMessage(tr("Writing I/Q data to disk..."));
+        iq_tool->setRecordingFinished(false, 0);
+        QTimer::singleShot(100, this, SLOT(checkIqFlush()));
+    }
+}
+
+/** Report the end of an I/Q recording once the file is complete. */
+void MainWindow::checkIqFlush()
+{
+    uint64_t write_errors = 0;
+
+    if (rx->is_iq_flushing(write_errors))
+    {
+        QTimer::singleShot(100, this, SLOT(checkIqFlush()));
+        return;
+    }
+
+    iq_tool->setRecordingFinished(true, write_errors);
+    if (write_errors > 0)
+        ui->statusBar->showMessage(tr("I/Q recording stopped, %1 blocks "
+                                      "could not be written")
+                                   .arg(write_errors));
     else
         ui->statusBar->showMessage(tr("I/Q data recoding stopped"), 5000);
 }
 
-void MainWindow::startIqPlayback(const QString filename, float samprate)
+/**
+ * @brief Configure the I/Q time machine.
+ * @param seconds The number of seconds to keep in memory, 0 to disable.
+ * @param format The sample format.
+ */
+void MainWindow::setIqTimeMachine(int seconds, const QString format)
+{
+    iq_format fmt = iq_format_from_name(format.toStdString());
+
+    if (rx->set_iq_time_machine((double)seconds, fmt, iqRecBufferSize()))
+        ui->statusBar->showMessage(tr("Not enough memory for %1 s of I/Q data")
+                                   .arg(seconds), 5000);
+}
+
+/** Size of the I/Q recording buffer in bytes. */
+size_t MainWindow::iqRecBufferSize() const
+{
+    // recording buffer in MB; larger values tolerate longer disk stalls
+    size_t bufsize = m_settings->value("baseband/rec_buffer", 256).toUInt();
+
+    return qBound<size_t>(16, bufsize, 4096) * 1024 * 1024;
+}
+
+void MainWindow::startIqPlayback(const QString filename, float samprate,
+                                 const QString format)
 {
     if (ui->actionDSP->isChecked())
     {
@@ -1519,13 +1763,15 @@ void MainWindow::startIqPlayback(const QString filename, float samprate)
 
     storeSession();
 
-    int sri = (int)samprate;
+    // compact formats are read as gr_complex items holding several samples
+    iq_format fmt = iq_format_from_name(format.toStdString());
+    int sri = (int)samprate * iq_format_size(fmt) / (int)sizeof(gr_complex);
     QString devstr = QString("file='%1',rate=%2,throttle=true,repeat=false")
             .arg(filename).arg(sri);
 
-    qDebug() << __func__ << ":" << devstr;
+    qDebug() << __func__ << ":" << devstr << format;
 
-    rx->set_input_device(devstr.toStdString());
+    rx->set_input_device(devstr.toStdString(), fmt);
 
     // sample rate
     double actual_rate = rx->set_input_rate(samprate);
@@ -1914,6 +2160,139 @@ void MainWindow::on_actionSaveWaterfall_triggered()
     m_settings->setValue("wf_save_dir", fi.absolutePath());
 }
 
+/** Start / stop wideband sweep. */
+void MainWindow::on_actionSweep_triggered(bool checked)
+{
+    if (checked)
+        startSweep();
+    else
+        stopSweep();
+}
+
+/**
+ * @brief Ask for sweep parameters and start the wideband sweep.
+ *
+ * The panadapter and waterfall are switched to show the full sweep range
+ * until the sweep is stopped.
+ */
+void MainWindow::startSweep()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Wideband sweep"));
+
+    QDoubleSpinBox *startBox = new QDoubleSpinBox(&dialog);
+    QDoubleSpinBox *stopBox = new QDoubleSpinBox(&dialog);
+    QSpinBox *avgBox = new QSpinBox(&dialog);
+    QSpinBox *settleBox = new QSpinBox(&dialog);
+
+    startBox->setRange(0.0, 9999.0);
+    startBox->setDecimals(3);
+    startBox->setSuffix(" MHz");
+    startBox->setValue(m_settings->value("sweep/start", 30e6).toDouble() / 1e6);
+    stopBox->setRange(0.0, 9999.0);
+    stopBox->setDecimals(3);
+    stopBox->setSuffix(" MHz");
+    stopBox->setValue(m_settings->value("sweep/stop", 1700e6).toDouble() / 1e6);
+    avgBox->setRange(1, 1000);
+    avgBox->setValue(m_settings->value("sweep/averages", 10).toInt());
+    settleBox->setRange(0, 1000);
+    settleBox->setSuffix(" ms");
+    settleBox->setValue(m_settings->value("sweep/settle_ms", 20).toInt());
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok
+                                                       | QDialogButtonBox::Cancel);
+    connect(buttonBox, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    QFormLayout *form = new QFormLayout(&dialog);
+    form->addRow(tr("Start"), startBox);
+    form->addRow(tr("Stop"), stopBox);
+    form->addRow(tr("FFTs per step"), avgBox);
+    form->addRow(tr("Settle time"), settleBox);
+    form->addRow(buttonBox);
+
+    if (!dialog.exec())
+    {
+        ui->actionSweep->setChecked(false);
+        return;
+    }
+
+    qint64 start = (qint64)(startBox->value() * 1e6);
+    qint64 stop = (qint64)(stopBox->value() * 1e6);
+
+    m_settings->setValue("sweep/start", start);
+    m_settings->setValue("sweep/stop", stop);
+    m_settings->setValue("sweep/averages", avgBox->value());
+    m_settings->setValue("sweep/settle_ms", settleBox->value());
+
+    if (rx->start_sweep((double)(start - d_lnb_lo), (double)(stop - d_lnb_lo),
+                        m_settings->value("sweep/fft_size", 1024).toUInt(),
+                        avgBox->value(), settleBox->value() / 1000.0)
+            != receiver::STATUS_OK)
+    {
+        ui->actionSweep->setChecked(false);
+        ui->statusBar->showMessage(tr("Error starting wideband sweep"), 5000);
+        return;
+    }
+
+    if (scanner->isRunning())
+        scanner->stop();
+
+    ui->plotter->setCenterFreq((start + stop) / 2);
+    ui->plotter->setSampleRate(stop - start);
+    ui->plotter->setSpanFreq((quint32)(stop - start));
+    ui->plotter->resetHorizontalZoom();
+    ui->actionSweep->setChecked(true);
+    ui->statusBar->showMessage(tr("Sweeping %1 - %2 MHz")
+                               .arg(start / 1e6).arg(stop / 1e6));
+}
+
+/** Stop the wideband sweep and restore the panadapter. */
+void MainWindow::stopSweep()
+{
+    double rate = rx->get_input_rate() / rx->get_input_decim();
+
+    rx->stop_sweep();
+
+    ui->plotter->setSampleRate(rate);
+    ui->plotter->setSpanFreq((quint32)rate);
+    ui->plotter->setCenterFreq(d_hw_freq + d_lnb_lo);
+    ui->plotter->resetHorizontalZoom();
+    ui->actionSweep->setChecked(false);
+    ui->statusBar->showMessage(tr("Wideband sweep stopped"), 5000);
+}
+
+/** Export the result of the last wideband sweep. */
+void MainWindow::on_actionSaveSweep_triggered()
+{
+    QDateTime   dt(QDateTime::currentDateTimeUtc());
+    QString     sweepfile;
+    QString     save_path;
+
+    // previously used location
+    save_path = m_settings->value("sweep/save_dir", "").toString();
+    if (!save_path.isEmpty())
+        save_path += "/";
+    save_path += dt.toString("gqrx_sweep_yyyyMMdd_hhmmss.csv");
+
+    sweepfile = QFileDialog::getSaveFileName(this, tr("Export sweep"), save_path,
+                                             tr("CSV files (*.csv);;Binary files (*.bin)"));
+    if (sweepfile.isEmpty())
+        return;
+
+    bool csv = !sweepfile.endsWith(".bin", Qt::CaseInsensitive);
+    if (rx->save_sweep(sweepfile.toStdString(), csv) != receiver::STATUS_OK)
+    {
+        QMessageBox::critical(this,
+                              tr("Error"),
+                              tr("There was an error exporting the sweep.\n"
+                                 "Make sure a sweep has been run."));
+    }
+
+    QFileInfo fi(sweepfile);
+    m_settings->setValue("sweep/save_dir", fi.absolutePath());
+}
+
 /** Show I/Q player. */
 void MainWindow::on_actionIqTool_triggered()
 {
@@ -2079,6 +2458,7 @@ void MainWindow::setRdsDecoder(bool checked)
         uiDockRDS->showEnabled();
         rx->start_rds_decoder();
         rx->reset_rds_parser();
+        rds_version = 0;
         rds_timer->start(250);
     }
     else
@@ -2119,6 +2499,70 @@ void MainWindow::onBookmarkActivated(qint64 freq, QString demod, int bandwidth)
     on_plotter_newFilterFreq(lo, hi);
 }
 
+/** Start the frequency scanner using active bookmarks and stored ranges. */
+void MainWindow::startScanner()
+{
+    if (scanner->isRunning())
+        return;
+
+    scanner->clearChannels();
+    scanner->addBookmarks();
+    scanner->addRanges();
+
+    if (scanner->numChannels() == 0)
+    {
+        ui->actionScanner->setChecked(false);
+        ui->statusBar->showMessage(tr("Nothing to scan: No active bookmarks or scan ranges"), 5000);
+        return;
+    }
+
+    scanner->start();
+}
+
+/** Stop the frequency scanner. */
+void MainWindow::stopScanner()
+{
+    scanner->stop();
+}
+
+/**
+ * @brief Scanner needs to move the hardware LO.
+ * @param freq The new center frequency of the spectrum in Hz.
+ *
+ * The filter offset is kept so that the receiver stays on the same
+ * position relative to the center.
+ */
+void MainWindow::scannerNewCenterFreq(qint64 freq)
+{
+    ui->freqCtrl->setFrequency(freq + (qint64)rx->get_filter_offset());
+}
+
+/**
+ * @brief Scanner found a busy channel within the current capture bandwidth.
+ *
+ * Only the filter offset is changed, the hardware frequency stays the same.
+ */
+void MainWindow::scannerNewChannel(qint64 freq, QString demod, int bandwidth)
+{
+    qint64 offset = freq - d_hw_freq - d_lnb_lo;
+
+    setFilterOffset(offset);
+    uiDockRxOpt->setFilterOffset(offset);
+    remote->setFilterOffset(offset);
+
+    if (!demod.isEmpty())
+    {
+        selectDemod(demod);
+        setPassband(bandwidth);
+    }
+}
+
+void MainWindow::scannerStateChanged(bool running)
+{
+    ui->actionScanner->setChecked(running);
+    remote->setScannerStatus(running);
+}
+
 void MainWindow::setPassband(int bandwidth)
 {
     /* Check if filter is symmetric or not by checking the presets */
@@ -2258,6 +2702,15 @@ void MainWindow::on_actionAboutQt_triggered()
     QMessageBox::aboutQt(this, tr("About Qt"));
 }
 
+/** Start / stop the frequency scanner. */
+void MainWindow::on_actionScanner_triggered(bool checked)
+{
+    if (checked)
+        startScanner();
+    else
+        stopScanner();
+}
+
 void MainWindow::on_actionAddBookmark_triggered()
 {
     bool ok=false;
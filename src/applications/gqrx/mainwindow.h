@@ -43,6 +43,7 @@
 #include "qtgui/iq_tool.h"
 
 #include "applications/gqrx/remote_control.h"
+#include "applications/gqrx/scanner.h"
 
 // see https://bugreports.qt-project.org/browse/QTBUG-22829
 #ifndef Q_MOC_RUN
@@ -99,11 +100,13 @@ private:
     DockRDS        *uiDockRDS;
 
     CIqTool        *iq_tool;
+    CIqMeta         iq_meta;    /* SigMF metadata of the I/Q recording. */
 
 
     /* data decoders */
     Afsk1200Win    *dec_afsk1200;
     bool            dec_rds;
+    unsigned long   rds_version;    /*!< Version of the last RDS update. */
 
     QTimer   *dec_timer;
     QTimer   *meter_timer;
@@ -115,6 +118,8 @@ private:
 
     RemoteControl *remote;
 
+    Scanner       *scanner;
+
     std::map<QString, QVariant> devList;
 
     // dummy widget to enforce linking to QtSvg
@@ -126,6 +131,9 @@ private:
     void updateGainStages(bool read_from_device);
     void showSimpleTextFile(const QString &resource_path,
                             const QString &window_title);
+    void startSweep();
+    void stopSweep();
+    size_t iqRecBufferSize() const;
 
 private slots:
     /* rf */
@@ -155,6 +163,8 @@ private slots:
     void setAgcDecay(int msec);
     void setAgcGain(int gain);
     void setNoiseBlanker(int nbid, bool on, float threshold);
+    void setNoiseReduction(bool on, float strength);
+    void setAutoNotch(bool on);
     void setSqlLevel(double level_db);
     double setSqlLevelAuto();
     void setAudioGain(float gain);
@@ -170,9 +180,12 @@ private slots:
     void stopAudioStreaming();
 
     /* I/Q playback and recording*/
-    void startIqRecording(const QString recdir);
+    void startIqRecording(const QString recdir, const QString format);
     void stopIqRecording();
-    void startIqPlayback(const QString filename, float samprate);
+    void checkIqFlush();
+    void setIqTimeMachine(int seconds, const QString format);
+    void startIqPlayback(const QString filename, float samprate,
+                         const QString format);
     void stopIqPlayback();
     void seekIqFile(qint64 seek_pos);
 
@@ -201,6 +214,13 @@ private slots:
     /* Bookmarks */
     void onBookmarkActivated(qint64 freq, QString demod, int bandwidth);
 
+    /* Scanner */
+    void startScanner();
+    void stopScanner();
+    void scannerNewCenterFreq(qint64 freq);
+    void scannerNewChannel(qint64 freq, QString demod, int bandwidth);
+    void scannerStateChanged(bool running);
+
     /* menu and toolbar actions */
     void on_actionDSP_triggered(bool checked);
     int  on_actionIoConfig_triggered();
@@ -218,6 +238,9 @@ private slots:
     void on_actionAbout_triggered();
     void on_actionAboutQt_triggered();
     void on_actionAddBookmark_triggered();
+    void on_actionScanner_triggered(bool checked);
+    void on_actionSweep_triggered(bool checked);
+    void on_actionSaveSweep_triggered();
 
 
     /* window close signals */
@@ -39,6 +39,7 @@
 #include "dsp/filter/fir_decim.h"
 #include "dsp/rx_fft.h"
 #include "receivers/nbrx.h"
+#include "receivers/nbrx_fused.h"
 #include "receivers/wfmrx.h"
 
 #ifdef WITH_PULSEAUDIO
@@ -64,16 +65,27 @@ receiver::receiver(const std::string input_device,
     : d_running(false),
       d_input_rate(96000.0),
       d_audio_rate(48000),
+      d_audio_rate_req(48000),
       d_decim(decimation),
       d_rf_freq(144800000.0),
       d_filter_offset(0.0),
       d_cw_offset(0.0),
+      d_filter_low(-5000.0),
+      d_filter_high(5000.0),
       d_recording_iq(false),
       d_recording_wav(false),
       d_sniffer_active(false),
+      d_sniffer_rate(0),
+      d_sweep_active(false),
       d_iq_rev(false),
       d_dc_cancel(false),
       d_iq_balance(false),
+      d_fused_nbrx(false),
+      d_input_fmt(IQ_FMT_FC32),
+      d_tm_seconds(0.0),
+      d_tm_fmt(IQ_FMT_FC32),
+      d_tm_buffer(256 * 1024 * 1024),
+      d_closed_write_errors(0),
       d_demod(RX_DEMOD_OFF)
 {
 
@@ -118,24 +130,18 @@ receiver::receiver(const std::string input_device,
 
     iq_swap = make_iq_swap_cc(false);
     dc_corr = make_dc_corr_cc(d_decim_rate, 1.0);
+    dc_corr->set_dc_enabled(d_dc_cancel);
     iq_fft = make_rx_fft_c(8192u, d_decim_rate, gr::filter::firdes::WIN_HANN);
 
-    audio_fft = make_rx_fft_f(8192u, gr::filter::firdes::WIN_HANN);
+    audio_fft = make_rx_fft_f(8192u, d_audio_rate, gr::filter::firdes::WIN_HANN);
     audio_gain0 = gr::blocks::multiply_const_ff::make(0);
     audio_gain1 = gr::blocks::multiply_const_ff::make(0);
     set_af_gain(DEFAULT_AUDIO_GAIN);
 
     audio_udp_sink = make_udp_sink_f();
 
-#ifdef WITH_PULSEAUDIO
-    audio_snk = make_pa_sink(audio_device, d_audio_rate, "GQRX", "Audio output");
-#elif WITH_PORTAUDIO
-    audio_snk = make_portaudio_sink(audio_device, d_audio_rate, "GQRX", "Audio output");
-#else
-    audio_snk = gr::audio::sink::make(d_audio_rate, audio_device, true);
-#endif
-
     output_devstr = audio_device;
+    create_audio_sink();
 
     /* wav sink and source is created when rec/play is started */
     audio_null_sink0 = gr::blocks::null_sink::make(sizeof(float));
@@ -182,19 +188,24 @@ void receiver::stop()
 
 /**
  * @brief Select new input device.
+ * @param device The osmosdr device string.
+ * @param fmt The sample format when the device is an I/Q file.
+ *
+ * Files in a compact format are read as gr_complex by the file source and
+ * converted by iq_dec, which has more output samples than input items.
  *
  * @bug When using ALSA, program will crash if the new device
  *      is the same as the previously used device:
  *      audio_alsa_source[hw:1]: Device or resource busy
  */
-void receiver::set_input_device(const std::string device)
+void receiver::set_input_device(const std::string device, iq_format fmt)
 {
     std::string error = "";
 
     if (device.empty())
         return;
 
-    if (input_devstr.compare(device) == 0)
+    if (input_devstr.compare(device) == 0 && fmt == d_input_fmt)
     {
 #ifndef QT_NO_DEBUG_OUTPUT
         std::cout << "No change in input device:" << std::endl
@@ -206,6 +217,10 @@ void receiver::set_input_device(const std::string device)
 
     input_devstr = device;
 
+    // sweep parameters depend on the device
+    if (d_sweep_active)
+        stop_sweep();
+
     // tb->lock() can hang occasionally
     if (d_running)
     {
@@ -213,17 +228,24 @@ void receiver::set_input_device(const std::string device)
         tb->wait();
     }
 
+    release_iq_sink();
+
     if (d_decim >= 2)
     {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(input_block(), 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(input_block(), 0, iq_swap, 0);
     }
 
+    if (iq_dec)
+        tb->disconnect(src, 0, iq_dec, 0);
+
     src.reset();
+    iq_dec.reset();
+    d_input_fmt = fmt;
 
     try
     {
@@ -233,21 +255,30 @@ void receiver::set_input_device(const std::string device)
     {
         error = x.what();
         src = osmosdr::source::make("file="+get_random_file()+",freq=428e6,rate=96000,repeat=true,throttle=true");
+        d_input_fmt = IQ_FMT_FC32;
+    }
+
+    if (d_input_fmt != IQ_FMT_FC32)
+    {
+        iq_dec = make_iq_decoder_c(d_input_fmt);
+        tb->connect(src, 0, iq_dec, 0);
     }
 
     if(src->get_sample_rate() != 0)
-        set_input_rate(src->get_sample_rate());
+        set_input_rate(src->get_sample_rate() * input_interp());
 
     if (d_decim >= 2)
     {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(input_block(), 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(input_block(), 0, iq_swap, 0);
     }
 
+    restore_iq_sink();
+
     if (d_running)
         tb->start();
 
@@ -287,21 +318,131 @@ void receiver::set_output_device(const std::string device)
         tb->disconnect(audio_gain1, 0, audio_snk, 1);
     }
     audio_snk.reset();
+    create_audio_sink();
+
+    if (d_demod != RX_DEMOD_OFF)
+    {
+        tb->connect(audio_gain0, 0, audio_snk, 0);
+        tb->connect(audio_gain1, 0, audio_snk, 1);
+    }
+
+    tb->unlock();
+}
 
+/** Create the audio sink for the current device and audio rate. */
+void receiver::create_audio_sink(void)
+{
 #ifdef WITH_PULSEAUDIO
-    audio_snk = make_pa_sink(device, d_audio_rate, "GQRX", "Audio output");
+    audio_snk = make_pa_sink(output_devstr, d_audio_rate, "GQRX", "Audio output");
 #elif WITH_PORTAUDIO
-    audio_snk = make_portaudio_sink(device, d_audio_rate, "GQRX", "Audio output");
+    audio_snk = make_portaudio_sink(output_devstr, d_audio_rate, "GQRX", "Audio output");
 #else
-    audio_snk = gr::audio::sink::make(d_audio_rate, device, true);
+    audio_snk = gr::audio::sink::make(d_audio_rate, output_devstr, true);
 #endif
+}
+
+/**
+ * @brief Set audio output rate.
+ * @param rate The new audio rate in Hz or 0 to select the rate automatically
+ *             from the demodulator and filter.
+ *
+ * The rate is applied to the receiver, the audio sink and all blocks
+ * processing audio without stopping the flow graph. While audio is being
+ * recorded the rate change is postponed until the recording is stopped.
+ */
+receiver::status receiver::set_audio_rate(unsigned int rate)
+{
+    d_audio_rate_req = rate;
+    update_audio_rate();
+
+    return STATUS_OK;
+}
+
+/* Lowest audio rate where the filter edge stays below a limit */
+static double lowest_audio_rate(double edge, double limit)
+{
+    static const double rates[] = { 8000.0, 16000.0, 24000.0 };
+
+    for (unsigned int i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+        if (edge <= limit * rates[i])
+            return rates[i];
+
+    return 48000.0;
+}
+
+/**
+ * @brief Select the audio rate for the current demodulator and filter.
+ *
+ * Wide band FM uses 48 kHz. The other modes use the lowest of 8, 16, 24 and
+ * 48 kHz where the filter including the CW offset is below 0.45 times the
+ * rate. A higher current rate is only left when the filter is also below
+ * 0.35 times the lower rate, so that moving the filter edges around a limit
+ * doesn't recreate the audio sink on every step.
+ */
+double receiver::auto_audio_rate(void) const
+{
+    double edge = std::max(std::abs(d_filter_low), std::abs(d_filter_high)) +
+                  std::abs(d_cw_offset);
+    double rate;
 
+    switch (d_demod)
+    {
+    case RX_DEMOD_OFF:
+        return d_audio_rate;
+
+    case RX_DEMOD_WFM_M:
+    case RX_DEMOD_WFM_S:
+    case RX_DEMOD_WFM_S_OIRT:
+        return 48000.0;
+
+    default:
+        break;
+    }
+
+    rate = lowest_audio_rate(edge, 0.45);
+    if (d_audio_rate > rate)
+        rate = std::min(d_audio_rate, lowest_audio_rate(edge, 0.35));
+
+    return rate;
+}
+
+/** Apply a new audio rate if the requested or automatic rate changed. */
+void receiver::update_audio_rate(void)
+{
+    double rate = d_audio_rate_req ? (double)d_audio_rate_req : auto_audio_rate();
+
+    // WAV files have a fixed rate; wait until recording or playback stops
+    if ((rate == d_audio_rate) || d_recording_wav || wav_src)
+        return;
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    std::cout << "Changing audio rate: " << d_audio_rate << " -> " << rate
+              << std::endl;
+#endif
+
+    d_audio_rate = rate;
+
+    tb->lock();
+
+    if (d_demod != RX_DEMOD_OFF)
+    {
+        tb->disconnect(audio_gain0, 0, audio_snk, 0);
+        tb->disconnect(audio_gain1, 0, audio_snk, 1);
+    }
+    audio_snk.reset();
+    create_audio_sink();
     if (d_demod != RX_DEMOD_OFF)
     {
         tb->connect(audio_gain0, 0, audio_snk, 0);
         tb->connect(audio_gain1, 0, audio_snk, 1);
     }
 
+    rx->set_audio_rate(d_audio_rate);
+    audio_fft->set_audio_rate(d_audio_rate);
+    audio_udp_sink->set_audio_rate(d_audio_rate);
+    if (d_sniffer_active)
+        sniffer_rr->set_rate((float)d_sniffer_rate/(float)d_audio_rate);
+
     tb->unlock();
 }
 
@@ -331,13 +472,16 @@ double receiver::set_input_rate(double rate)
     double  current_rate;
     bool    rate_has_changed;
 
-    current_rate = src->get_sample_rate();
+    current_rate = src->get_sample_rate() * input_interp();
     rate_has_changed = !(rate == current_rate ||
             std::abs(rate - current_rate) < std::abs(std::min(rate, current_rate))
             * std::numeric_limits<double>::epsilon());
 
+    if (rate_has_changed && d_sweep_active)
+        stop_sweep();
+
     tb->lock();
-    d_input_rate = src->set_sample_rate(rate);
+    d_input_rate = src->set_sample_rate(rate / input_interp()) * input_interp();
 
     if (d_input_rate == 0)
     {
@@ -363,6 +507,10 @@ double receiver::set_input_rate(double rate)
     iq_fft->set_quad_rate(d_decim_rate);
     tb->unlock();
 
+    // the length of the time machine depends on the rate
+    if (rate_has_changed && iq_sink && !d_recording_iq)
+        arm_time_machine();
+
     return d_input_rate;
 }
 
@@ -372,20 +520,25 @@ unsigned int receiver::set_input_decim(unsigned int decim)
     if (decim == d_decim)
         return d_decim;
 
+    if (d_sweep_active)
+        stop_sweep();
+
     if (d_running)
     {
         tb->stop();
         tb->wait();
     }
 
+    release_iq_sink();
+
     if (d_decim >= 2)
     {
-        tb->disconnect(src, 0, input_decim, 0);
+        tb->disconnect(input_block(), 0, input_decim, 0);
         tb->disconnect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->disconnect(src, 0, iq_swap, 0);
+        tb->disconnect(input_block(), 0, iq_swap, 0);
     }
 
     input_decim.reset();
@@ -421,12 +574,12 @@ unsigned int receiver::set_input_decim(unsigned int decim)
 
     if (d_decim >= 2)
     {
-        tb->connect(src, 0, input_decim, 0);
+        tb->connect(input_block(), 0, input_decim, 0);
         tb->connect(input_decim, 0, iq_swap, 0);
     }
     else
     {
-        tb->connect(src, 0, iq_swap, 0);
+        tb->connect(input_block(), 0, iq_swap, 0);
     }
 
 #ifdef CUSTOM_AIRSPY_KERNELS
@@ -434,6 +587,8 @@ unsigned int receiver::set_input_decim(unsigned int decim)
         src->set_bandwidth(d_decim_rate);
 #endif
 
+    restore_iq_sink();
+
     if (d_running)
         tb->start();
 
@@ -486,12 +641,15 @@ void receiver::set_dc_cancel(bool enable)
         return;
 
     d_dc_cancel = enable;
+    dc_corr->set_dc_enabled(enable);
 
-    // until we have a way to switch on/off
-    // inside the dc_corr_cc we do a reconf
-    rx_demod demod = d_demod;
-    d_demod = RX_DEMOD_OFF;
-    set_demod(demod);
+    // dc_corr_cc is only in the flow graph when it has something to do
+    if (!d_iq_balance)
+    {
+        rx_demod demod = d_demod;
+        d_demod = RX_DEMOD_OFF;
+        set_demod(demod);
+    }
 }
 
 /**
@@ -504,9 +662,24 @@ bool receiver::get_dc_cancel(void) const
     return d_dc_cancel;
 }
 
+/**
+ * @brief Select the narrow band receiver implementation.
+ * @param enable Use the single block receiver (nbrx_fused) instead of nbrx.
+ *
+ * The new receiver is created the next time a narrow band demodulator is
+ * selected.
+ */
+void receiver::set_fused_nbrx(bool enable)
+{
+    d_fused_nbrx = enable;
+}
+
 /**
  * @brief Enable/disable automatic I/Q balance.
  * @param enable Whether automatic I/Q balance should be enabled.
+ *
+ * The correction is done by dc_corr_cc so that it works with every input
+ * device, not only those where the driver implements it.
  */
 void receiver::set_iq_balance(bool enable)
 {
@@ -514,8 +687,14 @@ void receiver::set_iq_balance(bool enable)
         return;
 
     d_iq_balance = enable;
+    dc_corr->set_iq_enabled(enable);
 
-    src->set_iq_balance_mode(enable ? 2 : 0);
+    if (!d_dc_cancel)
+    {
+        rx_demod demod = d_demod;
+        d_demod = RX_DEMOD_OFF;
+        set_demod(demod);
+    }
 }
 
 /**
@@ -676,6 +855,7 @@ receiver::status receiver::set_cw_offset(double offset_hz)
     d_cw_offset = offset_hz;
     ddc->set_center_freq(d_filter_offset - d_cw_offset);
     rx->set_cw_offset(d_cw_offset);
+    update_audio_rate();
 
     return STATUS_OK;
 }
@@ -685,35 +865,55 @@ double receiver::get_cw_offset(void) const
     return d_cw_offset;
 }
 
-receiver::status receiver::set_filter(double low, double high, filter_shape shape)
+/* Transition width of a filter with the given shape */
+static double filter_trans_width(double low, double high,
+                                 receiver::filter_shape shape)
 {
-    double trans_width;
-
-    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
-        return STATUS_ERROR;
-
     switch (shape) {
 
-    case FILTER_SHAPE_SOFT:
-        trans_width = std::abs(high - low) * 0.5;
-        break;
+    case receiver::FILTER_SHAPE_SOFT:
+        return std::abs(high - low) * 0.5;
 
-    case FILTER_SHAPE_SHARP:
-        trans_width = std::abs(high - low) * 0.1;
-        break;
+    case receiver::FILTER_SHAPE_SHARP:
+        return std::abs(high - low) * 0.1;
 
-    case FILTER_SHAPE_NORMAL:
+    case receiver::FILTER_SHAPE_NORMAL:
     default:
-        trans_width = std::abs(high - low) * 0.2;
-        break;
+        return std::abs(high - low) * 0.2;
 
     }
+}
 
-    rx->set_filter(low, high, trans_width);
+receiver::status receiver::set_filter(double low, double high, filter_shape shape)
+{
+    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
+        return STATUS_ERROR;
+
+    d_filter_low = low;
+    d_filter_high = high;
+    rx->set_filter(low, high, filter_trans_width(low, high, shape));
+    update_audio_rate();
 
     return STATUS_OK;
 }
 
+/**
+ * @brief Design a filter in the background.
+ * @param low The lower edge of the filter.
+ * @param high The upper edge of the filter.
+ * @param shape The filter shape.
+ *
+ * Used for filters that are likely to be selected soon, e.g. the filter
+ * presets of the current mode, so that selecting them needs no design.
+ */
+void receiver::prefetch_filter(double low, double high, filter_shape shape)
+{
+    if ((low >= high) || (std::abs(high-low) < RX_FILTER_MIN_WIDTH))
+        return;
+
+    rx->prefetch_filter(low, high, filter_trans_width(low, high, shape));
+}
+
 receiver::status receiver::set_freq_corr(double ppm)
 {
     src->set_freq_corr(ppm);
@@ -734,6 +934,17 @@ float receiver::get_signal_pwr(bool dbfs) const
     return rx->get_signal_level(dbfs);
 }
 
+/**
+ * @brief Get all signal levels measured in the last integration window.
+ *
+ * The levels are linear power values, see rx_meter_stats. All readers get
+ * the same snapshot, reading doesn't reset the measurement.
+ */
+void receiver::get_signal_stats(rx_meter_stats &stats) const
+{
+    rx->get_signal_stats(stats);
+}
+
 /** Set new FFT size. */
 void receiver::set_iq_fft_size(int newsize)
 {
@@ -773,6 +984,30 @@ receiver::status receiver::set_nb_threshold(int nbid, float threshold)
     return STATUS_OK; // FIXME
 }
 
+receiver::status receiver::set_nr_on(bool on)
+{
+    if (rx->has_nr())
+        rx->set_nr_on(on);
+
+    return STATUS_OK;
+}
+
+receiver::status receiver::set_nr_strength(float strength)
+{
+    if (rx->has_nr())
+        rx->set_nr_strength(strength);
+
+    return STATUS_OK;
+}
+
+receiver::status receiver::set_anf_on(bool on)
+{
+    if (rx->has_anf())
+        rx->set_anf_on(on);
+
+    return STATUS_OK;
+}
+
 /**
  * @brief Set squelch level.
  * @param level_db The new level in dBFS.
@@ -918,6 +1153,7 @@ receiver::status receiver::set_demod(rx_demod demod)
     }
 
     d_demod = demod;
+    update_audio_rate();
 
     if (d_running)
         tb->start();
@@ -1043,6 +1279,9 @@ receiver::status receiver::stop_audio_recording()
 
     std::cout << "Audio recorder stopped" << std::endl;
 
+    // apply rate changes requested during the recording
+    update_audio_rate();
+
     return STATUS_OK;
 }
 
@@ -1127,6 +1366,7 @@ receiver::status receiver::stop_audio_playback()
 
     /* delete wav_src since we can not change file name */
     wav_src.reset();
+    update_audio_rate();
 
     return STATUS_OK;
 }
@@ -1148,8 +1388,21 @@ receiver::status receiver::stop_udp_streaming()
 /**
  * @brief Start I/Q data recorder.
  * @param filename The filename where to record.
+ * @param fmt The sample format of the file.
+ * @param buffer_size The size of the recording buffer in bytes.
+ *
+ * The file is written by a separate thread. The buffer absorbs delays of
+ * the disk; if it overflows samples are dropped rather than stalling the
+ * receiver.
+ *
+ * If the time machine is enabled with the same format and buffer size, the
+ * recording starts with the samples it holds. Use
+ * get_iq_recording_stats() to get the number of samples recorded before
+ * this call.
  */
-receiver::status receiver::start_iq_recording(const std::string filename)
+receiver::status receiver::start_iq_recording(const std::string filename,
+                                              iq_format fmt,
+                                              size_t buffer_size)
 {
     receiver::status status = STATUS_OK;
 
@@ -1158,21 +1411,35 @@ receiver::status receiver::start_iq_recording(const std::string filename)
         return STATUS_ERROR;
     }
 
+    if (iq_sink && fmt == d_tm_fmt && buffer_size == d_tm_buffer)
+    {
+        // continue the time machine into the file, the sink takes over
+        // the buffer in its next work() call
+        if (!iq_sink->open(filename))
+            status = STATUS_ERROR;
+
+        d_recording_iq = (status == STATUS_OK);
+        return status;
+    }
+
+    disarm_time_machine();
+
     try
     {
-        iq_sink = gr::blocks::file_sink::make(sizeof(gr_complex), filename.c_str(), true);
+        iq_sink = make_async_file_sink(iq_format_size(fmt), filename, buffer_size);
     }
     catch (std::runtime_error &e)
     {
-        std::cout << __func__ << ": couldn't open I/Q file" << std::endl;
+        std::cout << __func__ << ": " << e.what() << std::endl;
+        arm_time_machine();
         return STATUS_ERROR;
     }
 
+    if (fmt != IQ_FMT_FC32)
+        iq_enc = make_iq_encoder_c(fmt);
+
     tb->lock();
-    if (d_decim >= 2)
-        tb->connect(input_decim, 0, iq_sink, 0);
-    else
-        tb->connect(src, 0, iq_sink, 0);
+    connect_iq_sink();
     d_recording_iq = true;
     tb->unlock();
 
@@ -1188,23 +1455,206 @@ receiver::status receiver::stop_iq_recording()
     }
 
     tb->lock();
+    disconnect_iq_sink();
+    tb->unlock();
+
+    // the writer thread finishes the file in the background, see
+    // is_iq_flushing(); the time machine is armed again once the buffer
+    // has been released
     iq_sink->close();
+    iq_sinks_closing.push_back(iq_sink);
+    iq_sink.reset();
+    iq_enc.reset();
+    d_recording_iq = false;
 
-    if (d_decim >= 2)
-        tb->disconnect(input_decim, 0, iq_sink, 0);
-    else
-        tb->disconnect(src, 0, iq_sink, 0);
+    return STATUS_OK;
+}
+
+/**
+ * @brief Check whether stopped I/Q recordings are still being written.
+ * @param write_errors The number of failed writes of the finished
+ *                     recordings. Only set when all of them are finished.
+ * @returns True while the rest of a buffer is being written to a file.
+ *
+ * Call this after stop_iq_recording() until it returns false; the files are
+ * complete only then. The time machine is armed again when the last buffer
+ * has been released.
+ */
+bool receiver::is_iq_flushing(uint64_t &write_errors)
+{
+    std::list<async_file_sink_sptr>::iterator it = iq_sinks_closing.begin();
 
+    while (it != iq_sinks_closing.end())
+    {
+        if ((*it)->is_finished())
+        {
+            d_closed_write_errors += (*it)->get_write_errors();
+            it = iq_sinks_closing.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (!iq_sinks_closing.empty())
+        return true;
+
+    write_errors = d_closed_write_errors;
+    d_closed_write_errors = 0;
+
+    if (!iq_sink)
+        arm_time_machine();
+
+    return false;
+}
+
+/**
+ * @brief Enable or disable the I/Q time machine.
+ * @param seconds The length of the time machine in seconds, 0 to disable.
+ * @param fmt The sample format.
+ * @param buffer_size The size of the recording buffer in bytes, see
+ *                    start_iq_recording().
+ *
+ * The time machine keeps the most recent baseband samples in memory so that
+ * a recording started with the same format begins up to this many seconds
+ * in the past. The memory is allocated here; nothing is allocated while the
+ * samples are buffered. While recording, the new settings take effect when
+ * the recording is stopped.
+ */
+receiver::status receiver::set_iq_time_machine(double seconds, iq_format fmt,
+                                               size_t buffer_size)
+{
+    d_tm_seconds = std::max(0.0, seconds);
+    d_tm_fmt = fmt;
+    d_tm_buffer = buffer_size;
+
+    if (d_recording_iq)
+        return STATUS_OK;
+
+    arm_time_machine();
+
+    // while a recording is being flushed the time machine is armed later
+    if (d_tm_seconds > 0.0 && !iq_sink && iq_sinks_closing.empty())
+        return STATUS_ERROR;
+
+    return STATUS_OK;
+}
+
+/**
+ * @brief Get statistics of the ongoing I/Q recording.
+ * @param samples The number of samples recorded.
+ * @param clipped The number of I or Q values that were clipped.
+ * @param dropped The number of samples lost because the buffer was full.
+ * @param fill The fill level of the recording buffer (0 to 1).
+ * @param write_errors The number of blocks that could not be written.
+ *
+ * The clip count is zero when the recording is not in a compact format.
+ */
+void receiver::get_iq_recording_stats(uint64_t &samples, uint64_t &clipped,
+                                      uint64_t &dropped, float &fill,
+                                      uint64_t &write_errors)
+{
+    samples = iq_sink ? iq_sink->get_items() : 0;
+    dropped = iq_sink ? iq_sink->get_dropped() : 0;
+    write_errors = iq_sink ? iq_sink->get_write_errors() : 0;
+    fill = iq_sink ? iq_sink->get_fill() : 0.0f;
+    clipped = iq_enc ? iq_enc->get_clipped() : 0;
+}
+
+/**
+ * @brief Start wideband sweep.
+ * @param start The lower edge of the range in Hz.
+ * @param stop The upper edge of the range in Hz.
+ * @param fftsize The FFT size used for each step.
+ * @param averages The number of FFTs to average for each step.
+ * @param settle_time The time to discard after each hop in seconds.
+ *
+ * The sweep block is connected after the I/Q swapper, i.e. before DC removal
+ * which would be upset by the frequency hops. The hardware frequency is
+ * restored when the sweep is stopped.
+ */
+receiver::status receiver::start_sweep(double start, double stop,
+                                       unsigned int fftsize,
+                                       unsigned int averages,
+                                       double settle_time)
+{
+    if (d_sweep_active) {
+        std::cout << __func__ << ": sweep already active" << std::endl;
+        return STATUS_ERROR;
+    }
+
+    if (stop <= start || fftsize == 0) {
+        std::cout << __func__ << ": invalid sweep range" << std::endl;
+        return STATUS_ERROR;
+    }
+
+    sweep = make_rx_sweep_c(start, stop, d_decim_rate, fftsize, averages,
+                            settle_time,
+                            [this](double freq) { src->set_center_freq(freq); });
+
+    tb->lock();
+    tb->connect(iq_swap, 0, sweep, 0);
+    d_sweep_active = true;
     tb->unlock();
-    iq_sink.reset();
-    d_recording_iq = false;
+
+    return STATUS_OK;
+}
+
+/** Stop wideband sweep and return to the previous frequency. */
+receiver::status receiver::stop_sweep()
+{
+    if (!d_sweep_active)
+        return STATUS_ERROR;
+
+    tb->lock();
+    tb->disconnect(iq_swap, 0, sweep, 0);
+    d_sweep_active = false;
+    tb->unlock();
+
+    // keep the sweep block so that the result can still be saved
+    src->set_center_freq(d_rf_freq);
 
     return STATUS_OK;
 }
 
+/**
+ * @brief Get the stitched sweep spectrum.
+ * @param data Buffer for the spectrum in dBFS.
+ * @param size The size of the buffer on input, the number of points on output.
+ * @param start The frequency of the first point (output).
+ * @param stop The frequency of the last point (output).
+ */
+void receiver::get_sweep_data(float *data, unsigned int &size,
+                              double &start, double &stop)
+{
+    if (!sweep)
+    {
+        size = 0;
+        return;
+    }
+
+    sweep->get_panorama(data, size);
+    start = sweep->get_start_freq();
+    stop = sweep->get_stop_freq();
+}
+
+/**
+ * @brief Save the sweep result to a file.
+ * @param filename The file name.
+ * @param csv Use rtl_power compatible CSV format if true, binary otherwise.
+ */
+receiver::status receiver::save_sweep(const std::string filename, bool csv)
+{
+    if (!sweep)
+        return STATUS_ERROR;
+
+    return sweep->save(filename, csv) ? STATUS_OK : STATUS_ERROR;
+}
+
 /**
  * @brief Seek to position in IQ file source.
- * @param pos Byte offset from the beginning of the file.
+ * @param pos Sample offset from the beginning of the file.
  */
 receiver::status receiver::seek_iq_file(long pos)
 {
@@ -1212,7 +1662,7 @@ receiver::status receiver::seek_iq_file(long pos)
 
     tb->lock();
 
-    if (src->seek(pos, SEEK_SET))
+    if (src->seek(pos / input_interp(), SEEK_SET))
     {
         status = STATUS_OK;
     }
@@ -1239,6 +1689,7 @@ receiver::status receiver::start_sniffer(unsigned int samprate, int buffsize)
     }
 
     sniffer->set_buffer_size(buffsize);
+    d_sniffer_rate = samprate;
     sniffer_rr = make_resampler_ff((float)samprate/(float)d_audio_rate);
     tb->lock();
     tb->connect(rx, 0, sniffer_rr, 0);
@@ -1277,6 +1728,161 @@ void receiver::get_sniffer_data(float * outbuff, unsigned int &num)
     sniffer->get_samples(outbuff, num);
 }
 
+/** The block that provides the input samples, before decimation. */
+gr::basic_block_sptr receiver::input_block(void) const
+{
+    if (iq_dec)
+        return iq_dec;
+
+    return src;
+}
+
+/** Number of input samples per item delivered by the source. */
+unsigned int receiver::input_interp(void) const
+{
+    return sizeof(gr_complex) / iq_format_size(d_input_fmt);
+}
+
+/** The block where the I/Q recorder is connected. */
+gr::basic_block_sptr receiver::iq_tap(void) const
+{
+    if (d_decim >= 2)
+        return input_decim;
+
+    return input_block();
+}
+
+/** Connect the I/Q sink. The flow graph must be locked or stopped. */
+void receiver::connect_iq_sink(void)
+{
+    if (iq_enc)
+    {
+        tb->connect(iq_tap(), 0, iq_enc, 0);
+        tb->connect(iq_enc, 0, iq_sink, 0);
+    }
+    else
+    {
+        tb->connect(iq_tap(), 0, iq_sink, 0);
+    }
+}
+
+/** Disconnect the I/Q sink. The flow graph must be locked or stopped. */
+void receiver::disconnect_iq_sink(void)
+{
+    if (iq_enc)
+    {
+        tb->disconnect(iq_enc, 0, iq_sink, 0);
+        tb->disconnect(iq_tap(), 0, iq_enc, 0);
+    }
+    else
+    {
+        tb->disconnect(iq_tap(), 0, iq_sink, 0);
+    }
+}
+
+/**
+ * @brief Create the time machine buffer for the current settings and rate.
+ *
+ * Replaces an existing time machine. Does nothing while recording.
+ */
+void receiver::arm_time_machine(void)
+{
+    if (d_recording_iq)
+        return;
+
+    disarm_time_machine();
+    create_time_machine();
+
+    if (!iq_sink)
+        return;
+
+    tb->lock();
+    connect_iq_sink();
+    tb->unlock();
+}
+
+/**
+ * @brief Allocate the time machine buffer without connecting it.
+ *
+ * The buffer holds the pre-trigger data plus the recording buffer, so that
+ * a recording continued from the time machine can absorb the same disk
+ * delays as any other recording. Nothing is allocated while a stopped
+ * recording is still being written; is_iq_flushing() arms the time machine
+ * when it is done.
+ */
+void receiver::create_time_machine(void)
+{
+    if (d_tm_seconds <= 0.0 || !iq_sinks_closing.empty())
+        return;
+
+    size_t backlog = (size_t)(d_tm_seconds * d_decim_rate) * iq_format_size(d_tm_fmt);
+
+    try
+    {
+        iq_sink = make_async_file_sink(iq_format_size(d_tm_fmt), "",
+                                       backlog + d_tm_buffer, backlog);
+    }
+    catch (std::runtime_error &e)
+    {
+        std::cout << __func__ << ": " << e.what() << std::endl;
+        return;
+    }
+
+    if (d_tm_fmt != IQ_FMT_FC32)
+        iq_enc = make_iq_encoder_c(d_tm_fmt);
+}
+
+/** Remove the time machine buffer, if any. */
+void receiver::disarm_time_machine(void)
+{
+    if (!iq_sink || d_recording_iq)
+        return;
+
+    tb->lock();
+    disconnect_iq_sink();
+    tb->unlock();
+
+    iq_sink->close();
+    iq_sink.reset();
+    iq_enc.reset();
+}
+
+/**
+ * @brief Disconnect the I/Q sink before its input blocks are replaced.
+ *
+ * The flow graph must be stopped. The time machine is removed because its
+ * samples belong to the old input; a recording is kept and reconnected by
+ * restore_iq_sink().
+ */
+void receiver::release_iq_sink(void)
+{
+    if (!iq_sink)
+        return;
+
+    disconnect_iq_sink();
+
+    if (!d_recording_iq)
+    {
+        iq_sink.reset();
+        iq_enc.reset();
+    }
+}
+
+/**
+ * @brief Reconnect the I/Q sink after the input has been reconfigured.
+ *
+ * The flow graph must be stopped. A new time machine is created for the
+ * current rate.
+ */
+void receiver::restore_iq_sink(void)
+{
+    if (!d_recording_iq)
+        create_time_machine();
+
+    if (iq_sink)
+        connect_iq_sink();
+}
+
 /** Convenience function to connect all blocks. */
 void receiver::connect_all(rx_chain type)
 {
@@ -1284,6 +1890,11 @@ void receiver::connect_all(rx_chain type)
 
     // Setup source
     b = src;
+    if (iq_dec)
+    {
+        tb->connect(src, 0, iq_dec, 0);
+        b = iq_dec;
+    }
 
     // Pre-processing
     if (d_decim >= 2)
@@ -1292,16 +1903,24 @@ void receiver::connect_all(rx_chain type)
         b = input_decim;
     }
 
-    if (d_recording_iq)
+    if (iq_sink)
     {
         // We record IQ with minimal pre-processing
-        tb->connect(b, 0, iq_sink, 0);
+        if (iq_enc)
+        {
+            tb->connect(b, 0, iq_enc, 0);
+            tb->connect(iq_enc, 0, iq_sink, 0);
+        }
+        else
+        {
+            tb->connect(b, 0, iq_sink, 0);
+        }
     }
 
     tb->connect(b, 0, iq_swap, 0);
     b = iq_swap;
 
-    if (d_dc_cancel)
+    if (d_dc_cancel || d_iq_balance)
     {
         tb->connect(b, 0, dc_corr, 0);
         b = dc_corr;
@@ -1310,14 +1929,20 @@ void receiver::connect_all(rx_chain type)
     // Visualization
     tb->connect(b, 0, iq_fft, 0);
 
+    if (d_sweep_active)
+        tb->connect(iq_swap, 0, sweep, 0);
+
     // RX demod chain
     switch (type)
     {
     case RX_CHAIN_NBRX:
-        if (rx->name() != "NBRX")
+        if (rx->name() != (d_fused_nbrx ? "NBRX_FUSED" : "NBRX"))
         {
             rx.reset();
-            rx = make_nbrx(d_quad_rate, d_audio_rate);
+            if (d_fused_nbrx)
+                rx = make_nbrx_fused(d_quad_rate, d_audio_rate);
+            else
+                rx = make_nbrx(d_quad_rate, d_audio_rate);
         }
         break;
 
@@ -1361,9 +1986,10 @@ void receiver::connect_all(rx_chain type)
     }
 }
 
-void receiver::get_rds_data(std::string &outbuff, int &num)
+/*! \brief Get a snapshot of the RDS station state. */
+void receiver::get_rds_state(gr::rds::station_state &state)
 {
-    rx->get_rds_data(outbuff, num);
+    rx->get_rds_state(state);
 }
 
 void receiver::start_rds_decoder(void)
@@ -1389,3 +2015,10 @@ void receiver::reset_rds_parser(void)
 {
     rx->reset_rds_parser();
 }
+
+/*! \brief Get the number of good, corrected and failed RDS blocks. */
+void receiver::get_rds_stats(unsigned long &good, unsigned long &corrected,
+                             unsigned long &failed)
+{
+    rx->get_rds_stats(good, corrected, failed);
+}
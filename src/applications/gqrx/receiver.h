@@ -29,17 +29,18 @@
 #include <gnuradio/blocks/multiply_const.h>
 #endif
 
-#include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/null_sink.h>
 #include <gnuradio/blocks/wavfile_sink.h>
 #include <gnuradio/blocks/wavfile_source.h>
 #include <gnuradio/top_block.h>
 #include <osmosdr/source.h>
+#include <list>
 #include <string>
 
 #include "dsp/correct_iq_cc.h"
 #include "dsp/downconverter.h"
 #include "dsp/filter/fir_decim.h"
+#include "dsp/iq_format.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
@@ -47,8 +48,10 @@
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
 #include "dsp/rx_fft.h"
+#include "dsp/rx_sweep.h"
 #include "dsp/sniffer_f.h"
 #include "dsp/resampler_xx.h"
+#include "interfaces/async_file_sink.h"
 #include "interfaces/udp_sink_f.h"
 #include "receivers/receiver_base.h"
 
@@ -116,9 +119,13 @@ public:
 
     void        start();
     void        stop();
-    void        set_input_device(const std::string device);
+    void        set_input_device(const std::string device,
+                                 iq_format fmt = IQ_FMT_FC32);
     void        set_output_device(const std::string device);
 
+    status      set_audio_rate(unsigned int rate);
+    double      get_audio_rate(void) const { return d_audio_rate; }
+
     std::vector<std::string> get_antennas(void) const;
     void        set_antenna(const std::string &antenna);
 
@@ -144,6 +151,9 @@ public:
     void        set_iq_balance(bool enable);
     bool        get_iq_balance(void) const;
 
+    void        set_fused_nbrx(bool enable);
+    bool        get_fused_nbrx(void) const { return d_fused_nbrx; }
+
     status      set_rf_freq(double freq_hz);
     double      get_rf_freq(void);
     status      get_rf_range(double *start, double *stop, double *step);
@@ -160,8 +170,10 @@ public:
     status      set_cw_offset(double offset_hz);
     double      get_cw_offset(void) const;
     status      set_filter(double low, double high, filter_shape shape);
+    void        prefetch_filter(double low, double high, filter_shape shape);
     status      set_freq_corr(double ppm);
     float       get_signal_pwr(bool dbfs) const;
+    void        get_signal_stats(rx_meter_stats &stats) const;
     void        set_iq_fft_size(int newsize);
     void        set_iq_fft_window(int window_type);
     void        get_iq_fft_data(std::complex<float>* fftPoints,
@@ -173,6 +185,13 @@ public:
     status      set_nb_on(int nbid, bool on);
     status      set_nb_threshold(int nbid, float threshold);
 
+    /* Noise reduction */
+    status      set_nr_on(bool on);
+    status      set_nr_strength(float strength);
+
+    /* Automatic notch */
+    status      set_anf_on(bool on);
+
     /* Squelch parameter */
     status      set_sql_level(double level_db);
     status      set_sql_alpha(double alpha);
@@ -205,10 +224,28 @@ public:
     status      stop_udp_streaming();
 
     /* I/Q recording and playback */
-    status      start_iq_recording(const std::string filename);
+    status      start_iq_recording(const std::string filename,
+                                   iq_format fmt = IQ_FMT_FC32,
+                                   size_t buffer_size = 256 * 1024 * 1024);
     status      stop_iq_recording();
+    bool        is_recording_iq(void) const { return d_recording_iq; }
+    status      set_iq_time_machine(double seconds, iq_format fmt,
+                                    size_t buffer_size = 256 * 1024 * 1024);
+    bool        is_iq_flushing(uint64_t &write_errors);
+    void        get_iq_recording_stats(uint64_t &samples, uint64_t &clipped,
+                                       uint64_t &dropped, float &fill,
+                                       uint64_t &write_errors);
     status      seek_iq_file(long pos);
 
+    /* wideband sweep */
+    status      start_sweep(double start, double stop, unsigned int fftsize,
+                            unsigned int averages, double settle_time);
+    status      stop_sweep();
+    void        get_sweep_data(float *data, unsigned int &size,
+                               double &start, double &stop);
+    status      save_sweep(const std::string filename, bool csv);
+    bool        is_sweep_active(void) const { return d_sweep_active; }
+
     /* sample sniffer */
     status      start_sniffer(unsigned int samplrate, int buffsize);
     status      stop_sniffer();
@@ -218,14 +255,29 @@ public:
     bool        is_snifffer_active(void) const { return d_sniffer_active; }
 
     /* rds functions */
-    void        get_rds_data(std::string &outbuff, int &num);
+    void        get_rds_state(gr::rds::station_state &state);
     void        start_rds_decoder(void);
     void        stop_rds_decoder();
     bool        is_rds_decoder_active(void) const;
     void        reset_rds_parser(void);
+    void        get_rds_stats(unsigned long &good, unsigned long &corrected,
+                              unsigned long &failed);
 
 private:
     void        connect_all(rx_chain type);
+    gr::basic_block_sptr    input_block(void) const;
+    unsigned int            input_interp(void) const;
+    gr::basic_block_sptr    iq_tap(void) const;
+    void        connect_iq_sink(void);
+    void        disconnect_iq_sink(void);
+    void        arm_time_machine(void);
+    void        disarm_time_machine(void);
+    void        create_time_machine(void);
+    void        release_iq_sink(void);
+    void        restore_iq_sink(void);
+    void        create_audio_sink(void);
+    double      auto_audio_rate(void) const;
+    void        update_audio_rate(void);
 
 private:
     bool        d_running;          /*!< Whether receiver is running or not. */
@@ -233,17 +285,28 @@ private:
     double      d_decim_rate;       /*!< Rate after decimation (input_rate / decim) */
     double      d_quad_rate;        /*!< Quadrature rate (after down-conversion) */
     double      d_audio_rate;       /*!< Audio output rate. */
+    unsigned int    d_audio_rate_req;   /*!< Requested audio rate, 0 for auto. */
     unsigned int    d_decim;        /*!< input decimation. */
     unsigned int    d_ddc_decim;    /*!< Down-conversion decimation. */
     double      d_rf_freq;          /*!< Current RF frequency. */
     double      d_filter_offset;    /*!< Current filter offset */
     double      d_cw_offset;        /*!< CW offset */
+    double      d_filter_low;       /*!< Current filter low cut */
+    double      d_filter_high;      /*!< Current filter high cut */
     bool        d_recording_iq;     /*!< Whether we are recording I/Q file. */
     bool        d_recording_wav;    /*!< Whether we are recording WAV file. */
     bool        d_sniffer_active;   /*!< Only one data decoder allowed. */
+    unsigned int    d_sniffer_rate; /*!< Sample rate of the sniffer. */
+    bool        d_sweep_active;     /*!< Wideband sweep in progress. */
     bool        d_iq_rev;           /*!< Whether I/Q is reversed or not. */
     bool        d_dc_cancel;        /*!< Enable automatic DC removal. */
     bool        d_iq_balance;       /*!< Enable automatic IQ balance. */
+    bool        d_fused_nbrx;       /*!< Use single block narrow band receiver. */
+    iq_format   d_input_fmt;        /*!< Sample format of the input file. */
+    double      d_tm_seconds;       /*!< Length of the I/Q time machine, 0 if disabled. */
+    iq_format   d_tm_fmt;           /*!< Sample format of the I/Q time machine. */
+    size_t      d_tm_buffer;        /*!< Recording buffer added to the time machine. */
+    uint64_t    d_closed_write_errors; /*!< Write errors of finished I/Q recordings. */
 
     std::string input_devstr;  /*!< Current input device string. */
     std::string output_devstr; /*!< Current output device string. */
@@ -253,21 +316,25 @@ private:
     gr::top_block_sptr         tb;        /*!< The GNU Radio top block. */
 
     osmosdr::source::sptr     src;       /*!< Real time I/Q source. */
+    iq_decoder_c_sptr         iq_dec;    /*!< Converts compact I/Q files during playback. */
     fir_decim_cc_sptr         input_decim;      /*!< Input decimator. */
     receiver_base_cf_sptr     rx;        /*!< receiver. */
 
-    dc_corr_cc_sptr           dc_corr;   /*!< DC corrector block. */
+    dc_corr_cc_sptr           dc_corr;   /*!< DC and I/Q corrector block. */
     iq_swap_cc_sptr           iq_swap;   /*!< I/Q swapping block. */
 
     rx_fft_c_sptr             iq_fft;     /*!< Baseband FFT block. */
     rx_fft_f_sptr             audio_fft;  /*!< Audio FFT block. */
+    rx_sweep_c_sptr           sweep;      /*!< Wideband sweep block. */
 
     downconverter_cc_sptr     ddc;        /*!< Digital down-converter for demod chain. */
 
     gr::blocks::multiply_const_ff::sptr audio_gain0; /*!< Audio gain block. */
     gr::blocks::multiply_const_ff::sptr audio_gain1; /*!< Audio gain block. */
 
-    gr::blocks::file_sink::sptr         iq_sink;     /*!< I/Q file sink. */
+    async_file_sink_sptr                iq_sink;     /*!< I/Q file sink or time machine. */
+    std::list<async_file_sink_sptr>     iq_sinks_closing; /*!< I/Q file sinks being finished. */
+    iq_encoder_c_sptr                   iq_enc;      /*!< I/Q format converter for recording. */
 
     gr::blocks::wavfile_sink::sptr      wav_sink;   /*!< WAV file sink for recording. */
     gr::blocks::wavfile_source::sptr    wav_src;    /*!< WAV file source for playback. */
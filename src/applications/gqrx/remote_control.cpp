@@ -45,6 +45,8 @@ RemoteControl::RemoteControl(QObject *parent) :
     signal_level = -200.0;
     squelch_level = -150.0;
     audio_recorder_status = false;
+    scanner_status = false;
+    iq_recorder_status = false;
     receiver_running = false;
     hamlib_compatible = false;
 
@@ -361,6 +363,18 @@ void RemoteControl::stopAudioRecorder()
     audio_recorder_status = false;
 }
 
+/*! \brief Set scanner status (from mainwindow). */
+void RemoteControl::setScannerStatus(bool running)
+{
+    scanner_status = running;
+}
+
+/*! \brief Set I/Q recorder status (from mainwindow). */
+void RemoteControl::setIqRecorderStatus(bool recording)
+{
+    iq_recorder_status = recording;
+}
+
 /*! \brief Set receiver status (from mainwindow). */
 void RemoteControl::setReceiverStatus(bool enabled)
 {
@@ -683,9 +697,13 @@ QString RemoteControl::cmd_get_func(QStringList cmdlist)
     QString func = cmdlist.value(1, "");
 
     if (func == "?")
-        answer = QString("RECORD\n");
+        answer = QString("RECORD IQRECORD SCAN\n");
     else if (func.compare("RECORD", Qt::CaseInsensitive) == 0)
         answer = QString("%1\n").arg(audio_recorder_status);
+    else if (func.compare("IQRECORD", Qt::CaseInsensitive) == 0)
+        answer = QString("%1\n").arg(iq_recorder_status);
+    else if (func.compare("SCAN", Qt::CaseInsensitive) == 0)
+        answer = QString("%1\n").arg(scanner_status);
     else
         answer = QString("RPRT 1\n");
 
@@ -702,7 +720,7 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
 
     if (func == "?")
     {
-        answer = QString("RECORD\n");
+        answer = QString("RECORD IQRECORD SCAN\n");
     }
     else if ((func.compare("RECORD", Qt::CaseInsensitive) == 0) && ok)
     {
@@ -720,6 +738,36 @@ QString RemoteControl::cmd_set_func(QStringList cmdlist)
                 emit stopAudioRecorderEvent();
         }
     }
+    else if ((func.compare("IQRECORD", Qt::CaseInsensitive) == 0) && ok)
+    {
+        if (!receiver_running)
+        {
+            answer = QString("RPRT 1\n");
+        }
+        else
+        {
+            answer = QString("RPRT 0\n");
+            if (status)
+                emit startIqRecorderEvent();
+            else
+                emit stopIqRecorderEvent();
+        }
+    }
+    else if ((func.compare("SCAN", Qt::CaseInsensitive) == 0) && ok)
+    {
+        if (!receiver_running)
+        {
+            answer = QString("RPRT 1\n");
+        }
+        else
+        {
+            answer = QString("RPRT 0\n");
+            if (status)
+                emit startScannerEvent();
+            else
+                emit stopScannerEvent();
+        }
+    }
     else
     {
         answer = QString("RPRT 1\n");
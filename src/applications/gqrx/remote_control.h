@@ -94,6 +94,8 @@ public slots:
     void setSquelchLevel(double level);
     void startAudioRecorder(QString unused);
     void stopAudioRecorder();
+    void setScannerStatus(bool running);
+    void setIqRecorderStatus(bool recording);
     bool setGain(QString name, double gain);
 
 signals:
@@ -105,6 +107,10 @@ signals:
     void newSquelchLevel(double level);
     void startAudioRecorderEvent();
     void stopAudioRecorderEvent();
+    void startScannerEvent();
+    void stopScannerEvent();
+    void startIqRecorderEvent();
+    void stopIqRecorderEvent();
     void gainChanged(QString name, double value);
 
 private slots:
@@ -129,6 +135,8 @@ private:
     float       signal_level;      /*!< Signal level in dBFS */
     double      squelch_level;     /*!< Squelch level in dBFS */
     bool        audio_recorder_status; /*!< Recording enabled */
+    bool        scanner_status;    /*!< Scanner running */
+    bool        iq_recorder_status; /*!< I/Q recording */
     bool        receiver_running;  /*!< Wether the receiver is running or not */
     bool        hamlib_compatible;
     gain_list_t gains;             /*!< Possible and current gain settings */
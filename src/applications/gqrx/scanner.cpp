@@ -0,0 +1,424 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <QDebug>
+#include <QtGlobal>
+#include "scanner.h"
+#include "qtgui/bookmarks.h"
+
+#define DEFAULT_THRESHOLD   10.0f   /* dB above noise floor */
+#define DEFAULT_DWELL_MS    1000
+#define DEFAULT_HANG_MS     2000
+#define DEFAULT_SETTLE_MS   100
+#define DEFAULT_CHANNEL_BW  10000
+#define MAX_CHANNELS        100000
+
+/* Only use the central part of the spectrum where the anti-aliasing
+ * filters of the hardware do not attenuate the signals.
+ */
+#define USABLE_SPAN         0.8
+
+Scanner::Scanner(QObject *parent) :
+    QObject(parent),
+    state(SCANNER_IDLE),
+    next_ch(0),
+    curr_ch(-1),
+    center_freq(0),
+    threshold(DEFAULT_THRESHOLD),
+    dwell_ms(DEFAULT_DWELL_MS),
+    hang_ms(DEFAULT_HANG_MS),
+    settle_ms(DEFAULT_SETTLE_MS)
+{
+    state_timer.start();
+    sql_timer.start();
+}
+
+/*! \brief Read settings. */
+void Scanner::readSettings(QSettings *settings)
+{
+    bool    conv_ok;
+    int     int_val;
+    float   flt_val;
+
+    if (!settings)
+        return;
+
+    settings->beginGroup("scanner");
+
+    flt_val = settings->value("threshold", DEFAULT_THRESHOLD).toFloat(&conv_ok);
+    if (conv_ok)
+        setThreshold(flt_val);
+
+    int_val = settings->value("dwell_ms", DEFAULT_DWELL_MS).toInt(&conv_ok);
+    if (conv_ok)
+        setDwellTime(int_val);
+
+    int_val = settings->value("hang_ms", DEFAULT_HANG_MS).toInt(&conv_ok);
+    if (conv_ok)
+        setHangTime(int_val);
+
+    int_val = settings->value("settle_ms", DEFAULT_SETTLE_MS).toInt(&conv_ok);
+    if (conv_ok)
+        setSettleTime(int_val);
+
+    ranges = settings->value("ranges", QStringList()).toStringList();
+
+    settings->endGroup();
+}
+
+/*! \brief Save settings. */
+void Scanner::saveSettings(QSettings *settings) const
+{
+    if (!settings)
+        return;
+
+    settings->beginGroup("scanner");
+
+    if (threshold != DEFAULT_THRESHOLD)
+        settings->setValue("threshold", threshold);
+    else
+        settings->remove("threshold");
+
+    if (dwell_ms != DEFAULT_DWELL_MS)
+        settings->setValue("dwell_ms", dwell_ms);
+    else
+        settings->remove("dwell_ms");
+
+    if (hang_ms != DEFAULT_HANG_MS)
+        settings->setValue("hang_ms", hang_ms);
+    else
+        settings->remove("hang_ms");
+
+    if (settle_ms != DEFAULT_SETTLE_MS)
+        settings->setValue("settle_ms", settle_ms);
+    else
+        settings->remove("settle_ms");
+
+    if (ranges.count() > 0)
+        settings->setValue("ranges", ranges);
+    else
+        settings->remove("ranges");
+
+    settings->endGroup();
+}
+
+/*! \brief Remove all channels from the scan list.
+ *
+ * The scanner is stopped if it is running.
+ */
+void Scanner::clearChannels()
+{
+    stop();
+    channels.clear();
+}
+
+/*! \brief Add a single channel to the scan list.
+ *  \param freq The channel center frequency in Hz.
+ *  \param bandwidth The channel bandwidth in Hz.
+ *  \param demod The demodulator to use (empty string to keep current).
+ */
+void Scanner::addChannel(qint64 freq, qint64 bandwidth, const QString &demod)
+{
+    channel_t   ch;
+
+    if (channels.size() >= MAX_CHANNELS)
+        return;
+
+    ch.freq = freq;
+    ch.bandwidth = bandwidth > 0 ? bandwidth : DEFAULT_CHANNEL_BW;
+    ch.demod = demod;
+    channels.append(ch);
+}
+
+/*! \brief Add a range of channels to the scan list.
+ *  \param start The first channel frequency in Hz.
+ *  \param stop The last channel frequency in Hz.
+ *  \param step The channel spacing in Hz.
+ *  \param bandwidth The channel bandwidth in Hz (0 = use step).
+ */
+void Scanner::addRange(qint64 start, qint64 stop, qint64 step, qint64 bandwidth)
+{
+    qint64  freq;
+
+    if (step <= 0 || stop < start)
+        return;
+
+    if (bandwidth <= 0)
+        bandwidth = step;
+
+    for (freq = start; freq <= stop; freq += step)
+        addChannel(freq, bandwidth);
+}
+
+/*! \brief Add all active bookmarks to the scan list. */
+void Scanner::addBookmarks()
+{
+    Bookmarks  &bookmarks = Bookmarks::Get();
+
+    for (int i = 0; i < bookmarks.size(); i++)
+    {
+        BookmarkInfo &info = bookmarks.getBookmark(i);
+        if (info.IsActive())
+            addChannel(info.frequency, info.bandwidth, info.modulation);
+    }
+}
+
+/*! \brief Add the ranges stored in the settings to the scan list.
+ *
+ * Ranges are stored as a list of "start:stop:step[:bandwidth]" strings with
+ * all values in Hz.
+ */
+void Scanner::addRanges()
+{
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        QStringList fields = ranges[i].split(":");
+        bool        ok1, ok2, ok3, ok4 = true;
+        qint64      bw = 0;
+
+        if (fields.size() < 3)
+        {
+            qDebug() << "Scanner: Invalid range" << ranges[i];
+            continue;
+        }
+
+        qint64 start = fields[0].toLongLong(&ok1);
+        qint64 stop = fields[1].toLongLong(&ok2);
+        qint64 step = fields[2].toLongLong(&ok3);
+        if (fields.size() > 3)
+            bw = fields[3].toLongLong(&ok4);
+
+        if (ok1 && ok2 && ok3 && ok4)
+            addRange(start, stop, step, bw);
+        else
+            qDebug() << "Scanner: Invalid range" << ranges[i];
+    }
+}
+
+/*! \brief Set detection threshold.
+ *  \param level_db The threshold in dB above the noise floor.
+ */
+void Scanner::setThreshold(float level_db)
+{
+    threshold = qBound(1.0f, level_db, 60.0f);
+}
+
+/*! \brief Set minimum time to stay on a busy channel. */
+void Scanner::setDwellTime(int ms)
+{
+    dwell_ms = qMax(0, ms);
+}
+
+/*! \brief Set time the squelch must stay closed before scanning resumes. */
+void Scanner::setHangTime(int ms)
+{
+    hang_ms = qMax(0, ms);
+}
+
+/*! \brief Set time to wait for the hardware after moving the LO. */
+void Scanner::setSettleTime(int ms)
+{
+    settle_ms = qMax(0, ms);
+}
+
+/*! \brief Start scanning.
+ *
+ * Does nothing if the scan list is empty.
+ */
+void Scanner::start()
+{
+    if (channels.isEmpty())
+        return;
+
+    std::sort(channels.begin(), channels.end());
+    next_ch = 0;
+    curr_ch = -1;
+
+    qDebug() << "Scanner: Starting with" << channels.size() << "channels";
+
+    setState(SCANNER_SEARCHING);
+    emit scannerStateChanged(true);
+}
+
+/*! \brief Stop scanning. */
+void Scanner::stop()
+{
+    if (state == SCANNER_IDLE)
+        return;
+
+    setState(SCANNER_IDLE);
+    emit scannerStateChanged(false);
+}
+
+/*! \brief Update the signal level of the current channel.
+ *  \param level The signal level in dBFS.
+ *  \param sql_level The squelch level in dBFS.
+ *
+ * This is used to decide when to leave a channel. The scanner stays on the
+ * channel for at least the dwell time and until the squelch has been closed
+ * for the hang time. With the squelch fully open the scanner will stop on
+ * the first busy channel.
+ */
+void Scanner::setSignalLevel(float level, float sql_level)
+{
+    if (state != SCANNER_LISTENING)
+        return;
+
+    if (level >= sql_level)
+        sql_timer.restart();
+
+    if (state_timer.elapsed() >= dwell_ms && sql_timer.elapsed() >= hang_ms)
+        setState(SCANNER_SEARCHING);
+}
+
+/*! \brief Process new FFT data.
+ *  \param fft_db The FFT data in dBFS, DC in the middle.
+ *  \param fftsize The number of FFT bins.
+ *  \param center_freq The center frequency of the FFT in Hz.
+ *  \param span The span of the FFT in Hz (i.e. the sample rate).
+ *
+ * All channels within the capture bandwidth are checked in one go starting
+ * from the next channel in the list. If a busy channel is found, the scanner
+ * requests the receiver to tune to it and waits there. Otherwise the LO is
+ * moved so that the next unchecked channel is at the lower edge of the
+ * usable bandwidth.
+ */
+void Scanner::processFftData(const float *fft_db, int fftsize,
+                             qint64 center_freq, qint64 span)
+{
+    float   noise;
+    qint64  half_span;
+    int     idx;
+
+    if (state == SCANNER_IDLE || state == SCANNER_LISTENING)
+        return;
+
+    if (fftsize <= 0 || span <= 0 || channels.isEmpty())
+        return;
+
+    if (state == SCANNER_SETTLING)
+    {
+        if (state_timer.elapsed() < settle_ms)
+            return;
+        setState(SCANNER_SEARCHING);
+    }
+
+    half_span = (qint64)(0.5 * USABLE_SPAN * span);
+    noise = noiseFloor(fft_db, fftsize);
+
+    if (next_ch >= channels.size())
+        next_ch = 0;
+
+    for (idx = next_ch; idx < channels.size(); idx++)
+    {
+        const channel_t &ch = channels[idx];
+
+        if (std::llabs(ch.freq - center_freq) + halfWidth(ch, span) > half_span)
+            break;
+
+        if (channelLevel(fft_db, fftsize, center_freq, span, ch) - noise >= threshold)
+        {
+            curr_ch = idx;
+            next_ch = idx + 1;
+            emit newChannel(ch.freq, ch.demod, (int)ch.bandwidth);
+            setState(SCANNER_LISTENING);
+            sql_timer.restart();
+            return;
+        }
+    }
+
+    // nothing found in this part of the spectrum
+    next_ch = (idx < channels.size()) ? idx : 0;
+
+    const channel_t &next = channels[next_ch];
+    if (std::llabs(next.freq - center_freq) + halfWidth(next, span) > half_span)
+        hopTo(next_ch, span);
+}
+
+void Scanner::setState(scanner_state new_state)
+{
+    state = new_state;
+    state_timer.restart();
+}
+
+/*! \brief Get the average power of a channel.
+ *  \returns The average power across the channel bins in dB.
+ *
+ * The averaging is done on linear power so that a narrow carrier within the
+ * channel is not diluted by the logarithm.
+ */
+float Scanner::channelLevel(const float *fft_db, int fftsize, qint64 center_freq,
+                            qint64 span, const channel_t &ch) const
+{
+    double  hz_per_bin = (double)span / (double)fftsize;
+    double  start_freq = (double)(center_freq - span / 2);
+    qint64  half_bw = halfWidth(ch, span);
+    int     bin_lo, bin_hi, i;
+    float   sum = 0.0f;
+
+    bin_lo = (int)((ch.freq - half_bw - start_freq) / hz_per_bin);
+    bin_hi = (int)((ch.freq + half_bw - start_freq) / hz_per_bin);
+    bin_lo = qBound(0, bin_lo, fftsize - 1);
+    bin_hi = qBound(bin_lo, bin_hi, fftsize - 1);
+
+    for (i = bin_lo; i <= bin_hi; i++)
+        sum += powf(10.0f, 0.1f * fft_db[i]);
+
+    return 10.0f * log10f(sum / (float)(bin_hi - bin_lo + 1) + 1.0e-20f);
+}
+
+/*! \brief Estimate the noise floor as the median of the FFT bins. */
+float Scanner::noiseFloor(const float *fft_db, int fftsize)
+{
+    sort_buf.resize(fftsize);
+    std::copy(fft_db, fft_db + fftsize, sort_buf.begin());
+    std::nth_element(sort_buf.begin(), sort_buf.begin() + fftsize / 2,
+                     sort_buf.end());
+
+    return sort_buf[fftsize / 2];
+}
+
+/*! \brief Move the LO so that a channel is at the lower edge of the usable span. */
+void Scanner::hopTo(int ch_idx, qint64 span)
+{
+    const channel_t &ch = channels[ch_idx];
+    qint64 half_span = (qint64)(0.5 * USABLE_SPAN * span);
+
+    center_freq = ch.freq - halfWidth(ch, span) + half_span;
+
+    setState(SCANNER_SETTLING);
+    emit newCenterFreq(center_freq);
+}
+
+/*! \brief Half of the channel bandwidth that is checked.
+ *
+ * Channels wider than the usable span are clipped to it and checked around
+ * their center. Otherwise they would never fit and the scanner would keep
+ * hopping to the same channel.
+ */
+qint64 Scanner::halfWidth(const channel_t &ch, qint64 span) const
+{
+    return std::min(ch.bandwidth / 2, (qint64)(0.5 * USABLE_SPAN * span));
+}
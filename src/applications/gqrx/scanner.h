@@ -0,0 +1,148 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSettings>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*! \brief Energy detecting frequency scanner.
+ *
+ * The scanner walks through a list of channels made of the active bookmarks
+ * and user defined ranges (start, stop, step). Instead of retuning to each
+ * channel and waiting for the squelch, the channel energy is measured directly
+ * in the baseband FFT bins. All channels that fall within the current capture
+ * bandwidth are checked on every FFT frame and only the filter offset (DDC) is
+ * changed when a busy channel is found. The hardware LO is only moved when the
+ * next channel to check is outside the capture bandwidth.
+ *
+ * Once a channel is found the scanner stays there for at least the dwell time
+ * and as long as the squelch is open. Scanning resumes when the squelch has
+ * been closed for the hang time.
+ *
+ * The scanner does not talk to the receiver directly. It is fed with FFT data
+ * and signal levels by the main window and requests retuning via signals.
+ */
+class Scanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Scanner(QObject *parent = 0);
+
+    void readSettings(QSettings *settings);
+    void saveSettings(QSettings *settings) const;
+
+    void clearChannels(void);
+    void addChannel(qint64 freq, qint64 bandwidth, const QString &demod = "");
+    void addRange(qint64 start, qint64 stop, qint64 step, qint64 bandwidth);
+    void addBookmarks(void);
+    void addRanges(void);
+    int  numChannels(void) const
+    {
+        return channels.size();
+    }
+
+    void  setThreshold(float level_db);
+    float getThreshold(void) const
+    {
+        return threshold;
+    }
+
+    void setDwellTime(int ms);
+    void setHangTime(int ms);
+    void setSettleTime(int ms);
+
+    bool isRunning(void) const
+    {
+        return state != SCANNER_IDLE;
+    }
+
+    void processFftData(const float *fft_db, int fftsize,
+                        qint64 center_freq, qint64 span);
+
+public slots:
+    void start(void);
+    void stop(void);
+    void setSignalLevel(float level, float sql_level);
+
+signals:
+    /*! \brief Hardware LO must be moved (center frequency of the FFT). */
+    void newCenterFreq(qint64 freq);
+
+    /*! \brief A busy channel has been found within the capture bandwidth. */
+    void newChannel(qint64 freq, QString demod, int bandwidth);
+
+    /*! \brief Scanner has been started or stopped. */
+    void scannerStateChanged(bool running);
+
+private:
+    /*! \brief A single channel to check. */
+    struct channel_t
+    {
+        qint64  freq;       /*!< Channel center frequency in Hz. */
+        qint64  bandwidth;  /*!< Channel bandwidth in Hz. */
+        QString demod;      /*!< Demodulator (empty = keep current). */
+
+        bool operator<(const channel_t &other) const
+        {
+            return freq < other.freq;
+        }
+    };
+
+    enum scanner_state {
+        SCANNER_IDLE      = 0,  /*!< Scanner not running. */
+        SCANNER_SETTLING  = 1,  /*!< Waiting for the LO and FFT to settle. */
+        SCANNER_SEARCHING = 2,  /*!< Checking channels in the FFT. */
+        SCANNER_LISTENING = 3   /*!< Stopped on a busy channel. */
+    };
+
+    QVector<channel_t>  channels;       /*!< Sorted channel list. */
+    QStringList         ranges;         /*!< Ranges as "start:stop:step:bw". */
+    QVector<float>      sort_buf;       /*!< Scratch buffer for noise floor. */
+
+    scanner_state   state;
+    int             next_ch;        /*!< Index of next channel to check. */
+    int             curr_ch;        /*!< Index of the channel we listen to. */
+    qint64          center_freq;    /*!< Center frequency requested by us. */
+
+    float           threshold;      /*!< Detection threshold in dB above noise floor. */
+    int             dwell_ms;       /*!< Minimum time on a busy channel. */
+    int             hang_ms;        /*!< Time the squelch must be closed before resuming. */
+    int             settle_ms;      /*!< Time to ignore FFT data after an LO hop. */
+
+    QElapsedTimer   state_timer;    /*!< Time since last state change. */
+    QElapsedTimer   sql_timer;      /*!< Time since squelch was last open. */
+
+    void    setState(scanner_state new_state);
+    float   channelLevel(const float *fft_db, int fftsize, qint64 center_freq,
+                         qint64 span, const channel_t &ch) const;
+    float   noiseFloor(const float *fft_db, int fftsize);
+    void    hopTo(int ch_idx, qint64 span);
+    qint64  halfWidth(const channel_t &ch, qint64 span) const;
+};
+
+#endif // SCANNER_H
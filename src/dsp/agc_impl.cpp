@@ -7,6 +7,8 @@
 //	2010-09-15  Initial creation MSW
 //	2011-03-27  Initial release
 //      2011-09-24  Adapted for gqrx
+//      2026-10-19  O(1) peak detector and block processing, see
+//                  bench/agc_bench.cpp
 //////////////////////////////////////////////////////////////////////
 //==========================================================================================
 // + + +   This Software is released under the "Simplified BSD License"  + + +
@@ -39,6 +41,8 @@
 
 #include <dsp/agc_impl.h>
 #include <math.h>
+#include <algorithm>
+#include <volk/volk.h>
 
 //////////////////////////////////////////////////////////////////////
 // Local Defines
@@ -75,10 +79,15 @@
                             // corresponding to -160dB.
                             // K = 10^(-8 + log(MAX_AMP))
 
+// number of samples between exact gain calculations, the gain is linearly
+// interpolated in between. Must be a divisor of AGC_BLOCK_SIZE.
+#define AGC_GAIN_STEP 16
+
+#define LOG10_2 0.30102999566f
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
-
 CAgc::CAgc()
 {
     m_AgcOn = true;
@@ -101,17 +110,38 @@ CAgc::CAgc()
     m_GainSlope = 0.f;
     m_Peak = 0.f;
     m_SigDelayPtr = 0;
-    m_MagBufPos = 0;
-    m_DelaySamples = 0;
-    m_WindowSamples = 0;
+    m_DelaySamples = 1;
+    m_WindowSamples = 1;
     m_HangTime = 0;
     m_HangTimer = 0;
+    m_LastGain = 0.f;
+    m_PeakHead = 0;
+    m_PeakCount = 0;
+    m_SampleNum = 0;
 }
 
 CAgc::~CAgc()
 {
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Clears the signal delay line and the level detectors, e.g. after the
+// input was muted by the squelch
+////////////////////////////////////////////////////////////////////////////////
+void CAgc::Reset()
+{
+    for (int i = 0; i < MAX_DELAY_BUF; i++)
+        m_SigDelayBuf[i] = 0.0;
+    m_SigDelayPtr = 0;
+    m_HangTimer = 0;
+    m_Peak = -16.0;
+    m_DecayAve = -5.0;
+    m_AttackAve = -5.0;
+    m_PeakHead = 0;
+    m_PeakCount = 0;
+    m_SampleNum = 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Sets and calculates various AGC parameters
 //  "On"  switches between AGC on and off.
@@ -142,17 +172,7 @@ void CAgc::SetParameters(bool AgcOn,  bool UseHang, int Threshold, int ManualGai
     {
         //clear out delay buffer and init some things if sample rate changes
         m_SampleRate = SampleRate;
-        for (int i = 0; i < MAX_DELAY_BUF; i++)
-        {
-            m_SigDelayBuf[i] = 0.0;
-            m_MagBuf[i] = -16.0;
-        }
-        m_SigDelayPtr = 0;
-        m_HangTimer = 0;
-        m_Peak = -16.0;
-        m_DecayAve = -5.0;
-        m_AttackAve = -5.0;
-        m_MagBufPos = 0;
+        Reset();
     }
 
     // convert m_ThreshGain to linear manual gain value
@@ -181,144 +201,198 @@ void CAgc::SetParameters(bool AgcOn,  bool UseHang, int Threshold, int ManualGai
     m_DelaySamples = (int)(m_SampleRate * DELAY_TIMECONST);
     m_WindowSamples = (int)(m_SampleRate * WINDOW_TIMECONST);
 
-    // clamp Delay samples within buffer limit
-    if (m_DelaySamples >= MAX_DELAY_BUF - 1)
-        m_DelaySamples = MAX_DELAY_BUF - 1;
+    // clamp Delay and window samples within buffer limit
+    m_DelaySamples = std::max(1, std::min(m_DelaySamples, MAX_DELAY_BUF - 1));
+    m_WindowSamples = std::max(1, std::min(m_WindowSamples, MAX_DELAY_BUF));
+    if (m_SigDelayPtr >= m_DelaySamples)
+        m_SigDelayPtr = 0;
+
+    m_LastGain = m_FixedGain;
 }
 
+//////////////////////////////////////////////////////////////////////
+// Sliding window peak detector
+//
+// Keeps a deque of magnitudes that are decreasing from head to tail.
+// A new sample removes all smaller samples from the tail since they can
+// never become the peak again, and the head is dropped when it leaves the
+// window. The peak is always at the head, which makes the detector O(1)
+// per sample instead of rescanning the window when the peak expires.
+//////////////////////////////////////////////////////////////////////
+void CAgc::UpdatePeak(float mag)
+{
+    int     tail;
 
+    // drop the head if it is older than the window
+    if (m_PeakCount > 0 &&
+        m_SampleNum - m_PeakIdx[m_PeakHead] >= (unsigned)m_WindowSamples)
+    {
+        m_PeakHead = (m_PeakHead + 1) & (MAX_DELAY_BUF - 1);
+        m_PeakCount--;
+    }
+
+    // drop smaller samples from the tail
+    while (m_PeakCount > 0)
+    {
+        tail = (m_PeakHead + m_PeakCount - 1) & (MAX_DELAY_BUF - 1);
+        if (m_PeakVal[tail] > mag)
+            break;
+        m_PeakCount--;
+    }
+
+    tail = (m_PeakHead + m_PeakCount) & (MAX_DELAY_BUF - 1);
+    m_PeakVal[tail] = mag;
+    m_PeakIdx[tail] = m_SampleNum++;
+    m_PeakCount++;
+
+    m_Peak = m_PeakVal[m_PeakHead];
+}
 
 //////////////////////////////////////////////////////////////////////
-// Automatic Gain Control calculator for COMPLEX data
+// Calculate the gain for a block of log magnitudes in m_MagTmp.
+// The result is written to m_GainTmp.
 //////////////////////////////////////////////////////////////////////
-void CAgc::ProcessData(int Length, const TYPECPX * pInData, TYPECPX * pOutData)
+void CAgc::CalcGain(int Length)
 {
     float       gain;
     float       mag;
-    TYPECPX     delayedin;
+    float       step;
+    int         i, j, n;
 
-    if (m_AgcOn)
+    for (i = 0; i < Length; i++)
     {
-        for (int i = 0; i < Length; i++)
+        UpdatePeak(m_MagTmp[i]);
+
+        if (m_UseHang)
         {
-            // get latest input sample
-            TYPECPX     in = pInData[i];
-
-            // Get delayed sample of input signal
-            delayedin = m_SigDelayBuf[m_SigDelayPtr];
-
-            // put new input sample into signal delay buffer
-            m_SigDelayBuf[m_SigDelayPtr++] = in;
-
-            // deal with delay buffer wrap around
-            if (m_SigDelayPtr >= m_DelaySamples)
-                m_SigDelayPtr = 0;
-
-            mag = fabs(in.real());
-            float mim = fabs(in.imag());
-            if (mim > mag)
-                mag = mim;
-            mag = log10f(mag + MIN_CONSTANT) - LOG_MAX_AMPL;
-
-            // create a sliding window of 'm_WindowSamples' magnitudes and output the peak value within the sliding window
-            float tmp = m_MagBuf[m_MagBufPos];   // get oldest mag sample from buffer into tmp
-            m_MagBuf[m_MagBufPos++] = mag;       // put latest mag sample in buffer;
-            if (m_MagBufPos >= m_WindowSamples)  // deal with magnitude buffer wrap around
-                m_MagBufPos = 0;
-            if (mag > m_Peak)
-            {
-                m_Peak = mag;	//if new sample is larger than current peak then use it, no need to look at buffer values
-            }
+            // using hang timer mode
+            if (m_Peak > m_AttackAve)
+                // if power is rising (use m_AttackRiseAlpha time constant)
+                m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
+                              m_AttackRiseAlpha * m_Peak;
             else
-            {
-                if (tmp == m_Peak)    //tmp is oldest sample pulled out of buffer
-                {                     //if oldest sample pulled out was last peak then need to find next highest peak in buffer
-                    m_Peak = -8.0;    //set to lowest value to find next max peak
-                    //search all buffer for maximum value and set as new peak
-                    for (int i = 0; i < m_WindowSamples; i++)
-                    {
-                        tmp = m_MagBuf[i];
-                        if (tmp > m_Peak)
-                            m_Peak = tmp;
-                    }
-                }
-            }
+                // else magnitude is falling (use  m_AttackFallAlpha time constant)
+                m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
+                              m_AttackFallAlpha * m_Peak;
 
-            if (m_UseHang)
+            if (m_Peak > m_DecayAve)
             {
-                // using hang timer mode
-                if (m_Peak > m_AttackAve)
-                    // if power is rising (use m_AttackRiseAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
-                                  m_AttackRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use  m_AttackFallAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
-                                  m_AttackFallAlpha * m_Peak;
-
-                if (m_Peak > m_DecayAve)
-                {
-                    // if magnitude is rising (use m_DecayRiseAlpha time constant)
-                    m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
-                                  m_DecayRiseAlpha * m_Peak;
-                    // reset hang timer
-                    m_HangTimer = 0;
-                }
-                else
-                {	// here if decreasing signal
-                    if (m_HangTimer < m_HangTime)
-                        m_HangTimer++;	// just inc and hold current m_DecayAve
-                    else	// else decay with m_DecayFallAlpha which is RELEASE_TIMECONST
-                        m_DecayAve = (1.0 - m_DecayFallAlpha) * m_DecayAve +
-                                     m_DecayFallAlpha * m_Peak;
-                }
+                // if magnitude is rising (use m_DecayRiseAlpha time constant)
+                m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
+                              m_DecayRiseAlpha * m_Peak;
+                // reset hang timer
+                m_HangTimer = 0;
             }
             else
-            {
-                // using exponential decay mode
-                // perform average of magnitude using 2 averagers each with separate rise and fall time constants
-                if (m_Peak > m_AttackAve)	//if magnitude is rising (use m_AttackRiseAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
-                                  m_AttackRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use  m_AttackFallAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
-                                  m_AttackFallAlpha * m_Peak;
-
-                if (m_Peak > m_DecayAve)
-                    // if magnitude is rising (use m_DecayRiseAlpha time constant)
-                    m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
-                                 m_DecayRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use m_DecayFallAlpha time constant)
+            {	// here if decreasing signal
+                if (m_HangTimer < m_HangTime)
+                    m_HangTimer++;	// just inc and hold current m_DecayAve
+                else	// else decay with m_DecayFallAlpha which is RELEASE_TIMECONST
                     m_DecayAve = (1.0 - m_DecayFallAlpha) * m_DecayAve +
                                  m_DecayFallAlpha * m_Peak;
             }
-
-            // use greater magnitude of attack or Decay Averager
-            if (m_AttackAve > m_DecayAve)
-                mag = m_AttackAve;
+        }
+        else
+        {
+            // using exponential decay mode
+            // perform average of magnitude using 2 averagers each with separate rise and fall time constants
+            if (m_Peak > m_AttackAve)	//if magnitude is rising (use m_AttackRiseAlpha time constant)
+                m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
+                              m_AttackRiseAlpha * m_Peak;
             else
-                mag = m_DecayAve;
-
-            // calc gain depending on which side of knee the magnitude is on
-            if (mag <= m_Knee)
-                // use fixed gain if below knee
-                gain = m_FixedGain;
+                // else magnitude is falling (use  m_AttackFallAlpha time constant)
+                m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
+                              m_AttackFallAlpha * m_Peak;
+
+            if (m_Peak > m_DecayAve)
+                // if magnitude is rising (use m_DecayRiseAlpha time constant)
+                m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
+                             m_DecayRiseAlpha * m_Peak;
             else
-                // use variable gain if above knee
-                gain = AGC_OUTSCALE * powf(10.0, mag * (m_GainSlope - 1.0));
+                // else magnitude is falling (use m_DecayFallAlpha time constant)
+                m_DecayAve = (1.0 - m_DecayFallAlpha) * m_DecayAve +
+                             m_DecayFallAlpha * m_Peak;
+        }
+
+        // use greater magnitude of attack or Decay Averager
+        // (the magnitude buffer is reused for the averaged magnitude)
+        m_MagTmp[i] = std::max(m_AttackAve, m_DecayAve);
+    }
 
-            pOutData[i] = delayedin * gain;
+    // The averaged magnitude changes slowly compared to the sample rate so
+    // the gain is only calculated every AGC_GAIN_STEP samples and linearly
+    // interpolated in between. This saves most of the powf() calls.
+    for (i = 0; i < Length; i += AGC_GAIN_STEP)
+    {
+        n = std::min(AGC_GAIN_STEP, Length - i);
+        mag = m_MagTmp[i + n - 1];
+
+        // calc gain depending on which side of knee the magnitude is on
+        if (mag <= m_Knee)
+            // use fixed gain if below knee
+            gain = m_FixedGain;
+        else
+            // use variable gain if above knee
+            gain = AGC_OUTSCALE * powf(10.0, mag * (m_GainSlope - 1.0));
+
+        step = (gain - m_LastGain) / (float)n;
+        for (j = 0; j < n; j++)
+            m_GainTmp[i + j] = m_LastGain + step * (float)(j + 1);
+
+        m_LastGain = gain;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Automatic Gain Control calculator for COMPLEX data
+//////////////////////////////////////////////////////////////////////
+void CAgc::ProcessData(int Length, const TYPECPX * pInData, TYPECPX * pOutData)
+{
+    if (m_AgcOn)
+    {
+        while (Length > 0)
+        {
+            int n = std::min(Length, AGC_BLOCK_SIZE);
+            int i, k;
+
+            // peak of |I| and |Q| converted to log10 with volk
+            for (i = 0; i < n; i++)
+            {
+                float mag = std::max(fabsf(pInData[i].real()), fabsf(pInData[i].imag()));
+                m_MagTmp[i] = mag + MIN_CONSTANT;
+            }
+            volk_32f_log2_32f(m_MagTmp, m_MagTmp, n);
+            volk_32f_s32f_multiply_32f(m_MagTmp, m_MagTmp, LOG10_2, n);
+            if (LOG_MAX_AMPL != 0.f)
+                for (i = 0; i < n; i++)
+                    m_MagTmp[i] -= LOG_MAX_AMPL;
+
+            CalcGain(n);
+
+            // run the input through the signal delay line
+            for (i = 0; i < n; i += k)
+            {
+                k = std::min(n - i, m_DelaySamples - m_SigDelayPtr);
+                std::copy(m_SigDelayBuf + m_SigDelayPtr, m_SigDelayBuf + m_SigDelayPtr + k,
+                          m_DelayTmp + i);
+                std::copy(pInData + i, pInData + i + k, m_SigDelayBuf + m_SigDelayPtr);
+                m_SigDelayPtr += k;
+                if (m_SigDelayPtr >= m_DelaySamples)
+                    m_SigDelayPtr = 0;
+            }
+
+            volk_32fc_32f_multiply_32fc(pOutData, m_DelayTmp, m_GainTmp, n);
+
+            pInData += n;
+            pOutData += n;
+            Length -= n;
         }
     }
     else
     {
         // manual gain just multiply by m_ManualGain
-        for (int i = 0; i < Length; i++)
-        {
-            pOutData[i] = m_ManualAgcGain * pInData[i];
-        }
+        volk_32f_s32f_multiply_32f((float *)pOutData, (const float *)pInData,
+                                   m_ManualAgcGain, 2 * Length);
     }
 }
 
@@ -327,125 +401,48 @@ void CAgc::ProcessData(int Length, const TYPECPX * pInData, TYPECPX * pOutData)
 //////////////////////////////////////////////////////////////////////
 void CAgc::ProcessData(int Length, const float *pInData, float * pOutData)
 {
-    float       gain;
-    float       mag;
-    float       delayedin;
+    float      *delayed = (float *)m_DelayTmp;
 
     if (m_AgcOn)
     {
-        for (int i = 0; i < Length; i++)
+        while (Length > 0)
         {
-            // get latest input sample
-            float in = pInData[i];
-
-            // Get delayed sample of input signal
-            delayedin = m_SigDelayBuf_r[m_SigDelayPtr];
-
-            // put new input sample into signal delay buffer
-            m_SigDelayBuf_r[m_SigDelayPtr++] = in;
-            if (m_SigDelayPtr >= m_DelaySamples) //deal with delay buffer wrap around
-                m_SigDelayPtr = 0;
+            int n = std::min(Length, AGC_BLOCK_SIZE);
+            int i, k;
 
             // convert |mag| to log |mag|
-            mag = log10f(fabs(in) + MIN_CONSTANT) - LOG_MAX_AMPL;
-
-            // create a sliding window of 'm_WindowSamples' magnitudes and output the peak value within the sliding window
-            float tmp = m_MagBuf[m_MagBufPos];   // get oldest mag sample from buffer into tmp
-            m_MagBuf[m_MagBufPos++] = mag;       // put latest mag sample in buffer;
-            if (m_MagBufPos >= m_WindowSamples)  // deal with magnitude buffer wrap around
-                m_MagBufPos = 0;
-            if (mag > m_Peak)
+            for (i = 0; i < n; i++)
+                m_MagTmp[i] = fabsf(pInData[i]) + MIN_CONSTANT;
+            volk_32f_log2_32f(m_MagTmp, m_MagTmp, n);
+            volk_32f_s32f_multiply_32f(m_MagTmp, m_MagTmp, LOG10_2, n);
+            if (LOG_MAX_AMPL != 0.f)
+                for (i = 0; i < n; i++)
+                    m_MagTmp[i] -= LOG_MAX_AMPL;
+
+            CalcGain(n);
+
+            // run the input through the signal delay line
+            for (i = 0; i < n; i += k)
             {
-                m_Peak = mag;  // if new sample is larger than current peak then use it, no need to look at buffer values
-            }
-            else
-            {
-                if (tmp == m_Peak)   // tmp is oldest sample pulled out of buffer
-                {                    // if oldest sample pulled out was last peak then need to find next highest peak in buffer
-                    m_Peak = -8.0;   // set to lowest value to find next max peak
-                    // search all buffer for maximum value and set as new peak
-                    for (int i = 0; i < m_WindowSamples; i++)
-                    {
-                        tmp = m_MagBuf[i];
-                        if (tmp > m_Peak)
-                            m_Peak = tmp;
-                    }
-                }
+                k = std::min(n - i, m_DelaySamples - m_SigDelayPtr);
+                std::copy(m_SigDelayBuf_r + m_SigDelayPtr, m_SigDelayBuf_r + m_SigDelayPtr + k,
+                          delayed + i);
+                std::copy(pInData + i, pInData + i + k, m_SigDelayBuf_r + m_SigDelayPtr);
+                m_SigDelayPtr += k;
+                if (m_SigDelayPtr >= m_DelaySamples)
+                    m_SigDelayPtr = 0;
             }
 
-            if (m_UseHang)
-            {
-                // using hang timer mode
-                if (m_Peak > m_AttackAve)
-                    // if magnitude is rising (use m_AttackRiseAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
-                                  m_AttackRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use  m_AttackFallAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
-                                  m_AttackFallAlpha * m_Peak;
-
-                if (m_Peak > m_DecayAve)
-                {
-                    // if magnitude is rising (use m_DecayRiseAlpha time constant)
-                    m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
-                                 m_DecayRiseAlpha*m_Peak;
-                    m_HangTimer = 0; // reset hang timer
-                }
-                else
-                {
-                    // here if decreasing signal
-                    if (m_HangTimer < m_HangTime)
-                        m_HangTimer++; // just inc and hold current m_DecayAve
-                    else
-                        // else decay with m_DecayFallAlpha which is RELEASE_TIMECONST
-                        m_DecayAve = (1.0 - m_DecayFallAlpha) * m_DecayAve +
-                                     m_DecayFallAlpha * m_Peak;
-                }
-            }
-            else
-            {
-                // using exponential decay mode
-                // perform average of magnitude using 2 averagers each with separate rise and fall time constants
-                if (m_Peak > m_AttackAve)
-                    // if magnitude is rising (use m_AttackRiseAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackRiseAlpha) * m_AttackAve +
-                                  m_AttackRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use  m_AttackFallAlpha time constant)
-                    m_AttackAve = (1.0 - m_AttackFallAlpha) * m_AttackAve +
-                                  m_AttackFallAlpha * m_Peak;
-
-                if (m_Peak > m_DecayAve)
-                    // if magnitude is rising (use m_DecayRiseAlpha time constant)
-                    m_DecayAve = (1.0 - m_DecayRiseAlpha) * m_DecayAve +
-                                 m_DecayRiseAlpha * m_Peak;
-                else
-                    // else magnitude is falling (use m_DecayFallAlpha time constant)
-                    m_DecayAve = (1.0 - m_DecayFallAlpha) * m_DecayAve +
-                                 m_DecayFallAlpha * m_Peak;
-            }
-
-            // use greater magnitude of attack or Decay Averager
-            if (m_AttackAve > m_DecayAve)
-                mag = m_AttackAve;
-            else
-                mag = m_DecayAve;
+            volk_32f_x2_multiply_32f(pOutData, delayed, m_GainTmp, n);
 
-            // calc gain depending on which side of knee the magnitude is on
-            if (mag <= m_Knee)
-                // use fixed gain if below knee
-                gain = m_FixedGain;
-            else
-                // use variable gain if above knee
-                gain = AGC_OUTSCALE * powf(10.0, mag * (m_GainSlope - 1.0));
-            pOutData[i] = delayedin * gain;
+            pInData += n;
+            pOutData += n;
+            Length -= n;
         }
     }
     else
-    {	// manual gain just multiply by m_ManualGain
-        for (int i = 0; i < Length; i++)
-            pOutData[i] = m_ManualAgcGain * pInData[i];
+    {
+        // manual gain just multiply by m_ManualGain
+        volk_32f_s32f_multiply_32f(pOutData, pInData, m_ManualAgcGain, Length);
     }
-
 }
@@ -7,13 +7,18 @@
 //  2010-09-15  Initial creation MSW
 //  2011-03-27  Initial release
 //  2011-09-24  Adapted for gqrx
+//  2026-10-19  O(1) peak detector and block processing
 //////////////////////////////////////////////////////////////////////
 #ifndef AGC_IMPL_H
 #define AGC_IMPL_H
 
 #include <complex>
 
-#define MAX_DELAY_BUF 2048
+// large enough for the delay and peak window up to ~500 ksps
+#define MAX_DELAY_BUF 8192
+
+// samples processed in one pass through the block stages
+#define AGC_BLOCK_SIZE 1024
 
 /*
 typedef struct _dCplx
@@ -34,10 +39,14 @@ public:
     CAgc();
     virtual ~CAgc();
     void SetParameters(bool AgcOn, bool UseHang, int Threshold, int ManualGain, int Slope, int Decay, double SampleRate);
+    void Reset();
     void ProcessData(int Length, const TYPECPX * pInData, TYPECPX * pOutData);
     void ProcessData(int Length, const float * pInData, float * pOutData);
 
 private:
+    void UpdatePeak(float mag);
+    void CalcGain(int Length);
+
     bool        m_AgcOn;
     bool        m_UseHang;
     int         m_Threshold;
@@ -63,16 +72,28 @@ private:
     float       m_Peak;
 
     int         m_SigDelayPtr;
-    int         m_MagBufPos;
     int         m_DelaySamples;
     int         m_WindowSamples;
     int         m_HangTime;
     int         m_HangTimer;
 
+    float       m_LastGain;     // gain at the end of the previous gain step
+
     TYPECPX     m_SigDelayBuf[MAX_DELAY_BUF];
     float*      m_SigDelayBuf_r;
 
-    float       m_MagBuf[MAX_DELAY_BUF];
+    // monotonic deque of (magnitude, sample number) used as sliding window
+    // peak detector; the values are decreasing from head to tail
+    float       m_PeakVal[MAX_DELAY_BUF];
+    unsigned    m_PeakIdx[MAX_DELAY_BUF];
+    int         m_PeakHead;
+    int         m_PeakCount;
+    unsigned    m_SampleNum;
+
+    // scratch buffers for block processing
+    float       m_MagTmp[AGC_BLOCK_SIZE];
+    float       m_GainTmp[AGC_BLOCK_SIZE];
+    TYPECPX     m_DelayTmp[AGC_BLOCK_SIZE];
 };
 
 #endif //  AGC_IMPL_H
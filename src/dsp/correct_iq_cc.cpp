@@ -4,6 +4,7 @@
  *           http://gqrx.dk/
  *
  * Copyright 2012-2013 Alexandru Csete OZ9AEC.
+ * Copyright 2026 Gqrx developers.
  *
  * Gqrx is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,11 +21,18 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <math.h>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/gr_complex.h>
 #include <iostream>
 #include "dsp/correct_iq_cc.h"
 
+/* Only every DC_CORR_STRIDE'th sample is used for the estimates. */
+#define DC_CORR_STRIDE 8
+
+/* Largest phase error that will be corrected, sin(30 deg). */
+#define DC_CORR_MAX_SIN 0.5
+
 
 dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau)
 {
@@ -37,59 +45,180 @@ dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau)
  * Use make_dc_corr_cc() instead.
  */
 dc_corr_cc::dc_corr_cc(double sample_rate, double tau)
-    : gr::hier_block2 ("dc_corr_cc",
+    : gr::sync_block ("dc_corr_cc",
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
-          gr::io_signature::make(1, 1, sizeof(gr_complex)))
+          gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_sr(sample_rate),
+      d_tau(tau),
+      d_dc_enabled(true),
+      d_iq_enabled(false),
+      d_dc_i(0.0),
+      d_dc_q(0.0),
+      d_ii(0.0),
+      d_qq(0.0),
+      d_iq(0.0),
+      d_corr_qi(0.0f),
+      d_corr_qq(1.0f)
 {
-    d_sr = sample_rate;
-    d_tau = tau;
-    d_alpha = 1.0 / (1.0 + d_tau * sample_rate);
-
 #ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
+    std::cout << "IQ DCR tau: " << d_tau << std::endl;
 #endif
+}
 
-    d_iir = gr::filter::single_pole_iir_filter_cc::make(d_alpha, 1);
-    d_sub = gr::blocks::sub_cc::make(1);
+dc_corr_cc::~dc_corr_cc()
+{
 
-    connect(self(), 0, d_iir, 0);
-    connect(self(), 0, d_sub, 0);
-    connect(d_iir, 0, d_sub, 1);
-    connect(d_sub, 0, self(), 0);
 }
 
-dc_corr_cc::~dc_corr_cc()
+/*! \brief DC and I/Q correction work method.
+ *
+ * The estimates are updated once per call using a subset of the samples.
+ * The correction itself is a single branch free pass over the buffer.
+ */
+int dc_corr_cc::work(int noutput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items)
 {
+    const float *in = (const float *) input_items[0];
+    float       *out = (float *) output_items[0];
+    int          i;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    update_estimate((const gr_complex *) in, noutput_items);
+
+    const float dc_i = d_dc_enabled ? (float) d_dc_i : 0.0f;
+    const float dc_q = d_dc_enabled ? (float) d_dc_q : 0.0f;
+    const float qi = d_corr_qi;
+    const float qq = d_corr_qq;
+
+    for (i = 0; i < noutput_items; i++)
+    {
+        float re = in[2 * i] - dc_i;
+        float im = in[2 * i + 1] - dc_q;
+
+        out[2 * i] = re;
+        out[2 * i + 1] = qi * re + qq * im;
+    }
+
+    return noutput_items;
+}
+
+/*! \brief Update the DC, gain and phase estimates.
+ *  \param in The input samples.
+ *  \param n The number of samples.
+ *
+ * The moments are taken around the DC estimate, which is tracked even when
+ * DC removal is disabled so that an offset does not bias the I/Q estimate.
+ */
+void dc_corr_cc::update_estimate(const gr_complex *in, int n)
+{
+    double  si = 0.0, sq = 0.0;
+    double  sii = 0.0, sqq = 0.0, siq = 0.0;
+    int     num = 0;
+    int     i;
+
+    for (i = 0; i < n; i += DC_CORR_STRIDE, num++)
+    {
+        double re = in[i].real();
+        double im = in[i].imag();
+
+        si += re;
+        sq += im;
+        sii += re * re;
+        sqq += im * im;
+        siq += re * im;
+    }
 
+    if (num == 0)
+        return;
+
+    // per call coefficient of a single pole filter with time constant tau
+    double alpha = 1.0 - exp(-(double) n / (d_tau * d_sr));
+    double mi = si / num;
+    double mq = sq / num;
+
+    d_dc_i += alpha * (mi - d_dc_i);
+    d_dc_q += alpha * (mq - d_dc_q);
+
+    if (!d_iq_enabled)
+        return;
+
+    // E[(x - dc)(y - dc)] = E[xy] - dc_x E[y] - dc_y E[x] + dc_x dc_y
+    double ii = sii / num - 2.0 * d_dc_i * mi + d_dc_i * d_dc_i;
+    double qq = sqq / num - 2.0 * d_dc_q * mq + d_dc_q * d_dc_q;
+    double iq = siq / num - d_dc_i * mq - d_dc_q * mi + d_dc_i * d_dc_q;
+
+    d_ii += alpha * (ii - d_ii);
+    d_qq += alpha * (qq - d_qq);
+    d_iq += alpha * (iq - d_iq);
+
+    if (d_ii <= 1.0e-20 || d_qq <= 1.0e-20)
+        return;
+
+    double g = sqrt(d_qq / d_ii);
+    double s = d_iq / sqrt(d_ii * d_qq);
+
+    if (s > DC_CORR_MAX_SIN)
+        s = DC_CORR_MAX_SIN;
+    else if (s < -DC_CORR_MAX_SIN)
+        s = -DC_CORR_MAX_SIN;
+
+    double c = sqrt(1.0 - s * s);
+
+    d_corr_qi = (float) (-s / c);
+    d_corr_qq = (float) (1.0 / (g * c));
 }
 
 /*! \brief Set new sample rate. */
 void dc_corr_cc::set_sample_rate(double sample_rate)
 {
-    d_sr = sample_rate;
-    d_alpha = 1.0 / (1.0 + d_tau * sample_rate);
+    boost::mutex::scoped_lock lock(d_mutex);
 
-    d_iir->set_taps(d_alpha);
+    d_sr = sample_rate;
 
 #ifndef QT_NO_DEBUG_OUTPUT
     std::cout << "IQ DCR samp_rate: " << sample_rate << std::endl;
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
 #endif
 }
 
 /*! \brief Set new time constant. */
 void dc_corr_cc::set_tau(double tau)
 {
-    d_tau = tau;
-    d_alpha = 1.0 / (1.0 + d_tau * d_sr);
+    boost::mutex::scoped_lock lock(d_mutex);
 
-    d_iir->set_taps(d_alpha);
+    d_tau = tau;
 
 #ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "IQ DCR alpha: " << d_alpha << std::endl;
+    std::cout << "IQ DCR tau: " << d_tau << std::endl;
 #endif
 }
 
+/*! \brief Enable or disable DC offset removal. */
+void dc_corr_cc::set_dc_enabled(bool enabled)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_dc_enabled = enabled;
+}
+
+/*! \brief Enable or disable I/Q imbalance correction.
+ *
+ * The estimate restarts from a balanced state when enabled.
+ */
+void dc_corr_cc::set_iq_enabled(bool enabled)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (enabled == d_iq_enabled)
+        return;
+
+    d_ii = d_qq = d_iq = 0.0;
+    d_corr_qi = 0.0f;
+    d_corr_qq = 1.0f;
+    d_iq_enabled = enabled;
+}
+
 
 /** I/Q swap **/
 iq_swap_cc_sptr make_iq_swap_cc(bool enabled)
@@ -4,6 +4,7 @@
  *           http://gqrx.dk/
  *
  * Copyright 2012-2013 Alexandru Csete OZ9AEC.
+ * Copyright 2026 Gqrx developers.
  *
  * Gqrx is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -27,13 +28,8 @@
 #include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/float_to_complex.h>
 #include <gnuradio/hier_block2.h>
-#include <gnuradio/filter/single_pole_iir_filter_cc.h>
-
-#if GNURADIO_VERSION < 0x030800
-#include <gnuradio/blocks/sub_cc.h>
-#else
-#include <gnuradio/blocks/sub.h>
-#endif
+#include <gnuradio/sync_block.h>
+#include <boost/thread/mutex.hpp>
 
 class dc_corr_cc;
 class iq_swap_cc;
@@ -47,13 +43,24 @@ typedef boost::shared_ptr<iq_swap_cc> iq_swap_cc_sptr;
  */
 dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau=1.0);
 
-/*! \brief Single pole IIR filter-based DC offset correction block.
+/*! \brief DC offset and I/Q imbalance correction block.
  *  \ingroup DSP
  *
- * This block performs automatic DC offset removal using a single pole IIR
- * filter
+ * This block performs automatic DC offset removal and blind I/Q imbalance
+ * correction in a single pass over the samples.
+ *
+ * The DC offset and the second order moments E[I^2], E[Q^2] and E[IQ] are
+ * estimated from every DC_CORR_STRIDE'th sample of each block and averaged
+ * with the time constant tau. The gain and phase errors follow from the
+ * moments:
+ *
+ *   g = sqrt(E[Q^2] / E[I^2])    sin(phi) = E[IQ] / sqrt(E[I^2] E[Q^2])
+ *
+ * and the correction is I' = I, Q' = (Q / g - I sin(phi)) / cos(phi). The
+ * correction matrix is only updated once per block so the per sample loop
+ * is a DC subtraction and a 2x2 multiply that the compiler vectorizes.
  */
-class dc_corr_cc : public gr::hier_block2
+class dc_corr_cc : public gr::sync_block
 {
     friend dc_corr_cc_sptr make_dc_corr_cc(double sample_rate, double tau);
 
@@ -62,16 +69,35 @@ protected:
 
 public:
     ~dc_corr_cc();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
     void set_sample_rate(double sample_rate);
     void set_tau(double tau);
+    void set_dc_enabled(bool enabled);
+    void set_iq_enabled(bool enabled);
 
 private:
-    gr::filter::single_pole_iir_filter_cc::sptr d_iir;
-    gr::blocks::sub_cc::sptr                    d_sub;
-
     double d_sr;     /*!< Sample rate. */
     double d_tau;    /*!< Time constant. */
-    double d_alpha;  /*!< 1/(1+tau/T). */
+
+    bool   d_dc_enabled;    /*!< Remove the DC offset. */
+    bool   d_iq_enabled;    /*!< Correct the I/Q imbalance. */
+
+    double d_dc_i;   /*!< DC offset estimate. */
+    double d_dc_q;
+    double d_ii;     /*!< Averaged E[I^2] without DC. */
+    double d_qq;     /*!< Averaged E[Q^2] without DC. */
+    double d_iq;     /*!< Averaged E[IQ] without DC. */
+
+    float  d_corr_qi;   /*!< Correction matrix, I' = I and */
+    float  d_corr_qq;   /*!< Q' = d_corr_qi * I + d_corr_qq * Q. */
+
+    boost::mutex d_mutex;  /*!< Protects the estimates from the setters. */
+
+    void update_estimate(const gr_complex *in, int n);
 };
 
 
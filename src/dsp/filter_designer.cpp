@@ -0,0 +1,231 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+#include <gnuradio/filter/firdes.h>
+#include "dsp/filter_designer.h"
+
+/* Maximum number of filters in the cache. */
+#define FILTER_CACHE_SIZE 64
+
+
+bool filter_key::operator<(const filter_key &other) const
+{
+    return std::tie(sample_rate, low, high, trans_width, offset) <
+           std::tie(other.sample_rate, other.low, other.high,
+                    other.trans_width, other.offset);
+}
+
+
+/*! \brief Get the filter designer instance. */
+filter_designer &filter_designer::instance()
+{
+    static filter_designer designer;
+
+    return designer;
+}
+
+filter_designer::filter_designer()
+    : d_busy(0),
+      d_running(true)
+{
+    d_thread = std::thread(&filter_designer::worker, this);
+}
+
+filter_designer::~filter_designer()
+{
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_running = false;
+    }
+    d_cond.notify_all();
+    d_thread.join();
+}
+
+/*! \brief Get filter taps.
+ *  \param key The filter parameters.
+ *  \returns The taps from the cache or new taps designed in the calling thread.
+ */
+filter_designer::taps_sptr filter_designer::get_taps(const filter_key &key)
+{
+    taps_sptr taps = find_taps(key);
+
+    if (taps)
+        return taps;
+
+    taps = std::make_shared<const std::vector<gr_complex> >(
+                gr::filter::firdes::complex_band_pass(1.0, key.sample_rate,
+                                                      key.low + key.offset,
+                                                      key.high + key.offset,
+                                                      key.trans_width));
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    std::cout << "Generating taps for new filter   LO:" << key.low
+              << "   HI:" << key.high << " TW:" << key.trans_width
+              << "   Taps: " << taps->size() << std::endl;
+#endif
+
+    std::lock_guard<std::mutex> lock(d_cache_mutex);
+
+    if (d_index.find(key) == d_index.end())
+    {
+        d_lru.push_front(std::make_pair(key, taps));
+        d_index[key] = d_lru.begin();
+
+        if (d_lru.size() > FILTER_CACHE_SIZE)
+        {
+            d_index.erase(d_lru.back().first);
+            d_lru.pop_back();
+        }
+    }
+
+    return taps;
+}
+
+/*! \brief Get filter taps from the cache.
+ *  \param key The filter parameters.
+ *  \returns The cached taps or an empty pointer.
+ */
+filter_designer::taps_sptr filter_designer::find_taps(const filter_key &key)
+{
+    std::lock_guard<std::mutex> lock(d_cache_mutex);
+    std::map<filter_key, lru_list::iterator>::iterator it = d_index.find(key);
+
+    if (it == d_index.end())
+        return taps_sptr();
+
+    // move to the front of the list, the iterator remains valid
+    d_lru.splice(d_lru.begin(), d_lru, it->second);
+
+    return it->second->second;
+}
+
+/*! \brief Design filter taps in the worker thread.
+ *  \param owner The object requesting the taps.
+ *  \param key The filter parameters.
+ *  \param done Callback receiving the taps.
+ *
+ * A pending request from the same owner is replaced.
+ */
+void filter_designer::request_taps(const void *owner, const filter_key &key,
+                                   callback_t done)
+{
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        request &req = d_pending[owner];
+
+        req.key = key;
+        req.done = done;
+    }
+    d_cond.notify_all();
+}
+
+/*! \brief Cancel pending request.
+ *  \param owner The object requesting the taps.
+ *
+ * If the callback of the owner is running, wait until it is done. After
+ * this the callback will not be called any more.
+ */
+void filter_designer::cancel(const void *owner)
+{
+    std::unique_lock<std::mutex> lock(d_mutex);
+
+    d_pending.erase(owner);
+    d_cond.wait(lock, [this, owner] { return d_busy != owner; });
+}
+
+/*! \brief Design filter taps into the cache in the worker thread.
+ *  \param key The filter parameters.
+ *
+ * Pending requests are served first. Nothing is done if the taps are
+ * already in the cache.
+ */
+void filter_designer::prefetch(const filter_key &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(d_cache_mutex);
+
+        if (d_index.find(key) != d_index.end())
+            return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+
+        d_prefetch.push_back(key);
+    }
+    d_cond.notify_all();
+}
+
+/*! \brief Worker thread designing the requested filters. */
+void filter_designer::worker()
+{
+    std::unique_lock<std::mutex> lock(d_mutex);
+
+    while (true)
+    {
+        d_cond.wait(lock, [this] {
+            return !d_pending.empty() || !d_prefetch.empty() || !d_running;
+        });
+        if (!d_running)
+            break;
+
+        if (d_pending.empty())
+        {
+            filter_key key = d_prefetch.front();
+
+            d_prefetch.pop_front();
+            lock.unlock();
+            try
+            {
+                get_taps(key);
+            }
+            catch (std::exception &x)
+            {
+                std::cout << "Error designing filter: " << x.what() << std::endl;
+            }
+            lock.lock();
+            continue;
+        }
+
+        std::map<const void *, request>::iterator it = d_pending.begin();
+        request req = it->second;
+
+        d_busy = it->first;
+        d_pending.erase(it);
+        lock.unlock();
+
+        try
+        {
+            req.done(get_taps(req.key));
+        }
+        catch (std::exception &x)
+        {
+            std::cout << "Error designing filter: " << x.what() << std::endl;
+        }
+
+        lock.lock();
+        d_busy = 0;
+        d_cond.notify_all();
+    }
+}
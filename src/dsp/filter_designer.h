@@ -0,0 +1,107 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FILTER_DESIGNER_H
+#define FILTER_DESIGNER_H
+
+#include <gnuradio/gr_complex.h>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*! \brief Parameters of a complex band pass filter. */
+struct filter_key
+{
+    double  sample_rate;
+    double  low;
+    double  high;
+    double  trans_width;
+    double  offset;         /*!< CW offset added to low and high. */
+
+    bool operator<(const filter_key &other) const;
+};
+
+
+/*! \brief Band pass filter design service.
+ *  \ingroup DSP
+ *
+ * Designs complex band pass filter taps and keeps the most recently used
+ * ones in a cache, so that returning to a previous filter setting (bookmarks,
+ * mode presets) needs no design at all.
+ *
+ * Filters that are not in the cache can be designed by a worker thread. Only
+ * the latest request of each owner is kept, so intermediate positions are
+ * skipped when the filter edges are dragged faster than the taps can be
+ * designed. The callback is called from the worker thread.
+ *
+ * Filters that are likely to be used soon can be prefetched; the worker
+ * designs them into the cache when there are no other requests.
+ */
+class filter_designer
+{
+public:
+    typedef std::shared_ptr<const std::vector<gr_complex> > taps_sptr;
+    typedef std::function<void (taps_sptr)> callback_t;
+
+    static filter_designer &instance();
+
+    taps_sptr get_taps(const filter_key &key);
+    taps_sptr find_taps(const filter_key &key);
+    void request_taps(const void *owner, const filter_key &key, callback_t done);
+    void cancel(const void *owner);
+    void prefetch(const filter_key &key);
+
+private:
+    filter_designer();
+    ~filter_designer();
+
+    /*! \brief A pending request. */
+    struct request
+    {
+        filter_key  key;
+        callback_t  done;
+    };
+
+    typedef std::list<std::pair<filter_key, taps_sptr> > lru_list;
+
+    void worker();
+
+    std::mutex      d_cache_mutex;  /*! Protects the cache. */
+    lru_list        d_lru;          /*! Cached taps, most recently used first. */
+    std::map<filter_key, lru_list::iterator> d_index; /*! Cache index. */
+
+    std::mutex              d_mutex;    /*! Protects the requests. */
+    std::condition_variable d_cond;     /*! Signals new requests and completion. */
+    std::map<const void *, request> d_pending;  /*! Latest request per owner. */
+    std::list<filter_key>   d_prefetch; /*! Filters to design into the cache. */
+    const void             *d_busy;     /*! Owner of the request being processed. */
+    bool                    d_running;
+    std::thread             d_thread;
+};
+
+#endif /* FILTER_DESIGNER_H */
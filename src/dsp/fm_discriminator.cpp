@@ -0,0 +1,264 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+#include "dsp/fm_discriminator.h"
+#include "dsp/rx_sql.h"
+
+
+fm_discriminator_cf_sptr make_fm_discriminator_cf(float quad_rate,
+                                                  float max_dev, double tau,
+                                                  bool precise)
+{
+    return gnuradio::get_initial_sptr(new fm_discriminator_cf(quad_rate,
+                                                              max_dev, tau,
+                                                              precise));
+}
+
+fm_discriminator_cf::fm_discriminator_cf(float quad_rate, float max_dev,
+                                         double tau, bool precise)
+    : gr::sync_block ("fm_discriminator_cf",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, sizeof(float))),
+      d_quad_rate(quad_rate),
+      d_gain(quad_rate / (2.0 * M_PI * max_dev)),
+      d_precise(precise),
+      d_x1(0.0f),
+      d_y1(0.0f),
+      d_sql_open(true)
+{
+    // previous sample for the first phase difference
+    set_history(2);
+    set_tau(tau);
+
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+}
+
+fm_discriminator_cf::~fm_discriminator_cf()
+{
+}
+
+int fm_discriminator_cf::work(int noutput_items,
+                              gr_vector_const_void_star &input_items,
+                              gr_vector_void_star &output_items)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    float            *out = (float *) output_items[0];
+    uint64_t          start = nitems_read(0);
+    int               i = 0;
+
+    // process up to each squelch tag, muted runs are skipped
+    get_tags_in_range(d_tags, 0, start, start + noutput_items);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+    for (size_t t = 0; t < d_tags.size(); t++)
+    {
+        int pos = (int)(d_tags[t].offset - start);
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = true;
+            d_x1 = 0.0f;
+            d_y1 = 0.0f;
+        }
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = false;
+        }
+    }
+    process_run(in + i, out + i, noutput_items - i);
+
+    return noutput_items;
+}
+
+/*! \brief Demodulate samples with the current squelch state.
+ *  \param in The input with one sample of history before the first one.
+ *  \param out The output buffer.
+ *  \param nitems The number of output samples.
+ *
+ * The input is zero while the squelch is closed, the output is cleared
+ * without demodulating.
+ */
+void fm_discriminator_cf::process_run(const gr_complex *in, float *out,
+                                      int nitems)
+{
+    float   b0 = d_b0;
+    float   p1 = d_p1;
+    float   x1 = d_x1;
+    float   y1 = d_y1;
+    int     i;
+
+    if (nitems <= 0)
+        return;
+
+    if (!d_sql_open)
+    {
+        std::fill(out, out + nitems, 0.0f);
+        return;
+    }
+
+    discriminate(out, in, nitems, d_gain, d_precise);
+
+    if (p1 != 0.0f)
+    {
+        for (i = 0; i < nitems; i++)
+        {
+            float x = out[i];
+
+            y1 = b0 * (x + x1) + p1 * y1;
+            x1 = x;
+            out[i] = y1;
+        }
+
+        // flush denormals during silence
+        if (fabsf(y1) < 1.0e-20f)
+            y1 = 0.0f;
+
+        d_x1 = x1;
+        d_y1 = y1;
+    }
+}
+
+/*! \brief Set maximum FM deviation.
+ *  \param max_dev The new mximum deviation in Hz
+ */
+void fm_discriminator_cf::set_max_dev(float max_dev)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_gain = d_quad_rate / (2.0 * M_PI * max_dev);
+}
+
+/*! \brief Set FM de-emphasis time constant.
+ *  \param tau The new time costant (0.0 disables).
+ *
+ * Single pole IIR filter from the bilinear transform with prewarping, as in
+ * fm_emph.py in gr-analog.
+ */
+void fm_discriminator_cf::set_tau(double tau)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (tau > 1.0e-9)
+    {
+        double fs = d_quad_rate;
+        double w_ca = 2.0 * fs * tan(1.0 / (tau * 2.0 * fs));
+        double k = -w_ca / (2.0 * fs);
+
+        d_b0 = -k / (1.0 - k);
+        d_p1 = (1.0 + k) / (1.0 - k);
+    }
+    else
+    {
+        d_b0 = 1.0f;
+        d_p1 = 0.0f;
+    }
+    d_x1 = 0.0f;
+    d_y1 = 0.0f;
+}
+
+/*! \brief Select the precise or the fast arctangent. */
+void fm_discriminator_cf::set_precise(bool precise)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_precise = precise;
+}
+
+/*! \brief Map atan(a) in [0, pi/4] to the octant of (x, y).
+ *
+ * Conditional selects on floats prevent vectorization unless trapping math
+ * is disabled, so the selects are written with copysignf(). Zero input
+ * gives zero output.
+ */
+static inline float octant(float r, float x, float y, float ax, float ay)
+{
+    const float pi_4 = M_PI_4;
+    const float pi_2 = M_PI_2;
+    float       d = ay - ax - 1.0e-30f;
+
+    // pi/2 - r if |y| > |x|
+    r = pi_4 + copysignf(pi_4, d) - copysignf(r, d);
+
+    // pi - r if x < 0
+    x += 1.0e-30f;
+    r = pi_2 - copysignf(pi_2, x) + copysignf(r, x);
+
+    return copysignf(r, y);
+}
+
+/*! \brief Calculate the phase difference between consecutive samples.
+ *  \param out The output buffer with room for n samples.
+ *  \param in The input buffer with n + 1 samples.
+ *  \param n The number of output samples.
+ *  \param gain Output per radian.
+ *  \param precise Use the 9th order arctangent instead of the 3rd order one.
+ *
+ * atan(a) is approximated for a = min(|x|,|y|) / max(|x|,|y|) in [0, 1] and
+ * the result is mapped to the right octant without branches.
+ */
+void fm_discriminator_cf::discriminate(float *out, const gr_complex *in,
+                                       int n, float gain, bool precise)
+{
+    const float *p = (const float *) in;
+    int          i;
+
+    if (precise)
+    {
+        for (i = 0; i < n; i++)
+        {
+            float x = p[2*i+2] * p[2*i] + p[2*i+3] * p[2*i+1];
+            float y = p[2*i+3] * p[2*i] - p[2*i+2] * p[2*i+1];
+            float ax = fabsf(x);
+            float ay = fabsf(y);
+            float a = std::min(ax, ay) / (std::max(ax, ay) + 1.0e-30f);
+            float s = a * a;
+            float r = a * (0.9998660f + s * (-0.3302995f + s * (0.1801410f +
+                      s * (-0.0851330f + s * 0.0208351f))));
+
+            out[i] = gain * octant(r, x, y, ax, ay);
+        }
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+        {
+            float x = p[2*i+2] * p[2*i] + p[2*i+3] * p[2*i+1];
+            float y = p[2*i+3] * p[2*i] - p[2*i+2] * p[2*i+1];
+            float ax = fabsf(x);
+            float ay = fabsf(y);
+            float a = std::min(ax, ay) / (std::max(ax, ay) + 1.0e-30f);
+            float r = a * (0.97239411f - 0.19194795f * a * a);
+
+            out[i] = gain * octant(r, x, y, ax, ay);
+        }
+    }
+}
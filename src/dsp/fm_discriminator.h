@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef FM_DISCRIMINATOR_H
+#define FM_DISCRIMINATOR_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/tags.h>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+
+class fm_discriminator_cf;
+
+typedef boost::shared_ptr<fm_discriminator_cf> fm_discriminator_cf_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of fm_discriminator_cf.
+ *  \param quad_rate The input sample rate.
+ *  \param max_dev Maximum deviation in Hz.
+ *  \param tau De-emphasis time constant in seconds (0.0 disables).
+ *  \param precise Use the precise arctangent instead of the fast one.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the fm_discriminator_cf constructor is private.
+ * make_fm_discriminator_cf is the public interface for creating new instances.
+ */
+fm_discriminator_cf_sptr make_fm_discriminator_cf(float quad_rate,
+                                                  float max_dev = 5000.0,
+                                                  double tau = 50.0e-6,
+                                                  bool precise = false);
+
+
+/*! \brief FM discriminator with de-emphasis.
+ *  \ingroup DSP
+ *
+ * The phase difference between consecutive samples is the argument of
+ * in[n] * conj(in[n-1]). It is calculated with a polynomial approximation
+ * of atan2 instead of atan2f:
+ *
+ *   - fast:    3rd order, max error 5.0e-3 rad
+ *   - precise: 9th order, max error 1.2e-5 rad
+ *
+ * The discriminator loop has no branches so the compiler can vectorize it.
+ * The single pole de-emphasis filter runs in single precision on the same
+ * block of samples while it is still in the cache.
+ *
+ * While the squelch tags from rx_sql_cc mark the input as muted the output
+ * is zero without demodulating. The de-emphasis is reset when the squelch
+ * opens.
+ */
+class fm_discriminator_cf : public gr::sync_block
+{
+    friend fm_discriminator_cf_sptr make_fm_discriminator_cf(float quad_rate,
+                                                             float max_dev,
+                                                             double tau,
+                                                             bool precise);
+
+protected:
+    fm_discriminator_cf(float quad_rate, float max_dev, double tau, bool precise);
+
+public:
+    ~fm_discriminator_cf();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void set_max_dev(float max_dev);
+    void set_tau(double tau);
+    void set_precise(bool precise);
+
+    static void discriminate(float *out, const gr_complex *in, int n,
+                             float gain, bool precise);
+
+private:
+    void process_run(const gr_complex *in, float *out, int nitems);
+
+    boost::mutex d_mutex;   /*! Protects the parameters while processing. */
+    float   d_quad_rate;    /*! Input sample rate. */
+    float   d_gain;         /*! Output per radian. */
+    bool    d_precise;      /*! Use the precise arctangent. */
+
+    /* de-emphasis: y[n] = b0 * (x[n] + x[n-1]) + p1 * y[n-1] */
+    float   d_b0;
+    float   d_p1;
+    float   d_x1;
+    float   d_y1;
+
+    bool                    d_sql_open;  /*! Squelch state from the input tags. */
+    std::vector<gr::tag_t>  d_tags;
+    pmt::pmt_t              d_sob_key;
+    pmt::pmt_t              d_eob_key;
+};
+
+#endif /* FM_DISCRIMINATOR_H */
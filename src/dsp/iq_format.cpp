@@ -0,0 +1,306 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <string.h>
+#include <gnuradio/io_signature.h>
+#include "dsp/iq_format.h"
+
+
+int iq_format_size(iq_format fmt)
+{
+    switch (fmt)
+    {
+    case IQ_FMT_CS16:
+    case IQ_FMT_CF16:
+        return 4;
+    case IQ_FMT_CS8:
+        return 2;
+    default:
+        return sizeof(gr_complex);
+    }
+}
+
+const char *iq_format_name(iq_format fmt)
+{
+    switch (fmt)
+    {
+    case IQ_FMT_CS16:
+        return "cs16";
+    case IQ_FMT_CS8:
+        return "cs8";
+    case IQ_FMT_CF16:
+        return "cf16";
+    default:
+        return "fc";
+    }
+}
+
+iq_format iq_format_from_name(const std::string &name)
+{
+    if (name == "cs16")
+        return IQ_FMT_CS16;
+    if (name == "cs8")
+        return IQ_FMT_CS8;
+    if (name == "cf16")
+        return IQ_FMT_CF16;
+
+    return IQ_FMT_FC32;
+}
+
+
+/*
+ * The conversion loops below are written without branches so that the
+ * compiler can vectorize them. Float and integer bit patterns are swapped
+ * through a union, which GCC and Clang allow.
+ */
+union iq_bits {
+    float       f;
+    uint32_t    u;
+};
+
+/* Largest finite half precision value, 65504, as a float bit pattern. */
+#define HALF_MAX_BITS   0x477fe000u
+
+/* Smallest normal half precision value, 2^-14, as a float bit pattern. */
+#define HALF_MIN_BITS   0x38800000u
+
+
+iq_encoder_c_sptr make_iq_encoder_c(iq_format fmt)
+{
+    return gnuradio::get_initial_sptr(new iq_encoder_c(fmt));
+}
+
+iq_encoder_c::iq_encoder_c(iq_format fmt)
+    : gr::sync_block ("iq_encoder_c",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, iq_format_size(fmt))),
+      d_fmt(fmt),
+      d_samples(0),
+      d_clipped(0)
+{
+}
+
+iq_encoder_c::~iq_encoder_c()
+{
+}
+
+int iq_encoder_c::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    const float    *in = (const float *) input_items[0];
+    unsigned int    clipped = 0;
+
+    switch (d_fmt)
+    {
+    case IQ_FMT_CS16:
+        clipped = encode_cs16((int16_t *) output_items[0], in, 2 * noutput_items);
+        break;
+    case IQ_FMT_CS8:
+        clipped = encode_cs8((int8_t *) output_items[0], in, 2 * noutput_items);
+        break;
+    case IQ_FMT_CF16:
+        clipped = encode_cf16((uint16_t *) output_items[0], in, 2 * noutput_items);
+        break;
+    default:
+        memcpy(output_items[0], in, noutput_items * sizeof(gr_complex));
+        break;
+    }
+
+    d_samples += noutput_items;
+    d_clipped += clipped;
+
+    return noutput_items;
+}
+
+/*! \brief Convert floats to 16 bit integers.
+ *  \param out The output buffer.
+ *  \param in The input buffer.
+ *  \param n The number of values (twice the number of complex samples).
+ *  \returns The number of values outside [-1.0, 1.0].
+ *
+ * NaN is saturated to full scale.
+ */
+unsigned int iq_encoder_c::encode_cs16(int16_t *out, const float *in, int n)
+{
+    unsigned int clipped = 0;
+    int          i;
+
+    for (i = 0; i < n; i++)
+    {
+        float   v = in[i] * 32767.0f;
+
+        // clamp before the conversion, which is undefined out of range
+        clipped += !(fabsf(v) <= 32767.0f);
+        v = v < 32767.0f ? v : 32767.0f;
+        v = v > -32767.0f ? v : -32767.0f;
+        out[i] = (int16_t)(v + copysignf(0.5f, v));
+    }
+
+    return clipped;
+}
+
+/*! \brief Convert floats to 8 bit integers.
+ *  \returns The number of values outside [-1.0, 1.0].
+ */
+unsigned int iq_encoder_c::encode_cs8(int8_t *out, const float *in, int n)
+{
+    unsigned int clipped = 0;
+    int          i;
+
+    for (i = 0; i < n; i++)
+    {
+        float   v = in[i] * 127.0f;
+
+        // clamp before the conversion, which is undefined out of range
+        clipped += !(fabsf(v) <= 127.0f);
+        v = v < 127.0f ? v : 127.0f;
+        v = v > -127.0f ? v : -127.0f;
+        out[i] = (int8_t)(v + copysignf(0.5f, v));
+    }
+
+    return clipped;
+}
+
+/*! \brief Convert floats to half precision.
+ *  \returns The number of values saturated to +/-65504.
+ *
+ * Rounds to nearest even. Values below the normal range are converted by
+ * adding 0.5, which puts the half precision denormal in the low bits of the
+ * float mantissa. NaN is saturated as well.
+ */
+unsigned int iq_encoder_c::encode_cf16(uint16_t *out, const float *in, int n)
+{
+    unsigned int clipped = 0;
+    int          i;
+
+    for (i = 0; i < n; i++)
+    {
+        iq_bits  x, d;
+        uint32_t sign, norm, sub, mask;
+
+        x.f = in[i];
+        sign = (x.u >> 16) & 0x8000u;
+        x.u &= 0x7fffffffu;
+
+        mask = -(uint32_t)(x.u > HALF_MAX_BITS);
+        clipped += mask & 1u;
+        x.u = (HALF_MAX_BITS & mask) | (x.u & ~mask);
+
+        // rebias exponent from 127 to 15 and round the mantissa
+        norm = (x.u - 0x38000000u + 0xfffu + ((x.u >> 13) & 1u)) >> 13;
+
+        d.f = x.f + 0.5f;
+        sub = d.u - 0x3f000000u;
+
+        mask = -(uint32_t)(x.u < HALF_MIN_BITS);
+        out[i] = (uint16_t)((sub & mask) | (norm & ~mask) | sign);
+    }
+
+    return clipped;
+}
+
+
+iq_decoder_c_sptr make_iq_decoder_c(iq_format fmt)
+{
+    return gnuradio::get_initial_sptr(new iq_decoder_c(fmt));
+}
+
+iq_decoder_c::iq_decoder_c(iq_format fmt)
+    : gr::sync_interpolator ("iq_decoder_c",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          sizeof(gr_complex) / iq_format_size(fmt)),
+      d_fmt(fmt)
+{
+}
+
+iq_decoder_c::~iq_decoder_c()
+{
+}
+
+int iq_decoder_c::work(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+{
+    float *out = (float *) output_items[0];
+
+    switch (d_fmt)
+    {
+    case IQ_FMT_CS16:
+        decode_cs16(out, (const int16_t *) input_items[0], 2 * noutput_items);
+        break;
+    case IQ_FMT_CS8:
+        decode_cs8(out, (const int8_t *) input_items[0], 2 * noutput_items);
+        break;
+    case IQ_FMT_CF16:
+        decode_cf16(out, (const uint16_t *) input_items[0], 2 * noutput_items);
+        break;
+    default:
+        memcpy(out, input_items[0], noutput_items * sizeof(gr_complex));
+        break;
+    }
+
+    return noutput_items;
+}
+
+void iq_decoder_c::decode_cs16(float *out, const int16_t *in, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        out[i] = (float) in[i] * (1.0f / 32767.0f);
+}
+
+void iq_decoder_c::decode_cs8(float *out, const int8_t *in, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        out[i] = (float) in[i] * (1.0f / 127.0f);
+}
+
+/*! \brief Convert half precision to floats.
+ *
+ * Denormals are converted through an integer to float conversion, infinity
+ * and NaN get the maximum float exponent.
+ */
+void iq_decoder_c::decode_cf16(float *out, const uint16_t *in, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        iq_bits  x, d;
+        uint32_t em = in[i] & 0x7fffu;
+        uint32_t norm = (em << 13) + 0x38000000u;
+        uint32_t mask;
+
+        norm += 0x38000000u & -(uint32_t)(em >= 0x7c00u);
+        d.f = (float) em * 5.9604645e-8f;     // 2^-24
+        mask = -(uint32_t)(em < 0x400u);
+        x.u = (d.u & mask) | (norm & ~mask);
+        x.u |= (uint32_t)(in[i] & 0x8000u) << 16;
+        out[i] = x.f;
+    }
+}
@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_FORMAT_H
+#define IQ_FORMAT_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/sync_interpolator.h>
+#include <gnuradio/gr_complex.h>
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+
+/*! \brief Sample formats used for I/Q recordings.
+ *
+ * All formats are interleaved I/Q in host byte order. The integer formats
+ * use the full scale of the type for an input of 1.0.
+ */
+enum iq_format {
+    IQ_FMT_FC32 = 0,    /*!< 32 bit float, same as gr_complex. */
+    IQ_FMT_CS16 = 1,    /*!< 16 bit signed integer. */
+    IQ_FMT_CS8  = 2,    /*!< 8 bit signed integer. */
+    IQ_FMT_CF16 = 3     /*!< 16 bit IEEE 754 half precision float. */
+};
+
+/*! \brief Number of bytes per complex sample. */
+int iq_format_size(iq_format fmt);
+
+/*! \brief Short name of the format as used in file names (fc, cs16, ...). */
+const char *iq_format_name(iq_format fmt);
+
+/*! \brief Get the format from its short name. Unknown names give FC32. */
+iq_format iq_format_from_name(const std::string &name);
+
+
+class iq_encoder_c;
+class iq_decoder_c;
+
+typedef boost::shared_ptr<iq_encoder_c> iq_encoder_c_sptr;
+typedef boost::shared_ptr<iq_decoder_c> iq_decoder_c_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of iq_encoder_c.
+ *  \param fmt The output format.
+ */
+iq_encoder_c_sptr make_iq_encoder_c(iq_format fmt);
+
+/*! \brief Convert gr_complex samples to a compact recording format.
+ *  \ingroup DSP
+ *
+ * The output items are complex samples in the selected format. Integer
+ * samples that do not fit are saturated and counted so that the user can
+ * reduce the gain when the recording clips.
+ */
+class iq_encoder_c : public gr::sync_block
+{
+    friend iq_encoder_c_sptr make_iq_encoder_c(iq_format fmt);
+
+protected:
+    iq_encoder_c(iq_format fmt);
+
+public:
+    ~iq_encoder_c();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    uint64_t get_samples() const { return d_samples; }
+    uint64_t get_clipped() const { return d_clipped; }
+
+    static unsigned int encode_cs16(int16_t *out, const float *in, int n);
+    static unsigned int encode_cs8(int8_t *out, const float *in, int n);
+    static unsigned int encode_cf16(uint16_t *out, const float *in, int n);
+
+private:
+    iq_format               d_fmt;      /*! Output format. */
+    std::atomic<uint64_t>   d_samples;  /*! Number of samples converted. */
+    std::atomic<uint64_t>   d_clipped;  /*! Number of clipped values. */
+};
+
+
+/*! \brief Return a shared_ptr to a new instance of iq_decoder_c.
+ *  \param fmt The input format.
+ */
+iq_decoder_c_sptr make_iq_decoder_c(iq_format fmt);
+
+/*! \brief Convert a compact recording format back to gr_complex.
+ *  \ingroup DSP
+ *
+ * The file source used for playback only knows about gr_complex, so each
+ * input item carries the raw bytes of 8 / iq_format_size() samples. The
+ * block reinterprets these bytes and outputs one gr_complex per sample.
+ */
+class iq_decoder_c : public gr::sync_interpolator
+{
+    friend iq_decoder_c_sptr make_iq_decoder_c(iq_format fmt);
+
+protected:
+    iq_decoder_c(iq_format fmt);
+
+public:
+    ~iq_decoder_c();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    static void decode_cs16(float *out, const int16_t *in, int n);
+    static void decode_cs8(float *out, const int8_t *in, int n);
+    static void decode_cf16(float *out, const uint16_t *in, int n);
+
+private:
+    iq_format   d_fmt;  /*! Input format. */
+};
+
+#endif /* IQ_FORMAT_H */
@@ -28,6 +28,11 @@ class RDS_API decoder : virtual public gr::sync_block
 public:
 	typedef boost::shared_ptr<decoder> sptr;
 	static sptr make(bool log, bool debug);
+
+	/* number of blocks received in sync: good, corrected and failed */
+	virtual void get_stats(unsigned long &good, unsigned long &corrected,
+			unsigned long &failed) = 0;
+	virtual void reset_stats() = 0;
 };
 
 } // namespace rds
@@ -34,7 +34,10 @@ decoder_impl::decoder_impl(bool log, bool debug)
 			gr::io_signature::make (1, 1, sizeof(char)),
 			gr::io_signature::make (0, 0, 0)),
 	log(log),
-	debug(debug)
+	debug(debug),
+	good_blocks_total(0),
+	corrected_blocks_total(0),
+	failed_blocks_total(0)
 {
 	set_output_multiple(104);  // 1 RDS datagroup = 104 bits
 	message_port_register_out(pmt::mp("out"));
@@ -58,11 +61,25 @@ void decoder_impl::enter_sync(unsigned int sync_block_number) {
 	block_bit_counter      = 0;
 	block_number           = (sync_block_number + 1) % 4;
 	group_assembly_started = false;
+	group_corrected_blocks_counter = 0;
 	d_state                = SYNC;
 }
 
+void decoder_impl::get_stats(unsigned long &good, unsigned long &corrected,
+		unsigned long &failed) {
+	good = good_blocks_total;
+	corrected = corrected_blocks_total;
+	failed = failed_blocks_total;
+}
+
+void decoder_impl::reset_stats() {
+	good_blocks_total = 0;
+	corrected_blocks_total = 0;
+	failed_blocks_total = 0;
+}
+
 /* see Annex B, page 64 of the standard */
-unsigned int decoder_impl::calc_syndrome(unsigned long message,
+static unsigned int calc_syndrome(unsigned long message,
 		unsigned char mlen) {
 	unsigned long reg = 0;
 	unsigned int i;
@@ -80,6 +97,72 @@ unsigned int decoder_impl::calc_syndrome(unsigned long message,
 	return (reg & ((1<<plen)-1));	// select the bottom plen bits of reg
 }
 
+/* maximum length of the error bursts that are corrected. The code can
+ * correct bursts of up to 5 bits, but then about a third of all random
+ * syndromes would be "corrected". With 2 bits it is 51 of 1023. */
+#define MAX_BURST_LEN 2
+
+/* The syndrome is linear, so it is calculated byte by byte from tables made
+ * with calc_syndrome(). The burst table maps the syndrome of every error
+ * burst of up to MAX_BURST_LEN bits to the burst. */
+struct syndrome_tables {
+	unsigned int  byte[4][256];
+	unsigned long burst[1024];
+
+	syndrome_tables() {
+		unsigned int k, i, len, pos, mid;
+
+		for (k = 0; k < 4; k++)
+			for (i = 0; i < 256; i++)
+				byte[k][i] = calc_syndrome((unsigned long)i << (8 * k), 26);
+
+		for (i = 0; i < 1024; i++)
+			burst[i] = 0;
+		for (len = 1; len <= MAX_BURST_LEN; len++) {
+			// bursts of length len start and end with a 1
+			for (mid = 0; mid < (len > 2 ? 1u << (len - 2) : 1u); mid++) {
+				unsigned long e = (len == 1) ? 1 : (1ul << (len - 1)) | (mid << 1) | 1;
+
+				for (pos = 0; pos + len <= 26; pos++) {
+					unsigned int s = calc_syndrome(e << pos, 26);
+					if (!burst[s]) burst[s] = e << pos;
+				}
+			}
+		}
+	}
+};
+
+static const syndrome_tables &tables() {
+	static const syndrome_tables t;
+	return t;
+}
+
+/* syndrome of the 26 bit block in the lower bits of message */
+unsigned int decoder_impl::syndrome26(unsigned long message) {
+	const syndrome_tables &t = tables();
+
+	return t.byte[0][message & 0xff] ^
+		t.byte[1][(message >> 8) & 0xff] ^
+		t.byte[2][(message >> 16) & 0xff] ^
+		t.byte[3][(message >> 24) & 0x03];
+}
+
+/* Check a block against an offset word and correct burst errors.
+ * Returns 0 if the block is bad, 1 if it is good and 2 if it was
+ * corrected. */
+int decoder_impl::check_block(unsigned long &block, unsigned int offset,
+		bool correct) {
+	unsigned int s = syndrome26(block) ^ syndrome[offset];
+
+	if (s == 0)
+		return 1;
+	if (correct && tables().burst[s]) {
+		block ^= tables().burst[s];
+		return 2;
+	}
+	return 0;
+}
+
 void decoder_impl::decode_group(unsigned int *group) {
 	// raw data bytes, as received from RDS.
 	// 8 info bytes, followed by 4 RDS offset chars: ABCD/ABcD/EEEE (in US)
@@ -121,8 +204,11 @@ int decoder_impl::work (int noutput_items,
 
 	int i=0,j;
 	unsigned long bit_distance, block_distance;
-	unsigned int block_calculated_crc, block_received_crc, checkword,dataword;
+	unsigned long block;
+	unsigned int dataword;
 	unsigned int reg_syndrome;
+	int result;
+	bool correct;
 	unsigned char offset_char('x');  // x = error while decoding the word offset
 
 /* the synchronization process is described in Annex C, page 66 of the standard */
@@ -130,7 +216,7 @@ int decoder_impl::work (int noutput_items,
 		reg=(reg<<1)|in[i];		// reg contains the last 26 rds bits
 		switch (d_state) {
 			case NO_SYNC:
-				reg_syndrome = calc_syndrome(reg,26);
+				reg_syndrome = syndrome26(reg);
 				for (j=0;j<5;j++) {
 					if (reg_syndrome==syndrome[j]) {
 						if (!presync) {
@@ -159,42 +245,43 @@ int decoder_impl::work (int noutput_items,
 				if (block_bit_counter<25) block_bit_counter++;
 				else {
 					good_block=false;
-					dataword=(reg>>10) & 0xffff;
-					block_calculated_crc=calc_syndrome(dataword,16);
-					checkword=reg & 0x3ff;
-/* manage special case of C or C' offset word */
+					block=reg & 0x3ffffff;
+/* correct at most one block per group, so that a miscorrected block is
+   not decoded along with other doubtful blocks */
+					correct = (block_number==0) ||
+						(group_assembly_started && group_corrected_blocks_counter==0);
+/* manage special case of C or C' offset word. Exact matches for both, but
+   correction only for the one given by the group version in block B */
 					if (block_number==2) {
-						block_received_crc=checkword^offset_word[block_number];
-						if (block_received_crc==block_calculated_crc) {
-							good_block=true;
-							offset_char = 'C';
-						} else {
-							block_received_crc=checkword^offset_word[4];
-							if (block_received_crc==block_calculated_crc) {
-								good_block=true;
-								offset_char = 'c';  // C' (C-Tag)
-							} else {
-								wrong_blocks_counter++;
-								good_block=false;
-							}
+						offset_char = 'C';
+						result = check_block(block, 2, false);
+						if (!result) {
+							offset_char = 'c';  // C' (C-Tag)
+							result = check_block(block, 4, false);
+						}
+						if (!result && correct) {
+							bool version_b = (group[1] >> 11) & 0x01;
+							offset_char = version_b ? 'c' : 'C';
+							result = check_block(block, version_b ? 4 : 2, true);
 						}
 					}
 					else {
-						block_received_crc=checkword^offset_word[block_number];
-						if (block_received_crc==block_calculated_crc) {
-							good_block=true;
-							if (block_number==0) offset_char = 'A';
-							else if (block_number==1) offset_char = 'B';
-							else if (block_number==3) offset_char = 'D';
-						} else {
-							wrong_blocks_counter++;
-							good_block=false;
-						}
+						offset_char = "AB?D"[block_number];
+						result = check_block(block, block_number, correct);
 					}
+					dataword=(block>>10) & 0xffff;
+					good_block=(result!=0);
+/* corrected blocks count as wrong for the sync check, random data can
+   often be "corrected" */
+					if (result!=1) wrong_blocks_counter++;
+					if (result==1) good_blocks_total++;
+					else if (result==2) corrected_blocks_total++;
+					else failed_blocks_total++;
 /* done checking CRC */
 					if (block_number==0 && good_block) {
 						group_assembly_started=true;
 						group_good_blocks_counter=1;
+						group_corrected_blocks_counter=0;
 					}
 					if (group_assembly_started) {
 						if (!good_block) group_assembly_started=false;
@@ -202,6 +289,7 @@ int decoder_impl::work (int noutput_items,
 							group[block_number]=dataword;
 							offset_chars[block_number] = offset_char;
 							group_good_blocks_counter++;
+							if (result==2) group_corrected_blocks_counter++;
 						}
 						if (group_good_blocks_counter==5) decode_group(group);
 					}
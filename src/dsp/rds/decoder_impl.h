@@ -18,6 +18,7 @@
 #define INCLUDED_RDS_DECODER_IMPL_H
 
 #include "dsp/rds/decoder.h"
+#include <atomic>
 
 namespace gr {
 namespace rds {
@@ -27,6 +28,10 @@ class decoder_impl : public decoder
 public:
 	decoder_impl(bool log, bool debug);
 
+	void get_stats(unsigned long &good, unsigned long &corrected,
+			unsigned long &failed);
+	void reset_stats();
+
 private:
 	~decoder_impl();
 
@@ -36,7 +41,8 @@ private:
 
 	void enter_no_sync();
 	void enter_sync(unsigned int);
-	unsigned int calc_syndrome(unsigned long, unsigned char);
+	static unsigned int syndrome26(unsigned long);
+	int check_block(unsigned long &block, unsigned int offset, bool correct);
 	void decode_group(unsigned int*);
 
 	unsigned long  bit_counter;
@@ -45,6 +51,7 @@ private:
 	unsigned int   wrong_blocks_counter;
 	unsigned int   blocks_counter;
 	unsigned int   group_good_blocks_counter;
+	unsigned int   group_corrected_blocks_counter;
 	unsigned int   group[4];
 	unsigned char  offset_chars[4];  // [ABCcDEx] (x=error)
 	bool           log;
@@ -54,6 +61,9 @@ private:
 	bool           group_assembly_started;
 	unsigned char  lastseen_offset;
 	unsigned char  block_number;
+	std::atomic<unsigned long> good_blocks_total;
+	std::atomic<unsigned long> corrected_blocks_total;
+	std::atomic<unsigned long> failed_blocks_total;
 	enum { NO_SYNC, SYNC } d_state;
 
 };
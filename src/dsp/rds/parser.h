@@ -19,10 +19,75 @@
 
 #include "dsp/rds/api.h"
 #include <gnuradio/block.h>
+#include <functional>
 
 namespace gr {
 namespace rds {
 
+/* fields of station_state, also used as bits in change masks */
+enum station_field {
+	RDS_PI    = 0,
+	RDS_PS    = 1,
+	RDS_PTY   = 2,
+	RDS_FLAGS = 3,  // TP, TA, MuSp, MoSt, AH, CMP, stPTY
+	RDS_RT    = 4,
+	RDS_CT    = 5,
+	RDS_AF    = 6,
+	RDS_TMC   = 7,
+	RDS_NUM_FIELDS
+};
+
+#define RDS_MAX_AF   25
+#define RDS_MAX_TMC  16
+
+struct tmc_event {
+	unsigned int   event;       // event code (ISO 14819-2)
+	unsigned int   location;    // location code (ISO 14819-3)
+	unsigned char  extent;      // number of segments affected
+	unsigned char  duration;    // duration and persistence
+	bool           direction;   // true = negative direction
+	bool           diversion;   // diversion recommended
+};
+
+/* Decoded state of the current station. Every change increments version
+ * and the field is tagged with it, so readers can find what changed since
+ * their last snapshot. The state is cleared when the PI changes. */
+struct station_state {
+	unsigned long  version;
+	unsigned long  field_version[RDS_NUM_FIELDS];
+
+	unsigned int   pi;
+	unsigned char  pty;
+	char           pty_name[24];    // in the locale of the parser
+	char           ps[9];
+	char           rt[65];
+	bool           tp;
+	bool           ta;
+	bool           music_speech;
+	bool           mono_stereo;
+	bool           artificial_head;
+	bool           compressed;
+	bool           static_pty;
+
+	double         af[RDS_MAX_AF];  // kHz
+	unsigned int   num_af;
+
+	unsigned int   ct_year, ct_month, ct_day, ct_hour, ct_minute;
+	double         ct_offset;       // local time offset in hours
+
+	tmc_event      tmc[RDS_MAX_TMC];
+	unsigned long  num_tmc;         // events received, tmc[] is a ring
+
+	/* bit mask of fields changed after version */
+	unsigned int changed_since(unsigned long since) const {
+		unsigned int mask = 0;
+		for (int i = 0; i < RDS_NUM_FIELDS; i++)
+			if (field_version[i] > since)
+				mask |= 1u << i;
+		return mask;
+	}
+};
+
 class RDS_API parser : virtual public gr::block
 {
 public:
@@ -30,6 +95,13 @@ public:
 	static sptr make(bool log, bool debug, unsigned char pty_locale);
 
 	virtual void reset() = 0;
+
+	/* copy the station state */
+	virtual void get_state(station_state &state) = 0;
+
+	/* called from the message thread with the changed fields */
+	typedef std::function<void (const station_state &state, unsigned int changed)> notify_fn;
+	virtual void set_notify(notify_fn notify) = 0;
 };
 
 } // namespace rds
@@ -41,7 +41,7 @@ parser_impl::parser_impl(bool log, bool debug, unsigned char pty_locale)
 {
 	message_port_register_in(pmt::mp("in"));
 	set_msg_handler(pmt::mp("in"), boost::bind(&parser_impl::parse, this, _1));
-	message_port_register_out(pmt::mp("out"));
+	memset(&d_station, 0, sizeof(d_station));
 	reset();
 }
 
@@ -51,6 +51,13 @@ parser_impl::~parser_impl() {
 void parser_impl::reset() {
 	gr::thread::scoped_lock lock(d_mutex);
 
+	clear();
+}
+
+/* clear the station state, must be called with d_mutex locked */
+void parser_impl::clear() {
+	unsigned long version = d_station.version;
+
 	memset(radiotext, ' ', sizeof(radiotext));
 	memset(program_service_name, '.', sizeof(program_service_name));
 
@@ -59,6 +66,7 @@ void parser_impl::reset() {
 	traffic_announcement           = false;
 	music_speech                   = false;
 	program_type                   = 0;
+	pending_pi                     = 0;
 	pi_country_identification      = 0;
 	pi_area_coverage               = 0;
 	pi_program_reference_number    = 0;
@@ -66,19 +74,41 @@ void parser_impl::reset() {
 	artificial_head                = false;
 	compressed                     = false;
 	static_pty                     = false;
+
+	memset(&d_station, 0, sizeof(d_station));
+	d_station.version = version;
+	memcpy(d_station.ps, program_service_name, 8);
+	memcpy(d_station.rt, radiotext, 64);
+	for (int i = 0; i < RDS_NUM_FIELDS; i++)
+		touch((station_field)i);
+}
+
+void parser_impl::get_state(station_state &state) {
+	gr::thread::scoped_lock lock(d_mutex);
+
+	state = d_station;
+}
+
+void parser_impl::set_notify(notify_fn notify) {
+	gr::thread::scoped_lock lock(d_mutex);
+
+	d_notify = notify;
+}
+
+/* mark a field of the station state as changed */
+void parser_impl::touch(station_field field) {
+	d_station.field_version[field] = ++d_station.version;
 }
 
-/* type 0 = PI
- * type 1 = PS
- * type 2 = PTY
- * type 3 = flagstring: TP, TA, MuSp, MoSt, AH, CMP, stPTY
- * type 4 = RadioText
- * type 5 = ClockTime
- * type 6 = Alternative Frequencies */
-void parser_impl::send_message(long msgtype, std::string msgtext) {
-	pmt::pmt_t msg  = pmt::mp(msgtext);
-	pmt::pmt_t type = pmt::from_long(msgtype);
-	message_port_pub(pmt::mp("out"), pmt::make_tuple(type, msg));
+/* add an alternative frequency to the list if it is new */
+void parser_impl::add_af(double af) {
+	if (af == 0 || d_station.num_af >= RDS_MAX_AF)
+		return;
+	for (unsigned int i = 0; i < d_station.num_af; i++)
+		if (d_station.af[i] == af)
+			return;
+	d_station.af[d_station.num_af++] = af;
+	touch(RDS_AF);
 }
 
 /* BASIC TUNING: see page 21 of the standard */
@@ -88,7 +118,6 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 	unsigned int  no_af    = 0;
 	double af_1            = 0;
 	double af_2            = 0;
-	char flagstring[8]     = "0000000";
 
 	traffic_program        = (group[1] >> 10) & 0x01;       // "TP"
 	traffic_announcement   = (group[1] >>  4) & 0x01;       // "TA"
@@ -117,13 +146,6 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 		default:
 		break;
 	}
-	flagstring[0] = traffic_program        ? '1' : '0';
-	flagstring[1] = traffic_announcement   ? '1' : '0';
-	flagstring[2] = music_speech           ? '1' : '0';
-	flagstring[3] = mono_stereo            ? '1' : '0';
-	flagstring[4] = artificial_head        ? '1' : '0';
-	flagstring[5] = compressed             ? '1' : '0';
-	flagstring[6] = static_pty             ? '1' : '0';
 	static std::string af_string;
 
 	if(!B) { // type 0A
@@ -131,6 +153,8 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 		af_code_2 = int(group[2])      & 0xff;
 		af_1 = decode_af(af_code_1);
 		af_2 = decode_af(af_code_2);
+		add_af(af_1);
+		add_af(af_2);
 
 		if(af_1) {
 			no_af += 1;
@@ -170,9 +194,26 @@ void parser_impl::decode_type0(unsigned int *group, bool B) {
 		<< '-' << (mono_stereo ? "MONO" : "STEREO")
 		<< " - AF:" << af_string << std::endl;
 
-	send_message(1, std::string(program_service_name, 8));
-	send_message(3, flagstring);
-	send_message(6, af_string);
+	if (memcmp(d_station.ps, program_service_name, 8)) {
+		memcpy(d_station.ps, program_service_name, 8);
+		touch(RDS_PS);
+	}
+	if (d_station.tp != traffic_program ||
+	    d_station.ta != traffic_announcement ||
+	    d_station.music_speech != music_speech ||
+	    d_station.mono_stereo != mono_stereo ||
+	    d_station.artificial_head != artificial_head ||
+	    d_station.compressed != compressed ||
+	    d_station.static_pty != static_pty) {
+		d_station.tp = traffic_program;
+		d_station.ta = traffic_announcement;
+		d_station.music_speech = music_speech;
+		d_station.mono_stereo = mono_stereo;
+		d_station.artificial_head = artificial_head;
+		d_station.compressed = compressed;
+		d_station.static_pty = static_pty;
+		touch(RDS_FLAGS);
+	}
 }
 
 double parser_impl::decode_af(unsigned int af_code) {
@@ -286,7 +327,10 @@ void parser_impl::decode_type2(unsigned int *group, bool B){
 	lout << "Radio Text " << (radiotext_AB_flag ? 'B' : 'A')
 		<< ": " << std::string(radiotext, sizeof(radiotext))
 		<< std::endl;
-	send_message(4,std::string(radiotext, sizeof(radiotext)));
+	if (memcmp(d_station.rt, radiotext, 64)) {
+		memcpy(d_station.rt, radiotext, 64);
+		touch(RDS_RT);
+	}
 }
 
 void parser_impl::decode_type3(unsigned int *group, bool B){
@@ -358,7 +402,13 @@ void parser_impl::decode_type4(unsigned int *group, bool B){
 		% day % month % (1900 + year) % hours % minutes % local_time_offset);
 	lout << "Clocktime: " << time << std::endl;
 
-	send_message(5,time);
+	d_station.ct_year = 1900 + year;
+	d_station.ct_month = month;
+	d_station.ct_day = day;
+	d_station.ct_hour = hours;
+	d_station.ct_minute = minutes;
+	d_station.ct_offset = local_time_offset;
+	touch(RDS_CT);
 }
 
 void parser_impl::decode_type5(unsigned int *group, bool B){
@@ -417,6 +467,15 @@ void parser_impl::decode_type8(unsigned int *group, bool B){
 			<< ", event" << event << ":" << tmc_events[event_line][1]
 			<< ", location:" << location << std::endl;
 
+		tmc_event &ev = d_station.tmc[d_station.num_tmc++ % RDS_MAX_TMC];
+		ev.event = event;
+		ev.location = location;
+		ev.extent = extent + 1;
+		ev.duration = dp_ci;
+		ev.direction = sign;
+		ev.diversion = D;
+		touch(RDS_TMC);
+
 	} else { // 2nd or more of multi-group
 		unsigned int ci = group[1] & 0x7;          // countinuity index
 		bool sg = (group[2] >> 14) & 0x1;          // second group
@@ -588,6 +647,9 @@ void parser_impl::parse(pmt::pmt_t pdu) {
 		return;
 	}
 
+	gr::thread::scoped_lock lock(d_mutex);
+	unsigned long version = d_station.version;
+
 	unsigned char *bytes = (unsigned char *)pmt::blob_data(vec);
 	unsigned int group[4];
 	group[0] = bytes[1] | (((unsigned int)(bytes[0])) << 8U);
@@ -604,13 +666,33 @@ void parser_impl::parse(pmt::pmt_t pdu) {
 	lout << "(" << rds_group_acronyms[group_type] << ")";
 
 	program_identification = group[0];     // "PI"
+	if (d_station.pi && program_identification != d_station.pi) {
+		// new station, but only once the PI has been received in two
+		// consecutive groups. A single group may be damaged, so it is
+		// ignored instead of clearing the state.
+		if (program_identification != pending_pi) {
+			pending_pi = program_identification;
+			lout << " - new PI, ignored" << std::endl;
+			return;
+		}
+		clear();
+	}
+	pending_pi = 0;
+	if (program_identification != d_station.pi) {
+		d_station.pi = program_identification;
+		touch(RDS_PI);
+	}
 	program_type = (group[1] >> 5) & 0x1f; // "PTY"
+	if (program_type != d_station.pty || !d_station.pty_name[0]) {
+		d_station.pty = program_type;
+		strncpy(d_station.pty_name, pty_table[program_type][pty_locale].c_str(),
+				sizeof(d_station.pty_name) - 1);
+		touch(RDS_PTY);
+	}
 	int pi_country_identification = (program_identification >> 12) & 0xf;
 	int pi_area_coverage = (program_identification >> 8) & 0xf;
 	unsigned char pi_program_reference_number = program_identification & 0xff;
 	std::string pistring = str(boost::format("%04X") % program_identification);
-	send_message(0, pistring);
-	send_message(2, pty_table[program_type][pty_locale]);
 
 	lout << " - PI:" << pistring << " - " << "PTY:" << pty_table[program_type][pty_locale];
 	lout << " (country:" << pi_country_codes[pi_country_identification - 1][0];
@@ -677,4 +759,13 @@ void parser_impl::parse(pmt::pmt_t pdu) {
 		dout << "  " << HEX(group[i]);
 	}
 	dout << std::endl;
+
+	unsigned int changed = d_station.changed_since(version);
+	if (changed && d_notify) {
+		station_state state = d_station;
+		notify_fn notify = d_notify;
+
+		lock.unlock();
+		notify(state, changed);
+	}
 }
@@ -32,7 +32,12 @@ private:
 	~parser_impl();
 
 	void reset();
-	void send_message(long, std::string);
+	void get_state(station_state &state);
+	void set_notify(notify_fn notify);
+
+	void clear();
+	void touch(station_field field);
+	void add_af(double af);
 	void parse(pmt::pmt_t pdu);
 	double decode_af(unsigned int);
 	void decode_optional_content(int, unsigned long int *);
@@ -55,6 +60,7 @@ private:
 	void decode_type15(unsigned int* group, bool B);
 
 	unsigned int   program_identification;
+	unsigned int   pending_pi;      // PI of a possible new station
 	unsigned char  program_type;
 	unsigned char  pi_country_identification;
 	unsigned char  pi_area_coverage;
@@ -72,6 +78,8 @@ private:
 	bool           log;
 	bool           debug;
 	unsigned char  pty_locale;
+	station_state  d_station;
+	notify_fn      d_notify;
 	gr::thread::mutex d_mutex;
 };
 
@@ -20,15 +20,135 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
 #include "dsp/resampler_xx.h"
 
+/* Limits for using the rational resampler. The number of taps grows with
+   the larger of interpolation and decimation, and each block keeps its own
+   copy of them. Other rates use the arbitrary resampler. */
+#define MAX_RATIONAL_TAPS    2048   /* Taps of the prototype filter. */
+#define MAX_RATIONAL_MACS    256    /* Multiply-accumulates per output sample. */
 
-/* Create a new instance of resampler_cc and return
- * a boost shared_ptr. This is effectively the public constructor.
+/* Number of filters in the arbitrary resampler. */
+#define PFB_FLT_SIZE         32
+
+
+/*! \brief Estimate the number of taps of a rational resampler.
+ *
+ * Same estimate as in firdes for the Kaiser window with beta = 7 used in
+ * resampler_taps(). The transition band is 0.1 times the lower of the input
+ * and output rates, which gives about 33 taps per phase of the larger of
+ * interpolation and decimation.
+ */
+static unsigned int rational_ntaps(unsigned int interp, unsigned int decim)
+{
+    double atten = 7.0 / 0.1102 + 8.7;
+
+    return (unsigned int)(atten / (22.0 * 0.1) * std::max(interp, decim));
+}
+
+/*! \brief Find interpolation and decimation for a rational rate.
+ *  \returns True if the rate is a ratio of small integers and the filter
+ *           stays within MAX_RATIONAL_TAPS and MAX_RATIONAL_MACS.
+ */
+static bool find_ratio(float rate, unsigned int &interp, unsigned int &decim)
+{
+    for (decim = 1; rational_ntaps(1, decim) <= MAX_RATIONAL_TAPS; decim++)
+    {
+        double i = round((double)rate * decim);
+
+        if (i < 1.0)
+            continue;
+
+        if (fabs(i / decim - (double)rate) < 1.0e-6 * rate)
+        {
+            /* the first match is the reduced fraction */
+            unsigned int ntaps;
+
+            interp = (unsigned int)i;
+            ntaps = rational_ntaps(interp, decim);
+
+            return (ntaps <= MAX_RATIONAL_TAPS) &&
+                   (ntaps / interp <= MAX_RATIONAL_MACS);
+        }
+    }
+
+    return false;
+}
+
+/*! \brief Get the filter taps for a resampler.
+ *  \param interp The interpolation (0 for the arbitrary resampler).
+ *  \param decim The decimation.
+ *  \param rate The resampling rate.
+ *
+ * The taps are designed once for each rate. The resampler blocks copy them
+ * into their own filters, so the cache only saves the filter design.
  */
+static std::shared_ptr<const std::vector<float> > resampler_taps(unsigned int interp,
+                                                                 unsigned int decim,
+                                                                 float rate)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<unsigned int, float>,
+                    std::shared_ptr<const std::vector<float> > > cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::pair<unsigned int, float> key(interp, interp ? (float)decim : rate);
+    std::shared_ptr<const std::vector<float> > &taps = cache[key];
+
+    if (taps)
+        return taps;
+
+    if (interp)
+    {
+        /* same design as rational_resampler.py in gr-filter */
+        double fractional_bw = 0.4;
+        double halfband = 0.5;
+        double r = (double)interp / (double)decim;
+        double trans_width, mid_transition_band;
+
+        if (r >= 1.0)
+        {
+            trans_width = halfband - fractional_bw;
+            mid_transition_band = halfband - trans_width / 2.0;
+        }
+        else
+        {
+            trans_width = r * (halfband - fractional_bw);
+            mid_transition_band = r * halfband - trans_width / 2.0;
+        }
+
+        taps = std::make_shared<const std::vector<float> >(
+                    gr::filter::firdes::low_pass(interp, interp, mid_transition_band,
+                                                 trans_width,
+                                                 gr::filter::firdes::WIN_KAISER, 7.0));
+    }
+    else
+    {
+        /* Note: In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
+                 signals when we have a frequency translation in front of the PFB resampler.
+        */
+        double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
+        double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
+
+        taps = std::make_shared<const std::vector<float> >(
+                    gr::filter::firdes::low_pass(PFB_FLT_SIZE, PFB_FLT_SIZE,
+                                                 cutoff, trans_width));
+    }
+
+    return taps;
+}
+
+
 resampler_cc_sptr make_resampler_cc(float rate)
 {
     return gnuradio::get_initial_sptr(new resampler_cc(rate));
@@ -43,24 +163,12 @@ resampler_cc::resampler_cc(float rate)
        http://gnuradio.squarespace.com/blog/2010/12/6/new-interface-for-pfb_arb_resampler_ccf.html
 
        and blks2.pfb_arb_resampler.py
-
-       Note: In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
-             signals when we have a frequency translation in front of the PFB resampler.
     */
-
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
-
-    /* create the filter */
-    d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
+    make_filter(rate);
 
     /* connect filter */
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
+    connect(self(), 0, d_block, 0);
+    connect(d_block, 0, self(), 0);
 }
 
 resampler_cc::~resampler_cc()
@@ -68,28 +176,41 @@ resampler_cc::~resampler_cc()
 
 }
 
-void resampler_cc::set_rate(float rate)
+/*! \brief Create a rational or arbitrary resampler for the rate. */
+void resampler_cc::make_filter(float rate)
 {
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    std::shared_ptr<const std::vector<float> > taps;
+    unsigned int interp, decim;
+
+    d_filter.reset();
+    d_rat.reset();
+
+    if (find_ratio(rate, interp, decim))
+    {
+        taps = resampler_taps(interp, decim, rate);
+        d_rat = gr::filter::rational_resampler_base_ccf::make(interp, decim, *taps);
+        d_block = d_rat;
+    }
+    else
+    {
+        taps = resampler_taps(0, 0, rate);
+        d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, *taps, PFB_FLT_SIZE);
+        d_block = d_filter;
+    }
+}
 
+void resampler_cc::set_rate(float rate)
+{
     /* FIXME: Should implement set_taps() in PFB */
     lock();
-    disconnect(self(), 0, d_filter, 0);
-    disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_ccf::make(rate, d_taps, flt_size);
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
+    disconnect(self(), 0, d_block, 0);
+    disconnect(d_block, 0, self(), 0);
+    make_filter(rate);
+    connect(self(), 0, d_block, 0);
+    connect(d_block, 0, self(), 0);
     unlock();
 }
 
-/* Create a new instance of resampler_ff and return
- * a boost shared_ptr. This is effectively the public constructor.
- */
 resampler_ff_sptr make_resampler_ff(float rate)
 {
     return gnuradio::get_initial_sptr(new resampler_ff(rate));
@@ -100,28 +221,11 @@ resampler_ff::resampler_ff(float rate)
           gr::io_signature::make (1, 1, sizeof(float)),
           gr::io_signature::make (1, 1, sizeof(float)))
 {
-    /* I ceated this code based on:
-       http://gnuradio.squarespace.com/blog/2010/12/6/new-interface-for-pfb_arb_resampler_ccf.html
-
-       and blks2.pfb_arb_resampler.py
-
-       Note: In case of decimation, we limit the cutoff to the output bandwidth to avoid "phantom"
-             signals when we have a frequency translation in front of the PFB resampler.
-    */
-
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
-
-    /* create the filter */
-    d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
+    make_filter(rate);
 
     /* connect filter */
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
+    connect(self(), 0, d_block, 0);
+    connect(d_block, 0, self(), 0);
 }
 
 resampler_ff::~resampler_ff()
@@ -129,21 +233,37 @@ resampler_ff::~resampler_ff()
 
 }
 
-void resampler_ff::set_rate(float rate)
+/*! \brief Create a rational or arbitrary resampler for the rate. */
+void resampler_ff::make_filter(float rate)
 {
-    /* generate taps */
-    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
-    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
-    unsigned int flt_size = 32;
-    d_taps = gr::filter::firdes::low_pass(flt_size, flt_size, cutoff, trans_width);
+    std::shared_ptr<const std::vector<float> > taps;
+    unsigned int interp, decim;
 
+    d_filter.reset();
+    d_rat.reset();
+
+    if (find_ratio(rate, interp, decim))
+    {
+        taps = resampler_taps(interp, decim, rate);
+        d_rat = gr::filter::rational_resampler_base_fff::make(interp, decim, *taps);
+        d_block = d_rat;
+    }
+    else
+    {
+        taps = resampler_taps(0, 0, rate);
+        d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, *taps, PFB_FLT_SIZE);
+        d_block = d_filter;
+    }
+}
+
+void resampler_ff::set_rate(float rate)
+{
     /* FIXME: Should implement set_taps() in PFB */
     lock();
-    disconnect(self(), 0, d_filter, 0);
-    disconnect(d_filter, 0, self(), 0);
-    d_filter.reset();
-    d_filter = gr::filter::pfb_arb_resampler_fff::make(rate, d_taps, flt_size);
-    connect(self(), 0, d_filter, 0);
-    connect(d_filter, 0, self(), 0);
+    disconnect(self(), 0, d_block, 0);
+    disconnect(d_block, 0, self(), 0);
+    make_filter(rate);
+    connect(self(), 0, d_block, 0);
+    connect(d_block, 0, self(), 0);
     unlock();
 }
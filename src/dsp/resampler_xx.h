@@ -27,6 +27,13 @@
 #include <gnuradio/filter/pfb_arb_resampler_ccf.h>
 #include <gnuradio/filter/pfb_arb_resampler_fff.h>
 
+#if GNURADIO_VERSION < 0x030800
+#include <gnuradio/filter/rational_resampler_base_ccf.h>
+#include <gnuradio/filter/rational_resampler_base_fff.h>
+#else
+#include <gnuradio/filter/rational_resampler_base.h>
+#endif
+
 
 class resampler_cc;
 class resampler_ff;
@@ -48,6 +55,11 @@ resampler_cc_sptr make_resampler_cc(float rate);
  * This block is a convenience wrapper around gr_pfb_arb_resampler_ccf. It takes care
  * of generating filter taps that can be used for the filter, as well as calculating
  * the other required parameters.
+ *
+ * If the rate is a ratio of small integers a rational resampler is used
+ * instead, which only calculates the output samples actually needed. Ratios
+ * needing too many taps, or too much work per output sample, still use the
+ * arbitrary resampler. The filter taps are designed once for each rate.
  */
 class resampler_cc : public gr::hier_block2
 {
@@ -59,8 +71,11 @@ public:
     void set_rate(float rate);
 
 private:
-    std::vector<float>            d_taps;
+    void make_filter(float rate);
+
     gr::filter::pfb_arb_resampler_ccf::sptr d_filter;
+    gr::filter::rational_resampler_base_ccf::sptr d_rat;
+    gr::basic_block_sptr          d_block;  /*! The connected resampler. */
 };
 
 
@@ -78,6 +93,8 @@ resampler_ff_sptr make_resampler_ff(float rate);
  * This block is a convenience wrapper around gr_pfb_arb_resampler_fff. It takes care
  * of generating filter taps that can be used for the filter, as well as calculating
  * the other required parameters.
+ *
+ * Rational rates are handled like in resampler_cc.
  */
 class resampler_ff : public gr::hier_block2
 {
@@ -89,8 +106,11 @@ public:
     void set_rate(float rate);
 
 private:
-    std::vector<float>            d_taps;
+    void make_filter(float rate);
+
     gr::filter::pfb_arb_resampler_fff::sptr d_filter;
+    gr::filter::rational_resampler_base_fff::sptr d_rat;
+    gr::basic_block_sptr          d_block;  /*! The connected resampler. */
 };
 
 #endif // RESAMPLER_XX_H
@@ -21,9 +21,11 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <algorithm>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/gr_complex.h>
 #include <dsp/rx_agc_xx.h>
+#include <dsp/rx_sql.h>
 
 rx_agc_cc_sptr make_rx_agc_cc(double sample_rate, bool agc_on, int threshold,
                               int manual_gain, int slope, int decay, bool use_hang)
@@ -49,11 +51,15 @@ rx_agc_cc::rx_agc_cc(double sample_rate, bool agc_on, int threshold,
       d_manual_gain(manual_gain),
       d_slope(slope),
       d_decay(decay),
-      d_use_hang(use_hang)
+      d_use_hang(use_hang),
+      d_sql_open(true)
 {
     d_agc = new CAgc();
     d_agc->SetParameters(d_agc_on, d_use_hang, d_threshold, d_manual_gain,
                          d_slope, d_decay, d_sample_rate);
+
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
 }
 
 rx_agc_cc::~rx_agc_cc()
@@ -73,13 +79,78 @@ int rx_agc_cc::work(int noutput_items,
 {
     const gr_complex *in = (const gr_complex *) input_items[0];
     gr_complex *out = (gr_complex *) output_items[0];
+    uint64_t    start = nitems_read(0);
+    int         i = 0;
 
-    boost::mutex::scoped_lock lock(d_mutex);
-    d_agc->ProcessData(noutput_items, in, out);
+    // process up to each squelch tag, muted runs are skipped
+    get_tags_in_range(d_tags, 0, start, start + noutput_items);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+    for (size_t t = 0; t < d_tags.size(); t++)
+    {
+        int pos = (int)(d_tags[t].offset - start);
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = true;
+            reset();
+        }
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = false;
+        }
+    }
+    process_run(in + i, out + i, noutput_items - i);
 
     return noutput_items;
 }
 
+/**
+ * \brief Process samples with the current squelch state.
+ *
+ * The input is zero while the squelch is closed, the output is cleared
+ * without running the AGC.
+ */
+void rx_agc_cc::process_run(const gr_complex *in, gr_complex *out, int nitems)
+{
+    if (nitems <= 0)
+        return;
+
+    if (d_sql_open)
+        process(in, out, nitems);
+    else
+        std::fill(out, out + nitems, gr_complex(0.0, 0.0));
+}
+
+/**
+ * \brief Run the AGC on a buffer.
+ * \param in The input samples.
+ * \param out The output buffer.
+ * \param nitems The number of samples.
+ *
+ * This is used by work() and by blocks that embed the AGC.
+ */
+void rx_agc_cc::process(const gr_complex *in, gr_complex *out, int nitems)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_agc->ProcessData(nitems, in, out);
+}
+
+/**
+ * \brief Clear the AGC state.
+ *
+ * Used when the input starts again after it was muted.
+ */
+void rx_agc_cc::reset()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_agc->Reset();
+}
+
 /**
  * \brief Enable or disable AGC.
  * \param agc_on Whether AGC should be endabled.
@@ -25,7 +25,9 @@
 
 #include <gnuradio/sync_block.h>
 #include <gnuradio/gr_complex.h>
+#include <gnuradio/tags.h>
 #include <boost/thread/mutex.hpp>
+#include <vector>
 #include <dsp/agc_impl.h>
 
 class rx_agc_cc;
@@ -58,7 +60,10 @@ rx_agc_cc_sptr make_rx_agc_cc(double sample_rate, bool agc_on, int threshold,
  * \ingroup DSP
  *
  * This block performs automatic gain control.
- * To be written...
+ *
+ * The AGC is bypassed while the squelch tags from rx_sql_cc mark the input
+ * as muted, and it is reset when the squelch opens so that no stale signal
+ * is left in the delay line.
  */
 class rx_agc_cc : public gr::sync_block
 {
@@ -77,6 +82,9 @@ public:
              gr_vector_const_void_star &input_items,
              gr_vector_void_star &output_items);
 
+    void process(const gr_complex *in, gr_complex *out, int nitems);
+    void reset();
+
     void set_agc_on(bool agc_on);
     void set_sample_rate(double sample_rate);
     void set_threshold(int threshold);
@@ -96,6 +104,13 @@ private:
     int             d_slope;         /*! Current AGC slope (0...10 dB). */
     int             d_decay;         /*! Current AGC decay (20...5000 ms). */
     bool            d_use_hang;      /*! Current AGC hang status (true/false). */
+
+    bool                    d_sql_open;  /*! Squelch state from the input tags. */
+    std::vector<gr::tag_t>  d_tags;
+    pmt::pmt_t              d_sob_key;
+    pmt::pmt_t              d_eob_key;
+
+    void process_run(const gr_complex *in, gr_complex *out, int nitems);
 };
 
 #endif /* RX_AGC_XX_H */
@@ -0,0 +1,241 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include "dsp/rx_anf.h"
+#include "dsp/rx_sql.h"
+
+#define ANF_BLOCK_TIME  0.01    /* Minimum block length in seconds. */
+#define ANF_PWR_ALPHA   0.9f    /* Smoothing of the bin power. */
+#define ANF_REG         0.1f    /* Regularization relative to the mean power. */
+#define ANF_LEAK        1.0e-6f /* Weight leakage per block. */
+
+
+rx_anf_cc_sptr make_rx_anf_cc(double sample_rate, float mu)
+{
+    return gnuradio::get_initial_sptr(new rx_anf_cc(sample_rate, mu));
+}
+
+rx_anf_cc::rx_anf_cc(double sample_rate, float mu)
+    : gr::sync_block ("rx_anf_cc",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_len(64),
+      d_pos(0),
+      d_mu(mu),
+      d_sql_open(true)
+{
+    while (d_len < ANF_BLOCK_TIME * sample_rate)
+        d_len *= 2;
+    d_delay = d_len / 4;
+
+    d_fwd = new gr::fft::fft_complex(2 * d_len, true);
+    d_inv = new gr::fft::fft_complex(2 * d_len, false);
+
+    d_hist.resize(2 * d_len + d_delay);
+    d_outbuf.resize(d_len);
+    d_ref.resize(2 * d_len);
+    d_weights.resize(2 * d_len);
+    d_tmp.resize(2 * d_len);
+    d_pwr.resize(2 * d_len);
+    d_norm.resize(2 * d_len);
+
+    reset();
+
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+}
+
+rx_anf_cc::~rx_anf_cc()
+{
+    delete d_fwd;
+    delete d_inv;
+}
+
+/*! \brief Automatic notch work method. */
+int rx_anf_cc::work(int noutput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    gr_complex       *out = (gr_complex *) output_items[0];
+    uint64_t          start = nitems_read(0);
+    int               i = 0;
+
+    // process up to each squelch tag, muted runs are skipped
+    get_tags_in_range(d_tags, 0, start, start + noutput_items);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+    for (size_t t = 0; t < d_tags.size(); t++)
+    {
+        int pos = (int)(d_tags[t].offset - start);
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = true;
+            clear_buffers();
+        }
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = false;
+        }
+    }
+    process_run(in + i, out + i, noutput_items - i);
+
+    return noutput_items;
+}
+
+/*! \brief Process samples with the current squelch state.
+ *
+ * The input is collected in blocks of M samples. The output of the last
+ * block is returned while the next block is collected. While the squelch
+ * is closed the output is cleared without filtering.
+ */
+void rx_anf_cc::process_run(const gr_complex *in, gr_complex *out,
+                            int nitems)
+{
+    unsigned int    i = 0;
+    unsigned int    n;
+
+    if (nitems <= 0)
+        return;
+
+    if (!d_sql_open)
+    {
+        std::fill(out, out + nitems, gr_complex(0.0f, 0.0f));
+        return;
+    }
+
+    while (i < (unsigned int)nitems)
+    {
+        n = std::min(d_len - d_pos, nitems - i);
+        std::copy(in + i, in + i + n, d_hist.begin() + d_len + d_delay + d_pos);
+        std::copy(d_outbuf.begin() + d_pos, d_outbuf.begin() + d_pos + n,
+                  out + i);
+        d_pos += n;
+        i += n;
+
+        if (d_pos == d_len)
+        {
+            process_block();
+            d_pos = 0;
+        }
+    }
+}
+
+/*! \brief Set the adaptation step.
+ *  \param mu The new normalized step, e.g. 0.1.
+ *
+ * Larger steps remove tones faster but also affect voiced speech.
+ */
+void rx_anf_cc::set_mu(float mu)
+{
+    d_mu = mu;
+}
+
+/*! \brief Clear the filter and the buffers. */
+void rx_anf_cc::reset()
+{
+    clear_buffers();
+    std::fill(d_weights.begin(), d_weights.end(), gr_complex(0.0f, 0.0f));
+    std::fill(d_pwr.begin(), d_pwr.end(), 0.0f);
+}
+
+/*! \brief Clear the buffered signal but keep the filter.
+ *
+ * Used when the squelch opens, a steady interfering tone is still notched.
+ */
+void rx_anf_cc::clear_buffers()
+{
+    std::fill(d_hist.begin(), d_hist.end(), gr_complex(0.0f, 0.0f));
+    std::fill(d_outbuf.begin(), d_outbuf.end(), gr_complex(0.0f, 0.0f));
+    d_pos = 0;
+}
+
+/*! \brief Filter a block and update the weights.
+ *
+ * d_hist holds the input from n - M - delay to n + M where n is the first
+ * sample of the block. The reference is the first 2M samples, the desired
+ * signal the last M samples.
+ */
+void rx_anf_cc::process_block()
+{
+    unsigned int      nfft = 2 * d_len;
+    float             scale = 1.0f / (float)nfft;
+    float             mu = d_mu;
+    const gr_complex *pred = d_inv->get_outbuf() + d_len;
+    const gr_complex *desired = &d_hist[d_len + d_delay];
+    gr_complex       *err = d_fwd->get_inbuf() + d_len;
+    gr_complex       *weights = &d_weights[0];
+    const gr_complex *grad = d_fwd->get_outbuf();
+    float            *pwr = &d_pwr[0];
+    float            *norm = &d_norm[0];
+    float             total, reg;
+    unsigned int      j;
+
+    // reference spectrum
+    std::copy(d_hist.begin(), d_hist.begin() + nfft, d_fwd->get_inbuf());
+    d_fwd->execute();
+    std::copy(d_fwd->get_outbuf(), d_fwd->get_outbuf() + nfft, d_ref.begin());
+
+    // prediction is the last M samples of the circular convolution
+    volk_32fc_x2_multiply_32fc(d_inv->get_inbuf(), &d_ref[0], weights, nfft);
+    d_inv->execute();
+
+    // the prediction error is the output
+    std::fill(d_fwd->get_inbuf(), d_fwd->get_inbuf() + d_len, gr_complex(0.0f, 0.0f));
+    for (j = 0; j < d_len; j++)
+        err[j] = desired[j] - pred[j] * scale;
+    std::copy(err, err + d_len, d_outbuf.begin());
+
+    // normalize the step with the power of each bin
+    volk_32fc_magnitude_squared_32f(norm, &d_ref[0], nfft);
+    for (j = 0; j < nfft; j++)
+        pwr[j] = ANF_PWR_ALPHA * pwr[j] + (1.0f - ANF_PWR_ALPHA) * norm[j];
+    volk_32f_accumulator_s32f(&total, pwr, nfft);
+    reg = ANF_REG * total * scale + 1.0e-20f;
+    for (j = 0; j < nfft; j++)
+        norm[j] = mu * scale / (pwr[j] + reg);
+
+    // gradient conj(X) * E
+    d_fwd->execute();
+    volk_32fc_x2_multiply_conjugate_32fc(&d_tmp[0], d_fwd->get_outbuf(), &d_ref[0], nfft);
+    volk_32fc_32f_multiply_32fc(d_inv->get_inbuf(), &d_tmp[0], norm, nfft);
+
+    // constrain the gradient to M taps
+    d_inv->execute();
+    std::copy(d_inv->get_outbuf(), d_inv->get_outbuf() + d_len, d_fwd->get_inbuf());
+    std::fill(d_fwd->get_inbuf() + d_len, d_fwd->get_inbuf() + nfft, gr_complex(0.0f, 0.0f));
+    d_fwd->execute();
+
+    for (j = 0; j < nfft; j++)
+        weights[j] = weights[j] * (1.0f - ANF_LEAK) + grad[j];
+
+    std::copy(d_hist.begin() + d_len, d_hist.end(), d_hist.begin());
+}
@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_ANF_H
+#define RX_ANF_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/tags.h>
+#include <vector>
+
+
+class rx_anf_cc;
+
+typedef boost::shared_ptr<rx_anf_cc> rx_anf_cc_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_anf_cc.
+ *  \param sample_rate The sample rate.
+ *  \param mu The normalized adaptation step.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the rx_anf_cc constructor is private.
+ * make_rx_anf_cc is the public interface for creating new instances.
+ */
+rx_anf_cc_sptr make_rx_anf_cc(double sample_rate, float mu = 0.1);
+
+
+/*! \brief Automatic notch filter.
+ *  \ingroup DSP
+ *
+ * The notch is an adaptive line enhancer: an adaptive filter predicts the
+ * input from a copy delayed by a few milliseconds. Only steady tones can be
+ * predicted across the delay, so the prediction error is the input with the
+ * carriers removed. Any number of tones is followed, limited only by the
+ * filter length.
+ *
+ * The filter is adapted with the constrained frequency domain block LMS
+ * algorithm using overlap-save. A block of M samples costs five FFTs of
+ * size 2M instead of M multiply-accumulates per sample for the filter and
+ * the update each. The step is normalized with the power of each bin so
+ * that weak and strong tones converge at the same rate. With the default
+ * step a carrier is attenuated by 30 dB within about half a second while
+ * speech, which changes too fast to be predicted, is mostly untouched.
+ *
+ * The output is delayed by one block.
+ *
+ * While the squelch tags from rx_sql_cc mark the input as muted the output
+ * is zero without filtering. The buffered signal is cleared when the
+ * squelch opens; the filter is kept.
+ */
+class rx_anf_cc : public gr::sync_block
+{
+    friend rx_anf_cc_sptr make_rx_anf_cc(double sample_rate, float mu);
+
+protected:
+    rx_anf_cc(double sample_rate, float mu);
+
+public:
+    ~rx_anf_cc();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void set_mu(float mu);
+    void reset();
+
+private:
+    unsigned int    d_len;          /*! Block and filter length M. */
+    unsigned int    d_delay;        /*! Decorrelation delay. */
+    unsigned int    d_pos;          /*! Samples in the current block. */
+    float           d_mu;           /*! Normalized step. */
+
+    gr::fft::fft_complex   *d_fwd;  /*! Forward FFT of size 2M. */
+    gr::fft::fft_complex   *d_inv;  /*! Inverse FFT of size 2M. */
+
+    std::vector<gr_complex> d_hist;     /*! Last 2M + delay input samples. */
+    std::vector<gr_complex> d_outbuf;   /*! Output of the last block. */
+    std::vector<gr_complex> d_ref;      /*! Spectrum of the reference. */
+    std::vector<gr_complex> d_weights;  /*! Filter in the frequency domain. */
+    std::vector<gr_complex> d_tmp;      /*! Scratch spectrum. */
+    std::vector<float>      d_pwr;      /*! Power of the reference bins. */
+    std::vector<float>      d_norm;     /*! Step for each bin. */
+
+    bool                    d_sql_open; /*! Squelch state from the input tags. */
+    std::vector<gr::tag_t>  d_tags;
+    pmt::pmt_t              d_sob_key;
+    pmt::pmt_t              d_eob_key;
+
+    void process_run(const gr_complex *in, gr_complex *out, int nitems);
+    void process_block();
+    void clear_buffers();
+};
+
+#endif /* RX_ANF_H */
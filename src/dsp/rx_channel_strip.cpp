@@ -0,0 +1,536 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include <volk/volk.h>
+#include "dsp/fm_discriminator.h"
+#include "dsp/rx_channel_strip.h"
+
+/* Maximum number of input samples processed in one call. */
+#define STRIP_MAX_IN        4096
+
+/* Extra output space required for samples buffered in the resamplers. */
+#define STRIP_OUT_MARGIN    64
+
+/* Number of filters in the polyphase resamplers. */
+#define STRIP_FLT_SIZE      32
+
+
+rx_channel_strip_cf_sptr make_rx_channel_strip_cf(float quad_rate,
+                                                  float chan_rate,
+                                                  float audio_rate)
+{
+    return gnuradio::get_initial_sptr(new rx_channel_strip_cf(quad_rate,
+                                                              chan_rate,
+                                                              audio_rate));
+}
+
+/*! \brief Generate taps for the polyphase resamplers (same as resampler_xx). */
+static std::vector<float> resampler_taps(float rate)
+{
+    double cutoff = rate > 1.0 ? 0.4 : 0.4*rate;
+    double trans_width = rate > 1.0 ? 0.2 : 0.2*rate;
+
+    return gr::filter::firdes::low_pass(STRIP_FLT_SIZE, STRIP_FLT_SIZE,
+                                        cutoff, trans_width);
+}
+
+rx_channel_strip_cf::rx_channel_strip_cf(float quad_rate, float chan_rate,
+                                         float audio_rate)
+    : gr::block ("rx_channel_strip_cf",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(2, 2, sizeof(float))),
+      d_quad_rate(quad_rate),
+      d_chan_rate(chan_rate),
+      d_audio_rate(audio_rate),
+      d_iq_rr(0),
+      d_iq_len(0),
+      d_fir(0),
+      d_low(-5000.0),
+      d_high(5000.0),
+      d_trans_width(1000.0),
+      d_cw_offset(0.0),
+      d_sql_open(true),
+      d_demod(STRIP_DEMOD_FM),
+      d_max_dev(5000.0),
+      d_tau(75.0e-6),
+      d_deemph_x1(0.0),
+      d_deemph_y1(0.0),
+      d_fm_last(0.0, 0.0),
+      d_dcr(true),
+      d_dcr_x1(0.0),
+      d_dcr_y1(0.0),
+      d_audio_rr0(0),
+      d_audio_rr1(0),
+      d_audio_len(0),
+      d_audio_hist(0)
+{
+    d_nb = make_rx_nb_cc(d_chan_rate, 3.3, 2.5);
+    d_meter = make_rx_meter_c(DETECTOR_TYPE_RMS, d_chan_rate);
+    d_agc = make_rx_agc_cc(d_chan_rate, true, -100, 0, 0, 500, false);
+    d_sql = make_rx_sql_cc(d_chan_rate, -150.0, 0.001);
+
+    filter_key key = { d_chan_rate, d_low, d_high, d_trans_width, d_cw_offset };
+    d_fir = new gr::filter::kernel::fir_filter_ccc(1, *filter_designer::instance().get_taps(key));
+
+    set_fm_deemph(d_tau);
+    set_min_noutput_items(2 * STRIP_OUT_MARGIN);
+    update_rate();
+}
+
+rx_channel_strip_cf::~rx_channel_strip_cf()
+{
+    filter_designer::instance().cancel(this);
+
+    delete d_iq_rr;
+    delete d_fir;
+    delete d_audio_rr0;
+    delete d_audio_rr1;
+}
+
+void rx_channel_strip_cf::forecast(int noutput_items,
+                                   gr_vector_int &ninput_items_required)
+{
+    int nin = (int)((noutput_items - STRIP_OUT_MARGIN) * d_quad_rate / d_audio_rate);
+
+    ninput_items_required[0] = std::max(1, std::min(nin, STRIP_MAX_IN));
+}
+
+/*! \brief Channel strip work method.
+ *
+ * The input is processed in one pass, each stage working in place on the
+ * channel buffer.
+ */
+int rx_channel_strip_cf::general_work(int noutput_items,
+                                      gr_vector_int &ninput_items,
+                                      gr_vector_const_void_star &input_items,
+                                      gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    float *out0 = (float *) output_items[0];
+    float *out1 = (float *) output_items[1];
+    int    nin, n;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    if (d_new_taps)
+    {
+        unsigned int old_hist = d_fir->ntaps() - 1;
+        unsigned int new_hist = d_new_taps->size() - 1;
+        std::vector<gr_complex> hist(new_hist, gr_complex(0.0, 0.0));
+
+        // keep as much of the filter history as possible
+        unsigned int keep = std::min(old_hist, new_hist);
+        std::copy(d_fir_buf.begin() + old_hist - keep, d_fir_buf.begin() + old_hist,
+                  hist.end() - keep);
+        d_fir_buf.resize(new_hist + d_chan.size());
+        std::copy(hist.begin(), hist.end(), d_fir_buf.begin());
+
+        d_fir->set_taps(*d_new_taps);
+        d_new_taps.reset();
+    }
+
+    nin = (int)((noutput_items - STRIP_OUT_MARGIN) * d_quad_rate / d_audio_rate);
+    nin = std::min(std::min(nin, ninput_items[0]), STRIP_MAX_IN);
+    if (nin <= 0)
+        return 0;
+
+    n = resample_iq(in, nin);
+
+    d_nb->process(&d_chan[0], &d_chan[0], n);
+    filter(n);
+    d_meter->process(&d_chan[0], n);
+    if (squelch(n) > 0)
+    {
+        if (!d_sql_open)
+            reset_demod();
+        d_sql_open = true;
+        d_agc->process(&d_chan[0], &d_chan[0], n);
+        demodulate(n);
+    }
+    else
+    {
+        // muted, skip AGC and demodulator
+        d_sql_open = false;
+        std::fill(d_audio0.begin() + d_audio_len, d_audio0.begin() + d_audio_len + n, 0.0f);
+        std::fill(d_audio1.begin() + d_audio_len, d_audio1.begin() + d_audio_len + n, 0.0f);
+    }
+
+    consume_each(nin);
+
+    return resample_audio(out0, out1, n);
+}
+
+/*! \brief Set new input sample rate. */
+void rx_channel_strip_cf::set_quad_rate(float quad_rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_quad_rate = quad_rate;
+    update_rate();
+}
+
+/*! \brief Set new audio output rate. */
+void rx_channel_strip_cf::set_audio_rate(float audio_rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_audio_rate = audio_rate;
+    update_rate();
+}
+
+/*! \brief Recreate the resamplers and buffers after a rate change. */
+void rx_channel_strip_cf::update_rate()
+{
+    float iq_rate = d_chan_rate / d_quad_rate;
+    float audio_rate = d_audio_rate / d_chan_rate;
+
+    delete d_iq_rr;
+    d_iq_rr = 0;
+    d_iq_len = 0;
+    if (fabsf(iq_rate - 1.0f) > 1.0e-6f)
+    {
+        d_iq_rr = new gr::filter::kernel::pfb_arb_resampler_ccf(
+                    iq_rate, resampler_taps(iq_rate), STRIP_FLT_SIZE);
+        d_iq_len = d_iq_rr->taps_per_filter() - 1;
+    }
+    d_iq_buf.assign(STRIP_MAX_IN + d_iq_len + STRIP_OUT_MARGIN, gr_complex(0.0, 0.0));
+
+    d_chan.resize((size_t)(STRIP_MAX_IN * std::max(1.0f, iq_rate)) + STRIP_OUT_MARGIN);
+    d_tmp.resize(d_chan.size() + 1);
+    d_fir_buf.assign(d_fir->ntaps() - 1 + d_chan.size(), gr_complex(0.0, 0.0));
+    d_sql_buf.assign(d_sql->preroll() + d_chan.size(), gr_complex(0.0, 0.0));
+
+    delete d_audio_rr0;
+    delete d_audio_rr1;
+    d_audio_rr0 = 0;
+    d_audio_rr1 = 0;
+    d_audio_hist = 0;
+    if (fabsf(audio_rate - 1.0f) > 1.0e-6f)
+    {
+        std::vector<float> taps = resampler_taps(audio_rate);
+
+        d_audio_rr0 = new gr::filter::kernel::pfb_arb_resampler_fff(audio_rate, taps, STRIP_FLT_SIZE);
+        d_audio_rr1 = new gr::filter::kernel::pfb_arb_resampler_fff(audio_rate, taps, STRIP_FLT_SIZE);
+        d_audio_hist = d_audio_rr0->taps_per_filter() - 1;
+    }
+    d_audio_len = d_audio_hist;
+    d_audio0.assign(d_chan.size() + d_audio_hist + STRIP_OUT_MARGIN, 0.0f);
+    d_audio1.assign(d_audio0.size(), 0.0f);
+
+    set_relative_rate(d_audio_rate / d_quad_rate);
+}
+
+/*! \brief Set the channel filter.
+ *
+ * The taps are provided by the filter designer, either from its cache or
+ * from the designer thread. They are applied at the beginning of the next
+ * work() call.
+ */
+void rx_channel_strip_cf::set_filter(double low, double high, double trans_width)
+{
+    d_low = std::max(low, -0.95 * d_chan_rate / 2.0);
+    d_high = std::min(high, 0.95 * d_chan_rate / 2.0);
+    d_trans_width = trans_width;
+    update_filter();
+}
+
+void rx_channel_strip_cf::set_cw_offset(double offset)
+{
+    if (offset != d_cw_offset)
+    {
+        d_cw_offset = offset;
+        update_filter();
+    }
+}
+
+/*! \brief Design the taps of a filter that is likely to be used soon. */
+void rx_channel_strip_cf::prefetch_filter(double low, double high, double trans_width)
+{
+    filter_key key = { d_chan_rate,
+                       std::max(low, -0.95 * d_chan_rate / 2.0),
+                       std::min(high, 0.95 * d_chan_rate / 2.0),
+                       trans_width, d_cw_offset };
+
+    filter_designer::instance().prefetch(key);
+}
+
+void rx_channel_strip_cf::update_filter()
+{
+    filter_key key = { d_chan_rate, d_low, d_high, d_trans_width, d_cw_offset };
+    filter_designer &designer = filter_designer::instance();
+    filter_designer::taps_sptr taps = designer.find_taps(key);
+
+    if (taps)
+    {
+        designer.cancel(this);
+        apply_taps(taps);
+    }
+    else
+    {
+        designer.request_taps(this, key, [this](filter_designer::taps_sptr taps) {
+            apply_taps(taps);
+        });
+    }
+}
+
+void rx_channel_strip_cf::apply_taps(filter_designer::taps_sptr taps)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_new_taps = taps;
+}
+
+/*! \brief Set squelch level in dBFS. */
+void rx_channel_strip_cf::set_sql_level(double level_db)
+{
+    d_sql->set_threshold(level_db);
+}
+
+void rx_channel_strip_cf::set_sql_alpha(double alpha)
+{
+    d_sql->set_alpha(alpha);
+}
+
+void rx_channel_strip_cf::set_demod(int demod)
+{
+    if ((demod < STRIP_DEMOD_NONE) || (demod > STRIP_DEMOD_SSB))
+        return;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_demod = demod;
+}
+
+void rx_channel_strip_cf::set_fm_maxdev(float maxdev_hz)
+{
+    if ((maxdev_hz < 500.0) || (maxdev_hz > d_chan_rate / 2.0))
+        return;
+
+    d_max_dev = maxdev_hz;
+}
+
+/*! \brief Set FM de-emphasis time constant.
+ *
+ * Same single pole filter as fm_discriminator_cf.
+ */
+void rx_channel_strip_cf::set_fm_deemph(double tau)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_tau = tau;
+    if (tau > 1.0e-9)
+    {
+        double fs = d_chan_rate;
+        double w_ca = 2.0 * fs * tan(1.0 / (tau * 2.0 * fs));
+        double k = -w_ca / (2.0 * fs);
+
+        d_deemph_b0 = -k / (1.0 - k);
+        d_deemph_b1 = d_deemph_b0;
+        d_deemph_p1 = (1.0 + k) / (1.0 - k);
+    }
+    else
+    {
+        d_deemph_b0 = 1.0;
+        d_deemph_b1 = 0.0;
+        d_deemph_p1 = 0.0;
+    }
+}
+
+void rx_channel_strip_cf::set_am_dcr(bool enabled)
+{
+    d_dcr = enabled;
+}
+
+/*! \brief Resample the input to the channel rate.
+ *  \returns The number of samples in d_chan.
+ */
+int rx_channel_strip_cf::resample_iq(const gr_complex *in, int nitems)
+{
+    int hist, n_read, produced;
+
+    if (!d_iq_rr)
+    {
+        std::copy(in, in + nitems, d_chan.begin());
+        return nitems;
+    }
+
+    // d_iq_buf holds the resampler history followed by unread samples
+    std::copy(in, in + nitems, d_iq_buf.begin() + d_iq_len);
+    d_iq_len += nitems;
+
+    hist = d_iq_rr->taps_per_filter() - 1;
+    if (d_iq_len <= hist)
+        return 0;
+
+    produced = d_iq_rr->filter(&d_chan[0], &d_iq_buf[0], d_iq_len - hist, n_read);
+
+    n_read = std::min(n_read, d_iq_len);
+    std::copy(d_iq_buf.begin() + n_read, d_iq_buf.begin() + d_iq_len, d_iq_buf.begin());
+    d_iq_len -= n_read;
+
+    return produced;
+}
+
+/*! \brief Run the channel filter in place on d_chan. */
+void rx_channel_strip_cf::filter(int nitems)
+{
+    int hist = d_fir->ntaps() - 1;
+
+    std::copy(d_chan.begin(), d_chan.begin() + nitems, d_fir_buf.begin() + hist);
+    d_fir->filterN(&d_chan[0], &d_fir_buf[0], nitems);
+    std::copy(d_fir_buf.begin() + nitems, d_fir_buf.begin() + nitems + hist,
+              d_fir_buf.begin());
+}
+
+/*! \brief Run the squelch on d_chan.
+ *  \returns The number of samples passed.
+ *
+ * The squelch delays the signal by its pre-roll, d_sql_buf holds the
+ * delayed samples followed by the new ones.
+ */
+int rx_channel_strip_cf::squelch(int nitems)
+{
+    int hist = d_sql->preroll();
+    int passed;
+
+    std::copy(d_chan.begin(), d_chan.begin() + nitems, d_sql_buf.begin() + hist);
+    passed = d_sql->process(&d_sql_buf[0], &d_chan[0], nitems);
+    std::copy(d_sql_buf.begin() + nitems, d_sql_buf.begin() + nitems + hist,
+              d_sql_buf.begin());
+
+    return passed;
+}
+
+/*! \brief Clear the AGC and demodulator state when the squelch opens. */
+void rx_channel_strip_cf::reset_demod()
+{
+    d_agc->reset();
+    d_fm_last = gr_complex(0.0, 0.0);
+    d_deemph_x1 = 0.0;
+    d_deemph_y1 = 0.0;
+    d_dcr_x1 = 0.0;
+    d_dcr_y1 = 0.0;
+}
+
+/*! \brief Demodulate d_chan into the audio buffers. */
+void rx_channel_strip_cf::demodulate(int nitems)
+{
+    float  *a0 = &d_audio0[d_audio_len];
+    float  *a1 = &d_audio1[d_audio_len];
+    int     i;
+
+    if (nitems == 0)
+        return;
+
+    switch (d_demod)
+    {
+    case STRIP_DEMOD_NONE:
+        for (i = 0; i < nitems; i++)
+        {
+            a0[i] = d_chan[i].real();
+            a1[i] = d_chan[i].imag();
+        }
+        break;
+
+    case STRIP_DEMOD_SSB:
+        for (i = 0; i < nitems; i++)
+            a0[i] = d_chan[i].real();
+        break;
+
+    case STRIP_DEMOD_AM:
+        volk_32fc_magnitude_32f(a0, &d_chan[0], nitems);
+        if (d_dcr)
+        {
+            for (i = 0; i < nitems; i++)
+            {
+                float x = a0[i];
+
+                a0[i] = x - d_dcr_x1 + 0.999f * d_dcr_y1;
+                d_dcr_x1 = x;
+                d_dcr_y1 = a0[i];
+            }
+        }
+        break;
+
+    case STRIP_DEMOD_FM:
+    default:
+        // quadrature discriminator followed by de-emphasis
+        d_tmp[0] = d_fm_last;
+        std::copy(d_chan.begin(), d_chan.begin() + nitems, d_tmp.begin() + 1);
+        d_fm_last = d_chan[nitems - 1];
+        fm_discriminator_cf::discriminate(a0, &d_tmp[0], nitems,
+                                          d_chan_rate / (2.0 * M_PI * d_max_dev),
+                                          false);
+
+        for (i = 0; i < nitems; i++)
+        {
+            float x = a0[i];
+
+            a0[i] = d_deemph_b0 * x + d_deemph_b1 * d_deemph_x1 + d_deemph_p1 * d_deemph_y1;
+            d_deemph_x1 = x;
+            d_deemph_y1 = a0[i];
+        }
+        break;
+    }
+}
+
+/*! \brief Resample the audio buffers to the audio rate.
+ *  \returns The number of output samples.
+ */
+int rx_channel_strip_cf::resample_audio(float *out0, float *out1, int nitems)
+{
+    bool    stereo = (d_demod == STRIP_DEMOD_NONE);
+    int     total = d_audio_len + nitems;
+    int     n_read, produced;
+
+    if (!d_audio_rr0)
+    {
+        std::copy(d_audio0.begin(), d_audio0.begin() + nitems, out0);
+        std::copy(stereo ? d_audio1.begin() : d_audio0.begin(),
+                  (stereo ? d_audio1.begin() : d_audio0.begin()) + nitems, out1);
+        return nitems;
+    }
+
+    if (total <= d_audio_hist)
+    {
+        d_audio_len = total;
+        return 0;
+    }
+
+    produced = d_audio_rr0->filter(out0, &d_audio0[0], total - d_audio_hist, n_read);
+    if (stereo)
+        d_audio_rr1->filter(out1, &d_audio1[0], total - d_audio_hist, n_read);
+    else
+        std::copy(out0, out0 + produced, out1);
+
+    n_read = std::min(n_read, total);
+    std::copy(d_audio0.begin() + n_read, d_audio0.begin() + total, d_audio0.begin());
+    std::copy(d_audio1.begin() + n_read, d_audio1.begin() + total, d_audio1.begin());
+    d_audio_len = total - n_read;
+
+    return produced;
+}
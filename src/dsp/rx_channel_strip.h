@@ -0,0 +1,191 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_CHANNEL_STRIP_H
+#define RX_CHANNEL_STRIP_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/filter/fir_filter.h>
+#include <gnuradio/filter/pfb_arb_resampler.h>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+#include "dsp/filter_designer.h"
+#include "dsp/rx_agc_xx.h"
+#include "dsp/rx_meter.h"
+#include "dsp/rx_noise_blanker_cc.h"
+#include "dsp/rx_sql.h"
+
+
+class rx_channel_strip_cf;
+
+typedef boost::shared_ptr<rx_channel_strip_cf> rx_channel_strip_cf_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_channel_strip_cf.
+ *  \param quad_rate The input sample rate.
+ *  \param chan_rate The channel sample rate used for processing.
+ *  \param audio_rate The audio output rate.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the rx_channel_strip_cf constructor is private.
+ * make_rx_channel_strip_cf is the public interface for creating new instances.
+ */
+rx_channel_strip_cf_sptr make_rx_channel_strip_cf(float quad_rate,
+                                                  float chan_rate,
+                                                  float audio_rate);
+
+
+/*! \brief Narrow band channel strip.
+ *  \ingroup DSP
+ *
+ * This block does the complete narrow band receiver processing in one
+ * block: resampling to the channel rate, noise blanking, channel filter,
+ * signal meter, squelch, AGC, demodulation and resampling to the audio rate.
+ * It is equivalent to the block chain in nbrx but each chunk of samples
+ * passes all stages while it is in the cache and there is only one buffer
+ * and scheduler thread per channel.
+ *
+ * The noise blanker, meter, squelch and AGC are regular blocks that are not
+ * connected to the flow graph. The strip calls their process() methods and
+ * they can be configured as usual through the accessors.
+ *
+ * The AGC and the demodulator are skipped while the squelch is closed and
+ * their state is cleared when it opens.
+ *
+ * Output 0 and 1 carry the left and right audio channels. They are equal
+ * except for raw I/Q.
+ */
+class rx_channel_strip_cf : public gr::block
+{
+    friend rx_channel_strip_cf_sptr make_rx_channel_strip_cf(float quad_rate,
+                                                             float chan_rate,
+                                                             float audio_rate);
+
+public:
+    /*! \brief Available demodulators (same values as nbrx). */
+    enum strip_demod {
+        STRIP_DEMOD_NONE = 0,  /*!< No demod. Raw I/Q to audio. */
+        STRIP_DEMOD_AM   = 1,  /*!< Amplitude modulation. */
+        STRIP_DEMOD_FM   = 2,  /*!< Frequency modulation. */
+        STRIP_DEMOD_SSB  = 3   /*!< Single Side Band. */
+    };
+
+protected:
+    rx_channel_strip_cf(float quad_rate, float chan_rate, float audio_rate);
+
+public:
+    ~rx_channel_strip_cf();
+
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work(int noutput_items,
+                     gr_vector_int &ninput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
+    void set_quad_rate(float quad_rate);
+    void set_audio_rate(float audio_rate);
+
+    void set_filter(double low, double high, double trans_width);
+    void set_cw_offset(double offset);
+    void prefetch_filter(double low, double high, double trans_width);
+
+    void set_sql_level(double level_db);
+    void set_sql_alpha(double alpha);
+
+    void set_demod(int demod);
+    void set_fm_maxdev(float maxdev_hz);
+    void set_fm_deemph(double tau);
+    void set_am_dcr(bool enabled);
+
+    rx_nb_cc_sptr nb() const { return d_nb; }
+    rx_meter_c_sptr meter() const { return d_meter; }
+    rx_agc_cc_sptr agc() const { return d_agc; }
+
+private:
+    void update_rate();
+    void update_filter();
+    void apply_taps(filter_designer::taps_sptr taps);
+    int  resample_iq(const gr_complex *in, int nitems);
+    void filter(int nitems);
+    int  squelch(int nitems);
+    void reset_demod();
+    void demodulate(int nitems);
+    int  resample_audio(float *out0, float *out1, int nitems);
+
+    boost::mutex    d_mutex;        /*! Protects the parameters. */
+
+    float   d_quad_rate;            /*! Input sample rate. */
+    float   d_chan_rate;            /*! Channel sample rate. */
+    float   d_audio_rate;           /*! Audio output rate. */
+
+    rx_nb_cc_sptr       d_nb;       /*! Noise blanker. */
+    rx_meter_c_sptr     d_meter;    /*! Signal strength. */
+    rx_agc_cc_sptr      d_agc;      /*! AGC. */
+
+    /* channel resampler */
+    gr::filter::kernel::pfb_arb_resampler_ccf *d_iq_rr;
+    std::vector<gr_complex> d_iq_buf;   /*! Resampler input incl. history. */
+    int                     d_iq_len;   /*! Samples in d_iq_buf. */
+
+    /* channel filter */
+    gr::filter::kernel::fir_filter_ccc *d_fir;
+    std::vector<gr_complex> d_fir_buf;  /*! Filter input incl. history. */
+    filter_designer::taps_sptr d_new_taps;  /*! Taps to apply in work. */
+    double  d_low;
+    double  d_high;
+    double  d_trans_width;
+    double  d_cw_offset;
+
+    std::vector<gr_complex> d_chan;     /*! Channel samples. */
+    std::vector<gr_complex> d_tmp;      /*! Scratch buffer. */
+
+    /* squelch */
+    rx_sql_cc_sptr          d_sql;      /*! Squelch with pre-roll. */
+    std::vector<gr_complex> d_sql_buf;  /*! Squelch input incl. pre-roll. */
+    bool                    d_sql_open; /*! Squelch was open in last call. */
+
+    /* demodulators */
+    int         d_demod;
+    float       d_max_dev;          /*! FM max deviation. */
+    double      d_tau;              /*! FM de-emphasis time constant. */
+    float       d_deemph_b0;        /*! De-emphasis coefficients. */
+    float       d_deemph_b1;
+    float       d_deemph_p1;
+    float       d_deemph_x1;        /*! De-emphasis state. */
+    float       d_deemph_y1;
+    gr_complex  d_fm_last;          /*! Last sample for the FM discriminator. */
+    bool        d_dcr;              /*! AM DC removal enabled. */
+    float       d_dcr_x1;           /*! DC removal state. */
+    float       d_dcr_y1;
+
+    /* audio resampler */
+    gr::filter::kernel::pfb_arb_resampler_fff *d_audio_rr0;
+    gr::filter::kernel::pfb_arb_resampler_fff *d_audio_rr1;
+    std::vector<float>  d_audio0;   /*! Audio incl. resampler history. */
+    std::vector<float>  d_audio1;
+    int                 d_audio_len;    /*! Samples in d_audio0 and d_audio1. */
+    int                 d_audio_hist;   /*! History needed by the audio resampler. */
+};
+
+#endif /* RX_CHANNEL_STRIP_H */
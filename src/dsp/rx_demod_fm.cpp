@@ -20,7 +20,6 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
-#include <gnuradio/filter/firdes.h>
 #include <gnuradio/io_signature.h>
 #include <iostream>
 #include <math.h>
@@ -29,9 +28,11 @@
 
 
 /* Create a new instance of rx_demod_fm and return a boost shared_ptr. */
-rx_demod_fm_sptr make_rx_demod_fm(float quad_rate, float max_dev, double tau)
+rx_demod_fm_sptr make_rx_demod_fm(float quad_rate, float max_dev, double tau,
+                                  bool precise)
 {
-    return gnuradio::get_initial_sptr(new rx_demod_fm(quad_rate, max_dev, tau));
+    return gnuradio::get_initial_sptr(new rx_demod_fm(quad_rate, max_dev, tau,
+                                                      precise));
 }
 
 static const int MIN_IN = 1;  /* Mininum number of input streams. */
@@ -39,32 +40,25 @@ static const int MAX_IN = 1;  /* Maximum number of input streams. */
 static const int MIN_OUT = 1; /* Minimum number of output streams. */
 static const int MAX_OUT = 1; /* Maximum number of output streams. */
 
-rx_demod_fm::rx_demod_fm(float quad_rate, float max_dev, double tau)
+rx_demod_fm::rx_demod_fm(float quad_rate, float max_dev, double tau,
+                         bool precise)
     : gr::hier_block2 ("rx_demod_fm",
                       gr::io_signature::make (MIN_IN, MAX_IN, sizeof (gr_complex)),
                       gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
     d_quad_rate(quad_rate),
     d_max_dev(max_dev)
 {
-    float gain;
-
-    /* demodulator gain */
-    gain = d_quad_rate / (2.0 * M_PI * d_max_dev);
-
 #ifndef QT_NO_DEBUG_OUTPUT
-    std::cerr << "FM demod gain: " << gain << std::endl;
+    std::cerr << "FM demod gain: " << d_quad_rate / (2.0 * M_PI * d_max_dev)
+              << std::endl;
 #endif
 
-    /* demodulator */
-    d_quad = gr::analog::quadrature_demod_cf::make(gain);
-
-    /* de-emphasis */
-    d_deemph = make_fm_deemph(d_quad_rate, tau);
+    /* demodulator and de-emphasis */
+    d_disc = make_fm_discriminator_cf(d_quad_rate, d_max_dev, tau, precise);
 
     /* connect block */
-    connect(self(), 0, d_quad, 0);
-    connect(d_quad, 0, d_deemph, 0);
-    connect(d_deemph, 0, self(), 0);
+    connect(self(), 0, d_disc, 0);
+    connect(d_disc, 0, self(), 0);
 
 }
 
@@ -82,17 +76,13 @@ rx_demod_fm::~rx_demod_fm ()
  */
 void rx_demod_fm::set_max_dev(float max_dev)
 {
-    float gain;
-
     if ((max_dev < 500.0) || (max_dev > d_quad_rate/2.0))
     {
         return;
     }
 
     d_max_dev = max_dev;
-
-    gain = d_quad_rate / (2.0 * M_PI * max_dev);
-    d_quad->set_gain(gain);
+    d_disc->set_max_dev(max_dev);
 }
 
 /*! \brief Set FM de-emphasis time constant.
@@ -100,5 +90,13 @@ void rx_demod_fm::set_max_dev(float max_dev)
  */
 void rx_demod_fm::set_tau(double tau)
 {
-    d_deemph->set_tau(tau);
+    d_disc->set_tau(tau);
+}
+
+/*! \brief Select the precise or the fast arctangent.
+ *  \param precise True selects the precise arctangent.
+ */
+void rx_demod_fm::set_precise(bool precise)
+{
+    d_disc->set_precise(precise);
 }
@@ -22,10 +22,8 @@
  */
 #pragma once
 
-#include <gnuradio/analog/quadrature_demod_cf.h>
 #include <gnuradio/hier_block2.h>
-#include <vector>
-#include "dsp/fm_deemph.h"
+#include "dsp/fm_discriminator.h"
 
 class rx_demod_fm;
 typedef boost::shared_ptr<rx_demod_fm> rx_demod_fm_sptr;
@@ -34,17 +32,19 @@ typedef boost::shared_ptr<rx_demod_fm> rx_demod_fm_sptr;
  *  \param quad_rate The input sample rate.
  *  \param max_dev Maximum deviation in Hz
  *  \param tau De-emphasis time constant in seconds (75us in US, 50us in EUR, 0.0 disables).
+ *  \param precise Use the precise arctangent in the discriminator.
  *
  * This is effectively the public constructor. To avoid accidental use
  * of raw pointers, rx_demod_fm's constructor is private.
  * make_rx_dmod_fm is the public interface for creating new instances.
  */
-rx_demod_fm_sptr make_rx_demod_fm(float quad_rate, float max_dev=5000.0, double tau=50.0e-6);
+rx_demod_fm_sptr make_rx_demod_fm(float quad_rate, float max_dev=5000.0,
+                                  double tau=50.0e-6, bool precise=false);
 
 /*! \brief FM demodulator.
  *  \ingroup DSP
  *
- * This class implements the FM demodulator using the gr_quadrature_demod block.
+ * This class implements the FM demodulator using the fm_discriminator_cf block.
  * It also provides de-emphasis with variable time constant (use 0.0 to disable).
  *
  */
@@ -52,17 +52,16 @@ class rx_demod_fm : public gr::hier_block2
 {
 
 public:
-    rx_demod_fm(float quad_rate, float max_dev, double tau); // FIXME: should be private
+    rx_demod_fm(float quad_rate, float max_dev, double tau, bool precise); // FIXME: should be private
     ~rx_demod_fm();
 
     void set_max_dev(float max_dev);
     void set_tau(double tau);
+    void set_precise(bool precise);
 
 private:
     /* GR blocks */
-    gr::analog::quadrature_demod_cf::sptr   d_quad;      /*! The quadrature demodulator block. */
-    fm_deemph_sptr                          d_deemph;    /*! De-emphasis IIR filter. */
-    std::vector<float>            d_taps;      /*! Taps for the PFB resampler. */
+    fm_discriminator_cf_sptr    d_disc;     /*! Discriminator with de-emphasis. */
 
     /* other parameters */
     float       d_quad_rate;     /*! Quadrature rate. */
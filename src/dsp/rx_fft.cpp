@@ -26,6 +26,7 @@
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/fft/fft.h>
 #include "dsp/rx_fft.h"
+#include "dsp/rx_sql.h"
 #include <algorithm>
 
 
@@ -238,7 +239,9 @@ rx_fft_f::rx_fft_f(unsigned int fftsize, double audio_rate, int wintype)
           gr::io_signature::make(0, 0, 0)),
       d_fftsize(fftsize),
       d_audiorate(audio_rate),
-      d_wintype(-1)
+      d_wintype(-1),
+      d_sql_open(true),
+      d_muted(0)
 {
 
     /* create FFT object */
@@ -247,6 +250,9 @@ rx_fft_f::rx_fft_f(unsigned int fftsize, double audio_rate, int wintype)
     /* allocate circular buffer */
     d_cbuf.set_capacity(d_fftsize + d_audiorate);
 
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+
     /* create FFT window */
     set_window_type(wintype);
 }
@@ -264,25 +270,71 @@ rx_fft_f::~rx_fft_f()
  * This method does nothing except throwing the incoming samples into the
  * circular buffer.
  * FFT is only executed when the GUI asks for new FFT data via get_fft_data().
+ *
+ * Samples muted by the squelch (see rx_sql_cc) are dropped once a full FFT
+ * of silence has been buffered, get_fft_data() then returns a zero spectrum.
  */
 int rx_fft_f::work(int noutput_items,
                    gr_vector_const_void_star &input_items,
                    gr_vector_void_star &output_items)
 {
-    int i;
+    int i = 0;
     const float *in = (const float*)input_items[0];
+    uint64_t start = nitems_read(0);
     (void) output_items;
 
+    get_tags_in_range(d_tags, 0, start, start + noutput_items);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
     /* just throw new samples into the buffer */
     boost::mutex::scoped_lock lock(d_mutex);
-    for (i = 0; i < noutput_items; i++)
+    for (size_t t = 0; t < d_tags.size(); t++)
     {
-        d_cbuf.push_back(in[i]);
+        int pos = (int)(d_tags[t].offset - start);
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+        {
+            push_samples(in + i, pos - i);
+            i = pos;
+            d_sql_open = true;
+            d_muted = 0;
+        }
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+        {
+            push_samples(in + i, pos - i);
+            i = pos;
+            d_sql_open = false;
+        }
     }
+    push_samples(in + i, noutput_items - i);
 
     return noutput_items;
 }
 
+/*! \brief Add samples to the circular buffer.
+ *
+ * Note that this function does not lock the mutex since the caller, work()
+ * has already locked it.
+ */
+void rx_fft_f::push_samples(const float *in, int nitems)
+{
+    int i;
+
+    if (!d_sql_open)
+    {
+        /* muted input is zero, stop once the buffer is all silence */
+        if (d_muted >= d_fftsize)
+            return;
+        nitems = std::min(nitems, (int)(d_fftsize - d_muted));
+        d_muted += nitems;
+    }
+
+    for (i = 0; i < nitems; i++)
+    {
+        d_cbuf.push_back(in[i]);
+    }
+}
+
 /*! \brief Get FFT data.
  *  \param fftPoints Buffer to copy FFT data
  *  \param fftSize Current FFT size (output).
@@ -291,6 +343,17 @@ void rx_fft_f::get_fft_data(std::complex<float>* fftPoints, unsigned int &fftSiz
 {
     boost::mutex::scoped_lock lock(d_mutex);
 
+    if (d_muted >= d_fftsize)
+    {
+        // squelch closed, the spectrum of silence is zero
+        std::fill(fftPoints, fftPoints + d_fftsize, gr_complex(0.0f, 0.0f));
+        fftSize = d_fftsize;
+        d_cbuf.clear();
+        d_lasttime = std::chrono::steady_clock::now();
+
+        return;
+    }
+
     if (d_cbuf.size() < d_fftsize)
     {
         // not enough samples in the buffer
@@ -354,6 +417,7 @@ void rx_fft_f::set_fft_size(unsigned int fftsize)
         /* clear and resize circular buffer */
         d_cbuf.clear();
         d_cbuf.set_capacity(d_fftsize);
+        d_muted = 0;
 
         /* reset window */
         int wintype = d_wintype; // FIXME: would be nicer with a window_reset()
@@ -372,6 +436,25 @@ unsigned int rx_fft_f::get_fft_size() const
     return d_fftsize;
 }
 
+/*! \brief Set new audio sample rate.
+ *  \param audio_rate The new sample rate.
+ *
+ * The buffer holds one second of audio in addition to the FFT size. It is
+ * cleared since the old samples were taken at the old rate.
+ */
+void rx_fft_f::set_audio_rate(double audio_rate)
+{
+    if (audio_rate != d_audiorate)
+    {
+        boost::mutex::scoped_lock lock(d_mutex);
+
+        d_audiorate = audio_rate;
+        d_cbuf.clear();
+        d_muted = 0;
+        d_cbuf.set_capacity(d_fftsize + d_audiorate);
+    }
+}
+
 /*! \brief Set new window type. */
 void rx_fft_f::set_window_type(int wintype)
 {
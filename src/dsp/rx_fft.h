@@ -29,7 +29,9 @@
 #include <gnuradio/gr_complex.h>
 #include <boost/thread/mutex.hpp>
 #include <boost/circular_buffer.hpp>
+#include <gnuradio/tags.h>
 #include <chrono>
+#include <vector>
 
 
 #define MAX_FFT_SIZE 1048576
@@ -152,6 +154,8 @@ public:
     void set_fft_size(unsigned int fftsize);
     unsigned int get_fft_size() const;
 
+    void set_audio_rate(double audio_rate);
+
 private:
     unsigned int d_fftsize;   /*! Current FFT size. */
     double       d_audiorate;
@@ -165,6 +169,13 @@ private:
     boost::circular_buffer<float> d_cbuf; /*! buffer to accumulate samples. */
     std::chrono::time_point<std::chrono::steady_clock> d_lasttime;
 
+    bool          d_sql_open;  /*! Squelch state from the input tags. */
+    unsigned int  d_muted;     /*! Muted samples buffered since the squelch closed. */
+    std::vector<gr::tag_t>  d_tags;
+    pmt::pmt_t    d_sob_key;
+    pmt::pmt_t    d_eob_key;
+
+    void push_samples(const float *in, int nitems);
     void do_fft(unsigned int size);
 
 };
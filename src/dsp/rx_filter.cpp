@@ -57,23 +57,34 @@ rx_filter::rx_filter(double sample_rate, double low, double high, double trans_w
         d_high = 0.95*sample_rate/2.0;
 
     /* generate taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate, d_low, d_high, d_trans_width);
+    filter_key key = { d_sample_rate, d_low, d_high, d_trans_width, 0.0 };
+    d_taps = *filter_designer::instance().get_taps(key);
 
     /* create band pass filter */
-    d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
-
-    /* connect filter */
-    connect(self(), 0, d_bpf, 0);
-    connect(d_bpf, 0, self(), 0);
+    d_use_fft = d_taps.size() > RX_FILTER_FFT_TAPS;
+    if (d_use_fft)
+    {
+        d_fft_bpf = gr::filter::fft_filter_ccc::make(1, d_taps);
+        connect(self(), 0, d_fft_bpf, 0);
+        connect(d_fft_bpf, 0, self(), 0);
+    }
+    else
+    {
+        d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
+        connect(self(), 0, d_bpf, 0);
+        connect(d_bpf, 0, self(), 0);
+    }
 }
 
 rx_filter::~rx_filter ()
 {
-
+    filter_designer::instance().cancel(this);
 }
 
 void rx_filter::set_param(double low, double high, double trans_width)
 {
+    bool same_size = (trans_width == d_trans_width);
+
     d_trans_width = trans_width;
     d_low         = low;
     d_high        = high;
@@ -83,19 +94,117 @@ void rx_filter::set_param(double low, double high, double trans_width)
     if (d_high > 0.95*d_sample_rate/2.0)
         d_high = 0.95*d_sample_rate/2.0;
 
-    /* generate new taps */
-    d_taps = gr::filter::firdes::complex_band_pass(1.0, d_sample_rate,
-                                                   d_low + d_cw_offset,
-                                                   d_high + d_cw_offset,
-                                                   d_trans_width);
+    /* use cached taps or generate new taps in the background */
+    filter_key key = { d_sample_rate, d_low, d_high, d_trans_width, d_cw_offset };
+    filter_designer &designer = filter_designer::instance();
+    filter_designer::taps_sptr taps = designer.find_taps(key);
 
-#ifndef QT_NO_DEBUG_OUTPUT
-    std::cout << "Generating taps for new filter   LO:" << d_low
-              << "   HI:" << d_high << " TW:" << d_trans_width
-              << "   Taps: " << d_taps.size() << std::endl;
-#endif
+    if (taps || !same_size)
+    {
+        // make sure an older request doesn't overwrite these taps
+        designer.cancel(this);
+        if (!taps)
+            taps = designer.get_taps(key);
+        apply_taps(taps, true);
+    }
+    else
+    {
+        designer.request_taps(this, key, [this](filter_designer::taps_sptr taps) {
+            apply_taps(taps, false);
+        });
+    }
+}
 
-    d_bpf->set_taps(d_taps);
+/*! \brief Design the taps of a filter that is likely to be used soon.
+ *
+ * The parameters are limited the same way as in set_param(), so that the
+ * taps are found in the cache when the filter is selected.
+ */
+void rx_filter::prefetch(double sample_rate, double low, double high,
+                         double trans_width, double offset)
+{
+    if (low < -0.95*sample_rate/2.0)
+        low = -0.95*sample_rate/2.0;
+    if (high > 0.95*sample_rate/2.0)
+        high = 0.95*sample_rate/2.0;
+
+    filter_key key = { sample_rate, low, high, trans_width, offset };
+    filter_designer::instance().prefetch(key);
+}
+
+/*! \brief Store new taps.
+ *  \param taps The new taps.
+ *  \param may_switch Whether the filter implementation may be changed.
+ *
+ * When called from the designer thread the flow graph must not be changed,
+ * so the taps are only set on the connected filter.
+ */
+void rx_filter::apply_taps(filter_designer::taps_sptr taps, bool may_switch)
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+
+    d_taps = *taps;
+    if (may_switch)
+        update_taps();
+    else if (d_use_fft)
+        d_fft_bpf->set_taps(d_taps);
+    else
+        d_bpf->set_taps(d_taps);
+}
+
+
+/*! \brief Apply new taps.
+ *
+ * The taps are applied to the current filter, which only updates its
+ * frequency response. If the number of taps moves more than
+ * RX_FILTER_FFT_HYST beyond RX_FILTER_FFT_TAPS the other implementation is
+ * connected instead.
+ */
+void rx_filter::update_taps()
+{
+    bool use_fft;
+
+    if (d_use_fft)
+        use_fft = d_taps.size() > RX_FILTER_FFT_TAPS - RX_FILTER_FFT_HYST;
+    else
+        use_fft = d_taps.size() > RX_FILTER_FFT_TAPS + RX_FILTER_FFT_HYST;
+
+    if (use_fft == d_use_fft)
+    {
+        if (d_use_fft)
+            d_fft_bpf->set_taps(d_taps);
+        else
+            d_bpf->set_taps(d_taps);
+        return;
+    }
+
+    lock();
+    if (use_fft)
+    {
+        if (d_fft_bpf)
+            d_fft_bpf->set_taps(d_taps);
+        else
+            d_fft_bpf = gr::filter::fft_filter_ccc::make(1, d_taps);
+
+        disconnect(self(), 0, d_bpf, 0);
+        disconnect(d_bpf, 0, self(), 0);
+        connect(self(), 0, d_fft_bpf, 0);
+        connect(d_fft_bpf, 0, self(), 0);
+    }
+    else
+    {
+        if (d_bpf)
+            d_bpf->set_taps(d_taps);
+        else
+            d_bpf = gr::filter::fir_filter_ccc::make(1, d_taps);
+
+        disconnect(self(), 0, d_fft_bpf, 0);
+        disconnect(d_fft_bpf, 0, self(), 0);
+        connect(self(), 0, d_bpf, 0);
+        connect(d_bpf, 0, self(), 0);
+    }
+    d_use_fft = use_fft;
+    unlock();
 }
 
 
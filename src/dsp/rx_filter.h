@@ -24,6 +24,9 @@
 #define RX_FILTER_H
 
 #include <gnuradio/hier_block2.h>
+#include <gnuradio/filter/fft_filter_ccc.h>
+#include <mutex>
+#include "dsp/filter_designer.h"
 
 #if GNURADIO_VERSION < 0x030800
 #include <gnuradio/filter/fir_filter_ccc.h>
@@ -35,6 +38,8 @@
 
 
 #define RX_FILTER_MIN_WIDTH 100  /*! Minimum width of filter */
+#define RX_FILTER_FFT_TAPS  64   /*! Use FFT filter above this number of taps */
+#define RX_FILTER_FFT_HYST  16   /*! Hysteresis around RX_FILTER_FFT_TAPS */
 
 class rx_filter;
 class rx_xlating_filter;
@@ -69,6 +74,20 @@ rx_filter_sptr make_rx_filter(double sample_rate,
  * performed by the accessors (though the taps generator from gr::filter::firdes does perform
  * some sanity checks and throws std::out_of_range in case of bad parameter).
  *
+ * Filters with more than RX_FILTER_FFT_TAPS taps are implemented using an
+ * overlap-save FFT filter, shorter filters use a direct form FIR filter. The
+ * implementation is switched automatically when the number of taps moves
+ * more than RX_FILTER_FFT_HYST away from the limit, so that dragging the
+ * filter edges around the limit doesn't keep reconfiguring the flow graph.
+ * Otherwise new taps only update the existing filter.
+ *
+ * The taps are provided by the filter_designer. If the new filter is not in
+ * its cache and has the same number of taps as the current one (the number
+ * of taps only depends on the sample rate and the transition width),
+ * set_param() returns immediately and the taps are set from the designer
+ * thread when they are ready. Otherwise the taps are applied in the calling
+ * thread, which is the only one changing the flow graph.
+ *
  * \note In order to have proper LSB/USB, we must exchange low and high and reverse their sign
  */
 class rx_filter : public gr::hier_block2
@@ -81,9 +100,18 @@ public:
     void set_param(double low, double high, double trans_width);
     void set_cw_offset(double offset);
 
+    static void prefetch(double sample_rate, double low, double high,
+                         double trans_width, double offset);
+
 private:
+    void apply_taps(filter_designer::taps_sptr taps, bool may_switch);
+    void update_taps();
+
+    std::mutex d_mutex;     /*! Protects the filters while new taps are applied. */
     std::vector<gr_complex> d_taps;
     gr::filter::fir_filter_ccc::sptr  d_bpf;
+    gr::filter::fft_filter_ccc::sptr  d_fft_bpf;
+    bool   d_use_fft;   /*! FFT filter is connected. */
 
     double d_sample_rate;
     double d_low;
@@ -21,28 +21,37 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <algorithm>
+#include <chrono>
 #include <gnuradio/io_signature.h>
+#include <volk/volk.h>
 #include <dsp/rx_meter.h>
 #include <iostream>
 
+/* Maximum number of samples processed at once. */
+#define METER_CHUNK 4096
 
-rx_meter_c_sptr make_rx_meter_c (int detector)
+
+rx_meter_c_sptr make_rx_meter_c (int detector, double sample_rate)
 {
-    return gnuradio::get_initial_sptr(new rx_meter_c (detector));
+    return gnuradio::get_initial_sptr(new rx_meter_c (detector, sample_rate));
 }
 
-rx_meter_c::rx_meter_c(int detector)
+rx_meter_c::rx_meter_c(int detector, double sample_rate)
     : gr::sync_block ("rx_meter_c",
           gr::io_signature::make(1, 1, sizeof(gr_complex)),
           gr::io_signature::make(0, 0, 0)),
       d_detector(detector),
-      d_level(0.0),
-      d_level_db(0.0),
-      d_sum(0.0),
-      d_sumsq(0.0),
-      d_num(0)
+      d_sample_rate(sample_rate),
+      d_int_time(0.0),
+      d_window(0),
+      d_reset(false),
+      d_seq(0)
 {
-
+    d_pwr.resize(METER_CHUNK);
+    d_mag.resize(METER_CHUNK);
+    d_stats = rx_meter_stats();
+    reset_stats();
 }
 
 rx_meter_c::~rx_meter_c()
@@ -50,8 +59,6 @@ rx_meter_c::~rx_meter_c()
 }
 
 
-#define ALPHA 0.4
-
 int rx_meter_c::work (int noutput_items,
                       gr_vector_const_void_star &input_items,
                       gr_vector_void_star &output_items)
@@ -59,99 +66,143 @@ int rx_meter_c::work (int noutput_items,
     (void) output_items; // unused
 
     const gr_complex *in = (const gr_complex *) input_items[0];
-    float pwr = 0.0;
-    int   i = 0;
 
-    if (d_num == 0)
+    process(in, noutput_items);
+
+    return noutput_items;
+}
+
+void rx_meter_c::process(const gr_complex *in, int nitems)
+{
+    uint64_t window = d_window;
+    uint32_t idx;
+    float    sum;
+    int      i, n;
+
+    if (d_reset.exchange(false))
+        reset_stats();
+
+    for (i = 0; i < nitems; i += n)
     {
-        // first sample after a reset
-        d_level = in[0].real()*in[0].real() + in[0].imag()*in[0].imag();
-        d_sum = d_level;
-        d_sumsq = d_level*d_level;
-        i = 1;
+        n = std::min(nitems - i, METER_CHUNK);
+        if (window > 0)
+            n = (int)std::min<uint64_t>(n, window - d_num);
+
+        volk_32fc_magnitude_squared_32f(&d_pwr[0], in + i, n);
+
+        if (d_num == 0)
+        {
+            d_sample = d_pwr[0];
+            d_min = d_pwr[0];
+            d_peak = d_pwr[0];
+        }
+
+        volk_32f_index_max_32u(&idx, &d_pwr[0], n);
+        d_peak = std::max(d_peak, d_pwr[idx]);
+        d_min = std::min(d_min, *std::min_element(d_pwr.begin(), d_pwr.begin() + n));
+
+        volk_32f_accumulator_s32f(&sum, &d_pwr[0], n);
+        d_sum += sum;
+
+        volk_32f_sqrt_32f(&d_mag[0], &d_pwr[0], n);
+        volk_32f_accumulator_s32f(&sum, &d_mag[0], n);
+        d_sum_mag += sum;
+
+        d_num += n;
+
+        if (window > 0 && d_num >= window)
+        {
+            publish_stats();
+            reset_stats();
+        }
     }
 
-    d_num += noutput_items;
+    if (window == 0)
+        publish_stats();
+}
+
+/*! \brief Copy the current statistics to the snapshot. */
+void rx_meter_c::publish_stats()
+{
+    unsigned seq = d_seq.load(std::memory_order_relaxed);
+    double   mean_mag = d_num ? d_sum_mag / (double)d_num : 0.0;
+    double   mean_pwr = d_num ? d_sum / (double)d_num : 0.0;
+
+    d_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    d_stats.sample = d_sample;
+    d_stats.min = d_min;
+    d_stats.peak = d_peak;
+    d_stats.avg = mean_pwr;
+    d_stats.rms = mean_pwr;
+    d_stats.mag_avg = mean_mag * mean_mag;
+    d_stats.num_samples = d_num;
+    d_stats.timestamp = std::chrono::duration<double>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+    d_seq.store(seq + 2, std::memory_order_release);
+}
+
+void rx_meter_c::get_stats(rx_meter_stats &stats) const
+{
+    unsigned seq1, seq2;
+
+    do {
+        seq1 = d_seq.load(std::memory_order_acquire);
+        stats = d_stats;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = d_seq.load(std::memory_order_relaxed);
+    } while ((seq1 & 1) || (seq1 != seq2));
+}
+
+float rx_meter_c::get_level()
+{
+    rx_meter_stats stats;
+    float          level;
+
+    get_stats(stats);
 
     // processing depends on detector type
     switch (d_detector)
     {
     case DETECTOR_TYPE_SAMPLE:
-        // just take the first sample
-        d_level = in[0].real()*in[0].real() + in[0].imag()*in[0].imag();
+        level = stats.sample;
         break;
 
     case DETECTOR_TYPE_MIN:
-        // minimum peak
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            if (pwr < d_level)
-                d_level = pwr;
-            i++;
-        }
+        level = stats.min;
         break;
 
     case DETECTOR_TYPE_MAX:
-        // maximum peak
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            if (pwr > d_level)
-                d_level = pwr;
-            i++;
-        }
+        level = stats.peak;
         break;
 
     case DETECTOR_TYPE_AVG:
-        // mean value
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            d_sum += pwr;
-            i++;
-        }
-        d_level = d_sum / (float)(d_num);
+        level = stats.avg;
         break;
 
     case DETECTOR_TYPE_RMS:
-        // root mean square
-        while (i < noutput_items)
-        {
-            pwr = in[i].real()*in[i].real() + in[i].imag()*in[i].imag();
-            d_sumsq += pwr*pwr;
-            i++;
-        }
-        d_level = sqrt(d_sumsq / (float)(d_num));
+        level = stats.rms;
         break;
 
     default:
         std::cout << "Invalid detector type: " << d_detector << std::endl;
         std::cout << "Fallback to DETECTOR_TYPE_RMS." << std::endl;
         d_detector = DETECTOR_TYPE_RMS;
+        level = stats.rms;
         break;
     }
 
-    d_level_db = (float) 10. * log10f(d_level + 1.0e-20);
+    if (d_window == 0)
+        d_reset = true;
 
-    return noutput_items;
-}
-
-
-float rx_meter_c::get_level()
-{
-    float retval = d_level;
-    reset_stats();
-
-    return retval;
+    return level;
 }
 
 float rx_meter_c::get_level_db()
 {
-    float retval = d_level_db;
-    reset_stats();
-
-    return retval;
+    return (float) 10. * log10f(get_level() + 1.0e-20);
 }
 
 
@@ -161,15 +212,29 @@ void rx_meter_c::set_detector_type(int detector)
         return;
 
     d_detector = detector;
-    reset_stats();
+    d_reset = true;
+}
+
+void rx_meter_c::set_integration_time(double seconds)
+{
+    d_int_time = std::max(0.0, seconds);
+    d_window = (uint64_t)(d_int_time * d_sample_rate);
+    d_reset = true;
+}
+
+void rx_meter_c::set_sample_rate(double sample_rate)
+{
+    d_sample_rate = sample_rate;
+    set_integration_time(d_int_time);
 }
 
 /*! \brief Reset statistics. */
 void rx_meter_c::reset_stats()
 {
-    //d_level = 0.0;
-    d_level_db = 0.0;
     d_sum = 0.0;
-    d_sumsq = 0.0;
+    d_sum_mag = 0.0;
+    d_sample = 0.0;
+    d_min = 0.0;
+    d_peak = 0.0;
     d_num = 0;
 }
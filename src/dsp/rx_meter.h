@@ -24,6 +24,9 @@
 #define RX_METER_H
 
 #include <gnuradio/sync_block.h>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
 
 enum detector_type_e {
     DETECTOR_TYPE_NONE   = 0,
@@ -35,6 +38,24 @@ enum detector_type_e {
 };
 
 
+/*! \brief Signal levels measured over one integration window.
+ *
+ * All levels are power values in the range 0.0 to 1.0 (FS = 1.0) so that
+ * they can be converted to dBFS using 10*log10().
+ */
+struct rx_meter_stats
+{
+    float       sample;         /*!< Power of the first sample. */
+    float       min;            /*!< Minimum power. */
+    float       peak;           /*!< Maximum power. */
+    float       avg;            /*!< Mean power. */
+    float       rms;            /*!< Mean power (RMS level squared). */
+    float       mag_avg;        /*!< Power of the average magnitude. */
+    double      timestamp;      /*!< Time of the last sample (seconds since the epoch). */
+    uint64_t    num_samples;    /*!< Number of samples in the window. */
+};
+
+
 class rx_meter_c;
 
 typedef boost::shared_ptr<rx_meter_c> rx_meter_c_sptr;
@@ -42,28 +63,39 @@ typedef boost::shared_ptr<rx_meter_c> rx_meter_c_sptr;
 
 /*! \brief Return a shared_ptr to a new instance of rx_meter_c.
  *  \param detector Detector type.
+ *  \param sample_rate The sample rate of the input.
  *
  * This is effectively the public constructor. To avoid accidental use
  * of raw pointers, the rx_meter_c constructor is private.
  * make_rxfilter is the public interface for creating new instances.
  */
-rx_meter_c_sptr make_rx_meter_c(int detector=DETECTOR_TYPE_RMS);
+rx_meter_c_sptr make_rx_meter_c(int detector=DETECTOR_TYPE_RMS,
+                                double sample_rate=96000.0);
 
 
 /*! \brief Block for measuring signal strength (complex input).
  *  \ingroup DSP
  *
  * This block can be used to meausre the received signal strength.
- * For each group of samples received this block stores the maximum power level,
- * which then can be retrieved using the get_level() and get_level_db()
- * methods.
+ * All detectors are calculated at once using volk and the results are
+ * published as an rx_meter_stats snapshot, which can be read from any thread
+ * using get_stats(). The get_level() and get_level_db() methods return the
+ * level of the selected detector.
+ *
+ * If the integration time is 0 the statistics are collected until the level
+ * is read using get_level() or get_level_db() and the snapshot is updated
+ * after each work() call. Otherwise the snapshot is updated at the end of
+ * each integration window and readers do not affect each other.
+ *
+ * The snapshot is protected by a sequence counter so the streaming thread
+ * never has to wait for a reader.
  */
 class rx_meter_c : public gr::sync_block
 {
-    friend rx_meter_c_sptr make_rx_meter_c(int detector);
+    friend rx_meter_c_sptr make_rx_meter_c(int detector, double sample_rate);
 
 protected:
-    rx_meter_c(int detector=DETECTOR_TYPE_RMS);
+    rx_meter_c(int detector=DETECTOR_TYPE_RMS, double sample_rate=96000.0);
 
 public:
     ~rx_meter_c();
@@ -72,12 +104,18 @@ public:
              gr_vector_const_void_star &input_items,
              gr_vector_void_star &output_items);
 
+    /*! \brief Measure a buffer of samples. */
+    void process(const gr_complex *in, int nitems);
+
     /*! \brief Get the current signal level. */
     float get_level();
 
     /*! \brief Get the current signal level in dBFS. */
     float get_level_db();
 
+    /*! \brief Get the latest statistics. */
+    void get_stats(rx_meter_stats &stats) const;
+
     /*! \brief Enable or disable averaging.
      *  \param detector Detector type.
      */
@@ -88,14 +126,36 @@ public:
      */
     int get_detector_type() {return d_detector;}
 
+    /*! \brief Set the integration time.
+     *  \param seconds The integration time in seconds, 0 to integrate until
+     *                 the level is read.
+     */
+    void set_integration_time(double seconds);
+    double get_integration_time() const { return d_int_time; }
+
+    void set_sample_rate(double sample_rate);
+
 private:
     int    d_detector;  /*! Detector type. */
-    float  d_level;     /*! The current level in the range 0.0 to 1.0 */
-    float  d_level_db;  /*! The current level in dBFS with FS = 1.0 */
-    float  d_sum;       /*! Sum of msamples. */
-    float  d_sumsq;     /*! Sum of samples squared. */
-    int    d_num;       /*! Number of samples in d_sum and d_sumsq. */
+    double d_sample_rate;   /*! Input sample rate. */
+    double d_int_time;  /*! Integration time in seconds (0 = until read). */
+    std::atomic<uint64_t> d_window; /*! Integration window in samples. */
+
+    double   d_sum;     /*! Sum of power. */
+    double   d_sum_mag; /*! Sum of magnitudes. */
+    float    d_sample;  /*! First power sample. */
+    float    d_min;     /*! Minimum power. */
+    float    d_peak;    /*! Maximum power. */
+    uint64_t d_num;     /*! Number of samples in the statistics. */
+
+    std::vector<float>  d_pwr;  /*! Power of the current chunk. */
+    std::vector<float>  d_mag;  /*! Magnitude of the current chunk. */
+
+    std::atomic<bool>       d_reset;    /*! Reset requested by a reader. */
+    std::atomic<unsigned>   d_seq;      /*! Snapshot sequence counter, odd while writing. */
+    rx_meter_stats          d_stats;    /*! The latest snapshot. */
 
+    void publish_stats();
     void reset_stats();
 };
 
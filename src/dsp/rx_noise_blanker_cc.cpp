@@ -22,10 +22,31 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <math.h>
+#include <algorithm>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/gr_complex.h>
+#include <volk/volk.h>
 #include "dsp/rx_noise_blanker_cc.h"
 
+/* Number of samples processed at once. */
+#define NB_CHUNK        1024
+
+/* Number of samples checked against the threshold at once. */
+#define NB_BLOCK        64
+
+/* Time constant of the magnitude averages (0.999 at 96 ksps). */
+#define NB_AVG_TC_US    10400.0
+
+/* NB1 delay, i.e. the time blanked before a detected pulse. */
+#define NB1_DELAY_US    20.0
+
+/* Default NB1 blanking window including the delay. */
+#define NB1_BLANK_US    75.0
+
+/* Time constant of the NB2 signal average (0.75/0.25 at 96 ksps). */
+#define NB2_SIG_TC_US   36.0
+
+
 rx_nb_cc_sptr make_rx_nb_cc(double sample_rate, float thld1, float thld2)
 {
     return gnuradio::get_initial_sptr(new rx_nb_cc(sample_rate, thld1, thld2));
@@ -45,13 +66,13 @@ rx_nb_cc::rx_nb_cc(double sample_rate, float thld1, float thld2)
       d_sample_rate(sample_rate),
       d_thld_nb1(thld1),
       d_thld_nb2(thld2),
+      d_blank_us(NB1_BLANK_US),
       d_avgmag_nb1(1.0),
       d_avgmag_nb2(1.0),
-      d_delidx(2),
-      d_sigidx(0),
+      d_avgsig(0.0, 0.0),
       d_hangtime(0)
 {
-    memset(d_delay, 0, 8 * sizeof(gr_complex));
+    update_params();
 }
 
 rx_nb_cc::~rx_nb_cc()
@@ -70,89 +91,190 @@ int rx_nb_cc::work(int noutput_items,
 {
     const gr_complex *in = (const gr_complex *) input_items[0];
     gr_complex *out = (gr_complex *) output_items[0];
-    int i;
+
+    process(in, out, noutput_items);
+
+    return noutput_items;
+}
+
+/*! \brief Run the noise blankers on a buffer.
+ *  \param in The input samples.
+ *  \param out The output buffer.
+ *  \param nitems The number of samples.
+ *
+ * This is used by work() and by blocks that embed the noise blanker.
+ */
+void rx_nb_cc::process(const gr_complex *in, gr_complex *out, int nitems)
+{
+    int i, num;
 
     boost::mutex::scoped_lock lock(d_mutex);
 
-    // copy data into output buffer then perform the processing on that buffer
-    for (i = 0; i < noutput_items; i++)
+    if (!d_nb1_on && !d_nb2_on)
     {
-        out[i] = in[i];
+        if (in != out)
+            std::copy(in, in + nitems, out);
+        return;
     }
 
-    if (d_nb1_on)
-    {
-        process_nb1(out, noutput_items);
-    }
-    if (d_nb2_on)
+    for (i = 0; i < nitems; i += num)
     {
-        process_nb2(out, noutput_items);
+        num = std::min(nitems - i, NB_CHUNK);
+
+        if (d_nb1_on)
+            process_nb1(in + i, out + i, num);
+        else if (in != out)
+            std::copy(in + i, in + i + num, out + i);
+
+        if (d_nb2_on)
+            process_nb2(out + i, num);
     }
+}
 
-    return noutput_items;
+/*! \brief Set new sample rate.
+ *  \param sample_rate The new sample rate.
+ *
+ * The time constants and buffer sizes are recalculated.
+ */
+void rx_nb_cc::set_sample_rate(double sample_rate)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_sample_rate = sample_rate;
+    update_params();
+}
+
+/*! \brief Convert the time constants to samples and resize the buffers. */
+void rx_nb_cc::update_params()
+{
+    double  fs = d_sample_rate;
+    int     k;
+
+    d_avg_alpha = 1.0 - exp(-1.0e6 / (fs * NB_AVG_TC_US));
+    d_sig_alpha = 1.0 - exp(-1.0e6 / (fs * NB2_SIG_TC_US));
+
+    d_blank_len = std::max(1, (int)lround(d_blank_us * 1.0e-6 * fs));
+    d_delay_len = (int)lround(NB1_DELAY_US * 1.0e-6 * fs);
+    d_delay_len = std::max(0, std::min(d_delay_len, d_blank_len - 1));
+    d_hangtime = 0;
+
+    d_delay.assign(d_delay_len + NB_CHUNK, gr_complex(0.0, 0.0));
+    d_mag.resize(NB_CHUNK);
+
+    // NB2 signal average over a block as a weighted sum of the samples
+    d_sig_taps.resize(NB_BLOCK);
+    for (k = 0; k < NB_BLOCK; k++)
+        d_sig_taps[k] = d_sig_alpha * powf(1.0 - d_sig_alpha, NB_BLOCK - 1 - k);
 }
 
 /*! \brief Perform noise blanker 1 processing.
- *  \param buf The data buffer holding gr_complex samples.
- *  \param num The number of samples in the buffer.
+ *  \param in The input samples.
+ *  \param out The output buffer.
+ *  \param num The number of samples, at most NB_CHUNK.
  *
  * Noise blanker 1 is the first noise blanker in the processing chain.
  * It is intended to reduce the effect of impulse type noise.
  *
- * FIXME: Needs different constants for higher sample rates?
+ * The output is delayed by d_delay_len samples. When a pulse is detected the
+ * next d_blank_len output samples are blanked, starting d_delay_len samples
+ * before the pulse.
  */
-void rx_nb_cc::process_nb1(gr_complex *buf, int num)
+void rx_nb_cc::process_nb1(const gr_complex *in, gr_complex *out, int num)
 {
-    float cmag;
-    gr_complex zero(0.0, 0.0);
+    gr_complex *buf = &d_delay[0];
+    gr_complex  zero(0.0, 0.0);
+    uint32_t    idx;
+    float       thld;
+    float       sum;
+    int         i, k, n;
 
-    for (int i = 0; i < num; i++)
-    {
-        cmag = abs(buf[i]);
-        d_delay[d_sigidx] = buf[i];
-        d_avgmag_nb1 = 0.999*d_avgmag_nb1 + 0.001*cmag;
+    // buf holds the last d_delay_len input samples followed by this chunk
+    std::copy(in, in + num, buf + d_delay_len);
+    volk_32fc_magnitude_32f(&d_mag[0], in, num);
 
-        if ((d_hangtime == 0) && (cmag > (d_thld_nb1*d_avgmag_nb1)))
-            d_hangtime = 7;
+    for (i = 0; i < num; i += n)
+    {
+        n = std::min(num - i, NB_BLOCK);
+        thld = d_thld_nb1 * d_avgmag_nb1;
 
-        if (d_hangtime > 0)
+        volk_32f_index_max_32u(&idx, &d_mag[i], n);
+        if ((d_hangtime == 0) && (d_mag[i + idx] <= thld))
         {
-            buf[i] = zero;
-            d_hangtime--;
+            std::copy(buf + i, buf + i + n, out + i);
         }
         else
         {
-            buf[i] = d_delay[d_delidx];
+            for (k = i; k < i + n; k++)
+            {
+                if ((d_hangtime == 0) && (d_mag[k] > thld))
+                    d_hangtime = d_blank_len;
+
+                if (d_hangtime > 0)
+                {
+                    out[k] = zero;
+                    d_hangtime--;
+                }
+                else
+                {
+                    out[k] = buf[k];
+                }
+            }
         }
 
-        d_sigidx = (d_sigidx + 7) & 7;
-        d_delidx = (d_delidx + 7) & 7;
+        volk_32f_accumulator_s32f(&sum, &d_mag[i], n);
+        d_avgmag_nb1 += (1.0 - powf(1.0 - d_avg_alpha, n)) *
+                        (sum / (float)n - d_avgmag_nb1);
     }
+
+    // keep the end of the chunk for the next call
+    std::copy(buf + num, buf + num + d_delay_len, buf);
 }
 
 /*! \brief Perform noise blanker 2 processing.
  *  \param buf The data buffer holding gr_complex samples.
- *  \param num The number of samples in the buffer.
+ *  \param num The number of samples in the buffer, at most NB_CHUNK.
  *
  * Noise blanker 2 is the second noise blanker in the processing chain.
  * It is intended to reduce non-pulse type noise (i.e. longer time constants).
+ * Samples above the threshold are replaced by the signal average.
  *
- * FIXME: Needs different constants for higher sample rates?
+ * Blocks without any sample above the threshold only need the signal average
+ * at the end of the block, which is calculated as a dot product.
  */
 void rx_nb_cc::process_nb2(gr_complex *buf, int num)
 {
-    float cmag;
-    gr_complex c1(0.75);
-    gr_complex c2(0.25);
+    gr_complex  dot;
+    uint32_t    idx;
+    float       thld;
+    float       sum;
+    int         i, k, n;
+
+    volk_32fc_magnitude_32f(&d_mag[0], buf, num);
 
-    for (int i = 0; i < num; i++)
+    for (i = 0; i < num; i += n)
     {
-        cmag = abs(buf[i]);
-        d_avgsig = c1*d_avgsig + c2*buf[i];
-        d_avgmag_nb2 = 0.999*d_avgmag_nb2 + 0.001*cmag;
+        n = std::min(num - i, NB_BLOCK);
+        thld = d_thld_nb2 * d_avgmag_nb2;
 
-        if (cmag > d_thld_nb2*d_avgmag_nb2)
-            buf[i] = d_avgsig;
+        volk_32f_index_max_32u(&idx, &d_mag[i], n);
+        if (d_mag[i + idx] <= thld)
+        {
+            volk_32fc_32f_dot_prod_32fc(&dot, buf + i, &d_sig_taps[NB_BLOCK - n], n);
+            d_avgsig = d_avgsig * powf(1.0 - d_sig_alpha, n) + dot;
+        }
+        else
+        {
+            for (k = i; k < i + n; k++)
+            {
+                d_avgsig = (1.0f - d_sig_alpha) * d_avgsig + d_sig_alpha * buf[k];
+                if (d_mag[k] > thld)
+                    buf[k] = d_avgsig;
+            }
+        }
+
+        volk_32f_accumulator_s32f(&sum, &d_mag[i], n);
+        d_avgmag_nb2 += (1.0 - powf(1.0 - d_avg_alpha, n)) *
+                        (sum / (float)n - d_avgmag_nb2);
     }
 }
 
@@ -167,3 +289,17 @@ void rx_nb_cc::set_threshold2(float threshold)
     if ((threshold >= 0.0) && (threshold <= 15.0))
         d_thld_nb2 = threshold;
 }
+
+/*! \brief Set the NB1 blanking window.
+ *  \param blank_us The blanking window in microseconds (10 to 1000).
+ */
+void rx_nb_cc::set_blank_time(float blank_us)
+{
+    if ((blank_us < 10.0) || (blank_us > 1000.0))
+        return;
+
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    d_blank_us = blank_us;
+    update_params();
+}
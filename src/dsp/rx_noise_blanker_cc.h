@@ -26,6 +26,7 @@
 #include <gnuradio/sync_block.h>
 #include <gnuradio/gr_complex.h>
 #include <boost/thread/mutex.hpp>
+#include <vector>
 
 class rx_nb_cc;
 
@@ -48,8 +49,15 @@ rx_nb_cc_sptr make_rx_nb_cc(double sample_rate=96000.0, float thld1=3.3, float t
  *
  * This block implements noise blanking filters based on the noise blanker code
  * from DTTSP.
-
  *
+ * All time constants are given in microseconds and converted to samples when
+ * the sample rate is set, so the blankers behave the same at any channel rate.
+ * NB1 delays the signal so that the samples just before a detected pulse are
+ * blanked as well. The blanking window is configurable.
+ *
+ * The samples are processed in small blocks. The magnitudes are calculated
+ * with volk and each block is first checked against the threshold; the
+ * per-sample code only runs for blocks that contain a pulse.
  */
 class rx_nb_cc : public gr::sync_block
 {
@@ -65,16 +73,22 @@ public:
              gr_vector_const_void_star &input_items,
              gr_vector_void_star &output_items);
 
-    void set_sample_rate(double sample_rate) { d_sample_rate = sample_rate; }
+    void process(const gr_complex *in, gr_complex *out, int nitems);
+
+    void set_sample_rate(double sample_rate);
+    double get_sample_rate() const { return d_sample_rate; }
     void set_nb1_on(bool nb1_on) { d_nb1_on = nb1_on; }
     void set_nb2_on(bool nb2_on) { d_nb2_on = nb2_on; }
     bool get_nb1_on() { return d_nb1_on; }
     bool get_nb2_on() { return d_nb2_on; }
     void set_threshold1(float threshold);
     void set_threshold2(float threshold);
+    void set_blank_time(float blank_us);
+    float get_blank_time() const { return d_blank_us; }
 
 private:
-    void process_nb1(gr_complex *buf, int num);
+    void update_params();
+    void process_nb1(const gr_complex *in, gr_complex *out, int num);
     void process_nb2(gr_complex *buf, int num);
 
 private:
@@ -85,11 +99,20 @@ private:
     double d_sample_rate;   /*! Current sample rate. */
     float  d_thld_nb1;      /*! Current threshold for noise blanker 1 (1.0 to 20.0 TBC). */
     float  d_thld_nb2;      /*! Current threshold for noise blanker 2 (0.0 to 15.0 TBC). */
+    float  d_blank_us;      /*! NB1 blanking window in microseconds. */
     float  d_avgmag_nb1;    /*! Average magnitude. */
     float  d_avgmag_nb2;    /*! Average magnitude. */
-    gr_complex d_avgsig, d_delay[8];
-    int    d_delidx, d_sigidx, d_hangtime;   // FIXME: need longer buffer for higher sampel rates?
+    float  d_avg_alpha;     /*! Coefficient of the magnitude averages. */
+    float  d_sig_alpha;     /*! Coefficient of the NB2 signal average. */
+    gr_complex d_avgsig;    /*! NB2 signal average. */
+
+    int    d_delay_len;     /*! NB1 delay in samples. */
+    int    d_blank_len;     /*! NB1 blanking window in samples. */
+    int    d_hangtime;      /*! Samples left to blank. */
 
+    std::vector<gr_complex> d_delay;    /*! NB1 delay line followed by the current block. */
+    std::vector<float>      d_mag;      /*! Magnitudes of the current block. */
+    std::vector<float>      d_sig_taps; /*! Weights for the NB2 signal average over a block. */
 };
 
 
@@ -0,0 +1,297 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include "dsp/rx_nr.h"
+#include "dsp/rx_sql.h"
+
+#define NR_FRAME_TIME   0.016   /* Minimum frame length in seconds. */
+#define NR_MIN_WINDOW   1.5     /* Minimum statistics window in seconds. */
+#define NR_NUM_SUB      8       /* Number of sub-windows. */
+#define NR_SMOOTH       0.85f   /* Power smoothing. */
+#define NR_BIAS         1.5f    /* Compensates the minimum of the noise. */
+#define NR_DD           0.98f   /* Decision directed weight. */
+
+
+rx_nr_ff_sptr make_rx_nr_ff(double sample_rate, float strength)
+{
+    return gnuradio::get_initial_sptr(new rx_nr_ff(sample_rate, strength));
+}
+
+rx_nr_ff::rx_nr_ff(double sample_rate, float strength)
+    : gr::sync_block ("rx_nr_ff",
+          gr::io_signature::make(1, 1, sizeof(float)),
+          gr::io_signature::make(1, 1, sizeof(float))),
+      d_fftsize(64),
+      d_pos(0),
+      d_sub_frames(0),
+      d_sub_idx(0),
+      d_first(true),
+      d_sql_open(true)
+{
+    unsigned int j;
+
+    while (d_fftsize < NR_FRAME_TIME * sample_rate)
+        d_fftsize *= 2;
+    d_hop = d_fftsize / 2;
+    d_nbins = d_fftsize / 2 + 1;
+    d_sub_len = std::max(1, (int)(NR_MIN_WINDOW * sample_rate /
+                                  (d_hop * NR_NUM_SUB) + 0.5));
+
+    d_fwd = new gr::fft::fft_real_fwd(d_fftsize);
+    d_rev = new gr::fft::fft_real_rev(d_fftsize);
+
+    // w[j]^2 + w[j + hop]^2 = 1
+    d_window.resize(d_fftsize);
+    for (j = 0; j < d_fftsize; j++)
+        d_window[j] = sin(M_PI * j / d_fftsize);
+
+    d_inbuf.resize(d_fftsize, 0.0f);
+    d_outbuf.resize(d_hop, 0.0f);
+    d_ola.resize(d_hop, 0.0f);
+
+    d_pwr.resize(d_nbins, 0.0f);
+    d_smooth.resize(d_nbins, 0.0f);
+    d_min_sub.resize(d_nbins, 0.0f);
+    d_min_win.resize(d_nbins, 0.0f);
+    d_sub_mins.resize(d_nbins * NR_NUM_SUB, 0.0f);
+    d_clean.resize(d_nbins, 0.0f);
+    d_gain.resize(d_nbins, 1.0f);
+
+    set_strength(strength);
+
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+}
+
+rx_nr_ff::~rx_nr_ff()
+{
+    delete d_fwd;
+    delete d_rev;
+}
+
+/*! \brief Noise reduction work method. */
+int rx_nr_ff::work(int noutput_items,
+                   gr_vector_const_void_star &input_items,
+                   gr_vector_void_star &output_items)
+{
+    const float *in = (const float *) input_items[0];
+    float       *out = (float *) output_items[0];
+    uint64_t     start = nitems_read(0);
+    int          i = 0;
+
+    // process up to each squelch tag, muted runs are skipped
+    get_tags_in_range(d_tags, 0, start, start + noutput_items);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+    for (size_t t = 0; t < d_tags.size(); t++)
+    {
+        int pos = (int)(d_tags[t].offset - start);
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = true;
+            clear_buffers();
+        }
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+        {
+            process_run(in + i, out + i, pos - i);
+            i = pos;
+            d_sql_open = false;
+        }
+    }
+    process_run(in + i, out + i, noutput_items - i);
+
+    return noutput_items;
+}
+
+/*! \brief Process samples with the current squelch state.
+ *
+ * The input is collected in hops of half a frame. The output of the last
+ * frame is returned while the next hop is collected. While the squelch is
+ * closed the output is cleared without processing.
+ */
+void rx_nr_ff::process_run(const float *in, float *out, int nitems)
+{
+    unsigned int i = 0;
+    unsigned int n;
+
+    if (nitems <= 0)
+        return;
+
+    if (!d_sql_open)
+    {
+        std::fill(out, out + nitems, 0.0f);
+        return;
+    }
+
+    while (i < (unsigned int)nitems)
+    {
+        n = std::min(d_hop - d_pos, nitems - i);
+        std::copy(in + i, in + i + n, d_inbuf.begin() + d_hop + d_pos);
+        std::copy(d_outbuf.begin() + d_pos, d_outbuf.begin() + d_pos + n,
+                  out + i);
+        d_pos += n;
+        i += n;
+
+        if (d_pos == d_hop)
+        {
+            process_frame();
+            d_pos = 0;
+        }
+    }
+}
+
+/*! \brief Clear the buffered audio but keep the noise estimate.
+ *
+ * Used when the squelch opens so that the noise floor measured before is
+ * applied from the first frame.
+ */
+void rx_nr_ff::clear_buffers()
+{
+    std::fill(d_inbuf.begin(), d_inbuf.end(), 0.0f);
+    std::fill(d_outbuf.begin(), d_outbuf.end(), 0.0f);
+    std::fill(d_ola.begin(), d_ola.end(), 0.0f);
+    std::fill(d_clean.begin(), d_clean.end(), 0.0f);
+    d_pos = 0;
+}
+
+/*! \brief Set the noise reduction strength.
+ *  \param strength The new strength between 0.0 and 1.0.
+ */
+void rx_nr_ff::set_strength(float strength)
+{
+    strength = std::max(0.0f, std::min(1.0f, strength));
+
+    d_oversub = 1.0f + strength;
+    d_floor = powf(10.0f, -1.5f * strength);
+}
+
+/*! \brief Process a frame and overlap-add it to the output. */
+void rx_nr_ff::process_frame()
+{
+    gr_complex  *spec = d_fwd->get_outbuf();
+    float       *frame = d_rev->get_outbuf();
+    float        scale = 1.0f / (float)d_fftsize;
+    float        over = d_oversub * NR_BIAS;
+    float        gmin = d_floor;
+    const float *pwr = &d_pwr[0];
+    const float *min_win = &d_min_win[0];
+    const float *min_sub = &d_min_sub[0];
+    const float *win = &d_window[0];
+    float       *clean = &d_clean[0];
+    float       *gains = &d_gain[0];
+    float       *outbuf = &d_outbuf[0];
+    float       *ola = &d_ola[0];
+    float        energy;
+    unsigned int j;
+
+    volk_32f_x2_multiply_32f(d_fwd->get_inbuf(), &d_inbuf[0], win, d_fftsize);
+    std::copy(d_inbuf.begin() + d_hop, d_inbuf.end(), d_inbuf.begin());
+
+    d_fwd->execute();
+    volk_32fc_magnitude_squared_32f(&d_pwr[0], spec, d_nbins);
+    volk_32f_accumulator_s32f(&energy, pwr, d_nbins);
+
+    // muted by the squelch; keep the noise estimate
+    if (energy <= 0.0f)
+    {
+        std::copy(d_ola.begin(), d_ola.end(), d_outbuf.begin());
+        std::fill(d_ola.begin(), d_ola.end(), 0.0f);
+        return;
+    }
+
+    update_noise();
+
+    // max(snr, 0) is written as (snr + |snr|) / 2 to keep the loop vectorized
+    for (j = 0; j < d_nbins; j++)
+    {
+        float noise = over * std::min(min_win[j], min_sub[j]) + 1.0e-20f;
+        float snr = pwr[j] / noise - 1.0f;
+        float prio = NR_DD * clean[j] / noise +
+                     0.5f * (1.0f - NR_DD) * (snr + fabsf(snr));
+        float gain = std::max(prio / (1.0f + prio), gmin);
+
+        gains[j] = gain;
+        clean[j] = gain * gain * pwr[j];
+    }
+
+    volk_32fc_32f_multiply_32fc(d_rev->get_inbuf(), spec, gains, d_nbins);
+    d_rev->execute();
+
+    for (j = 0; j < d_hop; j++)
+    {
+        outbuf[j] = ola[j] + frame[j] * win[j] * scale;
+        ola[j] = frame[j + d_hop] * win[j + d_hop] * scale;
+    }
+}
+
+/*! \brief Update the minimum statistics noise estimate. */
+void rx_nr_ff::update_noise()
+{
+    const float *pwr = &d_pwr[0];
+    float       *smooth = &d_smooth[0];
+    float       *min_sub = &d_min_sub[0];
+    float       *min_win = &d_min_win[0];
+    unsigned int j, k;
+
+    if (d_first)
+    {
+        d_first = false;
+        std::copy(d_pwr.begin(), d_pwr.end(), d_smooth.begin());
+        std::copy(d_pwr.begin(), d_pwr.end(), d_min_sub.begin());
+        std::copy(d_pwr.begin(), d_pwr.end(), d_min_win.begin());
+        for (k = 0; k < NR_NUM_SUB; k++)
+            std::copy(d_pwr.begin(), d_pwr.end(), d_sub_mins.begin() + k * d_nbins);
+    }
+
+    for (j = 0; j < d_nbins; j++)
+    {
+        smooth[j] = NR_SMOOTH * smooth[j] + (1.0f - NR_SMOOTH) * pwr[j];
+        min_sub[j] = std::min(min_sub[j], smooth[j]);
+    }
+
+    if (++d_sub_frames < d_sub_len)
+        return;
+
+    // sub-window complete; replace the oldest one
+    d_sub_frames = 0;
+    std::copy(d_min_sub.begin(), d_min_sub.end(),
+              d_sub_mins.begin() + d_sub_idx * d_nbins);
+    d_sub_idx = (d_sub_idx + 1) % NR_NUM_SUB;
+
+    std::copy(d_sub_mins.begin(), d_sub_mins.begin() + d_nbins, d_min_win.begin());
+    for (k = 1; k < NR_NUM_SUB; k++)
+    {
+        const float *sub = &d_sub_mins[k * d_nbins];
+
+        for (j = 0; j < d_nbins; j++)
+            min_win[j] = std::min(min_win[j], sub[j]);
+    }
+
+    std::copy(d_smooth.begin(), d_smooth.end(), d_min_sub.begin());
+}
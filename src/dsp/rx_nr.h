@@ -0,0 +1,130 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_NR_H
+#define RX_NR_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/tags.h>
+#include <vector>
+
+
+class rx_nr_ff;
+
+typedef boost::shared_ptr<rx_nr_ff> rx_nr_ff_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_nr_ff.
+ *  \param sample_rate The sample rate.
+ *  \param strength The noise reduction strength between 0.0 and 1.0.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the rx_nr_ff constructor is private.
+ * make_rx_nr_ff is the public interface for creating new instances.
+ */
+rx_nr_ff_sptr make_rx_nr_ff(double sample_rate, float strength = 0.5);
+
+
+/*! \brief Spectral noise reduction.
+ *  \ingroup DSP
+ *
+ * The audio is processed in frames of about 16 ms with 50% overlap. Each
+ * frame is windowed with a sine window, transformed with a real FFT and
+ * every bin is scaled with a Wiener gain before the inverse FFT and
+ * overlap-add. The sine window is used for both analysis and synthesis so
+ * the frames add up to the input when the gains are 1.
+ *
+ * The noise spectrum is tracked with minimum statistics: the smoothed power
+ * of each bin is followed by its minimum over a window of about 1.5 s, which
+ * is split into sub-windows so that the estimate can rise again when the
+ * noise floor does. The a priori SNR is estimated with the decision
+ * directed method to avoid musical noise.
+ *
+ * The strength sets the over-subtraction and the gain floor, 0.0 leaves the
+ * audio unchanged and 1.0 gives up to 30 dB of attenuation. The output is
+ * delayed by one frame.
+ *
+ * While the squelch tags from rx_sql_cc mark the input as muted the output
+ * is zero without processing. The buffered audio is cleared when the
+ * squelch opens; the noise estimate is kept.
+ */
+class rx_nr_ff : public gr::sync_block
+{
+    friend rx_nr_ff_sptr make_rx_nr_ff(double sample_rate, float strength);
+
+protected:
+    rx_nr_ff(double sample_rate, float strength);
+
+public:
+    ~rx_nr_ff();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void set_strength(float strength);
+
+private:
+    unsigned int    d_fftsize;      /*! Frame length. */
+    unsigned int    d_hop;          /*! Frame advance, half the frame length. */
+    unsigned int    d_nbins;        /*! Number of bins in the real FFT. */
+    unsigned int    d_pos;          /*! Samples in the current hop. */
+
+    float           d_oversub;      /*! Noise over-subtraction factor. */
+    float           d_floor;        /*! Minimum gain. */
+
+    gr::fft::fft_real_fwd  *d_fwd;  /*! Forward FFT. */
+    gr::fft::fft_real_rev  *d_rev;  /*! Inverse FFT. */
+
+    std::vector<float>  d_window;   /*! Sine window. */
+    std::vector<float>  d_inbuf;    /*! Input frame. */
+    std::vector<float>  d_outbuf;   /*! Output samples of the last frame. */
+    std::vector<float>  d_ola;      /*! Overlap from the last frame. */
+
+    /* per bin state */
+    std::vector<float>  d_pwr;      /*! Power of the current frame. */
+    std::vector<float>  d_smooth;   /*! Smoothed power. */
+    std::vector<float>  d_min_sub;  /*! Minimum in the current sub-window. */
+    std::vector<float>  d_min_win;  /*! Minimum of the stored sub-windows. */
+    std::vector<float>  d_sub_mins; /*! Stored sub-window minima. */
+    std::vector<float>  d_clean;    /*! Clean power of the last frame. */
+    std::vector<float>  d_gain;     /*! Gain of the current frame. */
+
+    unsigned int    d_sub_len;      /*! Frames per sub-window. */
+    unsigned int    d_sub_frames;   /*! Frames in the current sub-window. */
+    unsigned int    d_sub_idx;      /*! Next sub-window to replace. */
+    bool            d_first;        /*! No frame processed yet. */
+
+    bool                    d_sql_open; /*! Squelch state from the input tags. */
+    std::vector<gr::tag_t>  d_tags;
+    pmt::pmt_t              d_sob_key;
+    pmt::pmt_t              d_eob_key;
+
+    void process_run(const float *in, float *out, int nitems);
+    void clear_buffers();
+    void process_frame();
+    void update_noise();
+};
+
+#endif /* RX_NR_H */
@@ -22,6 +22,7 @@
  */
 #include <QMessageBox>
 #include <QFileDialog>
+#include <algorithm>
 #include <cmath>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/filter/firdes.h>
@@ -36,6 +37,10 @@ static const int MAX_IN = 1;  /* Maximum number of input streams. */
 static const int MIN_OUT = 1; /* Minimum number of output streams. */
 static const int MAX_OUT = 1; /* Maximum number of output streams. */
 
+#define RDS_STAGE1_RATE   19000.0   /* Minimum rate after the first stage. */
+#define RDS_BANDWIDTH     2400.0    /* One sided bandwidth of the RDS signal. */
+#define RDS_PFB_SIZE      32        /* Number of filters in the resampler. */
+
 /*
  * Create a new instance of rx_rds and return
  * a boost shared_ptr. This is effectively the public constructor.
@@ -45,23 +50,26 @@ rx_rds_sptr make_rx_rds(double sample_rate)
     return gnuradio::get_initial_sptr(new rx_rds(sample_rate));
 }
 
-rx_rds_store_sptr make_rx_rds_store()
-{
-    return gnuradio::get_initial_sptr(new rx_rds_store());
-}
-
 rx_rds::rx_rds(double sample_rate)
     : gr::hier_block2 ("rx_rds",
                       gr::io_signature::make (MIN_IN, MAX_IN, sizeof (float)),
                       gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (char))),
       d_sample_rate(sample_rate)
 {
-    d_taps2 = gr::filter::firdes::low_pass(2500.0, d_sample_rate, 2400, 2000);
+    /* Stage 1: translate 57 kHz to baseband and decimate. The filter is
+       only calculated at the output rate, it just has to protect the RDS
+       band from aliasing. */
+    int decim = std::max(1, (int)(d_sample_rate / RDS_STAGE1_RATE));
+    double rate1 = d_sample_rate / decim;
 
-    f_fxff = gr::filter::freq_xlating_fir_filter_fcf::make(1, d_taps2, 57000, d_sample_rate);
+    d_taps2 = gr::filter::firdes::low_pass(2500.0, d_sample_rate, rate1 / 2.0,
+                                           rate1 - 2.0 * RDS_BANDWIDTH);
+    f_fxff = gr::filter::freq_xlating_fir_filter_fcf::make(decim, d_taps2, 57000, d_sample_rate);
 
-    d_rsmp_tap = gr::filter::firdes::low_pass(10, d_sample_rate, 2375, 2000);
-    d_rsmp = gr::filter::pfb_arb_resampler_ccf::make(2375/d_sample_rate,d_rsmp_tap,32);
+    /* Stage 2: RDS filter and resampling to 2375 Hz */
+    d_rsmp_tap = gr::filter::firdes::low_pass(10, RDS_PFB_SIZE * rate1,
+                                              RDS_BANDWIDTH, 1000);
+    d_rsmp = gr::filter::pfb_arb_resampler_ccf::make(2375 / rate1, d_rsmp_tap, RDS_PFB_SIZE);
 
     f_rrcf = gr::filter::firdes::root_raised_cosine(1, 2375, 2375, 1, 100);
     d_bpf2 = gr::filter::fir_filter_ccf::make(1, f_rrcf);
@@ -91,38 +99,3 @@ rx_rds::~rx_rds ()
 {
 
 }
-
-rx_rds_store::rx_rds_store() : gr::block ("rx_rds_store",
-                                gr::io_signature::make (0, 0, 0),
-                                gr::io_signature::make (0, 0, 0))
-{
-        message_port_register_in(pmt::mp("store"));
-        set_msg_handler(pmt::mp("store"), boost::bind(&rx_rds_store::store, this, _1));
-        d_messages.set_capacity(100);
-}
-
-rx_rds_store::~rx_rds_store ()
-{
-
-}
-
-void rx_rds_store::store(pmt::pmt_t msg)
-{
-    boost::mutex::scoped_lock lock(d_mutex);
-    d_messages.push_back(msg);
-
-}
-
-void rx_rds_store::get_message(std::string &out, int &type)
-{
-    boost::mutex::scoped_lock lock(d_mutex);
-
-    if (d_messages.size()>0) {
-        pmt::pmt_t msg=d_messages.front();
-        type=pmt::to_long(pmt::tuple_ref(msg,0));
-        out=pmt::symbol_to_string(pmt::tuple_ref(msg,1));
-        d_messages.pop_front();
-    } else {
-        type=-1;
-    }
-}
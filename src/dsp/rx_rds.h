@@ -43,37 +43,16 @@
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/blocks/udp_sink.h>
 #include <gnuradio/blocks/message_debug.h>
-#include <boost/circular_buffer.hpp>
 #include "dsp/rds/decoder.h"
 #include "dsp/rds/parser.h"
 
 class rx_rds;
-class rx_rds_store;
 
 typedef boost::shared_ptr<rx_rds> rx_rds_sptr;
-typedef boost::shared_ptr<rx_rds_store> rx_rds_store_sptr;
 
 
 rx_rds_sptr make_rx_rds(double sample_rate);
 
-rx_rds_store_sptr make_rx_rds_store();
-
-class rx_rds_store : public gr::block
-{
-public:
-    rx_rds_store();
-    ~rx_rds_store();
-
-    void get_message(std::string &out, int &type);
-
-private:
-    void store(pmt::pmt_t msg);
-
-    boost::mutex d_mutex;
-    boost::circular_buffer<pmt::pmt_t> d_messages;
-
-};
-
 class rx_rds : public gr::hier_block2
 {
 
@@ -0,0 +1,157 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <gnuradio/io_signature.h>
+#include "dsp/rx_sql.h"
+
+/* Samples passed before the squelch opens (seconds). */
+#define RX_SQL_PREROLL  0.02
+
+
+rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double level_db,
+                              double alpha)
+{
+    return gnuradio::get_initial_sptr(new rx_sql_cc(sample_rate, level_db,
+                                                    alpha));
+}
+
+rx_sql_cc::rx_sql_cc(double sample_rate, double level_db, double alpha)
+    : gr::sync_block ("rx_sql_cc",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(1, 1, sizeof(gr_complex))),
+      d_pwr(0.0),
+      d_hold(0),
+      d_open(true)
+{
+    set_threshold(level_db);
+    set_alpha(alpha);
+
+    d_preroll = (int)(sample_rate * RX_SQL_PREROLL);
+    set_history(d_preroll + 1);
+
+    d_edges.reserve(64);
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+}
+
+rx_sql_cc::~rx_sql_cc()
+{
+}
+
+/*! \brief Squelch work method.
+ *
+ * Every change of the gate state is tagged on the output.
+ */
+int rx_sql_cc::work(int noutput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    gr_complex *out = (gr_complex *) output_items[0];
+    bool        open = d_open;
+
+    process(in, out, noutput_items);
+
+    for (size_t i = 0; i < d_edges.size(); i++)
+    {
+        open = !open;
+        add_item_tag(0, nitems_written(0) + d_edges[i],
+                     open ? d_sob_key : d_eob_key, pmt::PMT_NIL);
+    }
+
+    return noutput_items;
+}
+
+/*! \brief Run the squelch on a buffer.
+ *  \param in The input samples preceded by preroll() samples of history.
+ *  \param out The output buffer.
+ *  \param nitems The number of output samples.
+ *  \returns The number of passed samples.
+ *
+ * The decision for out[i] is taken at in[i + preroll()], so each decision
+ * to pass opens the gate for the preceding pre-roll as well. The gate
+ * changes are stored in d_edges.
+ *
+ * This is used by work() and by blocks that embed the squelch.
+ */
+int rx_sql_cc::process(const gr_complex *in, gr_complex *out, int nitems)
+{
+    gr_complex zero(0.0, 0.0);
+    int     passed = 0;
+    int     start = 0;
+    int     i;
+
+    d_edges.clear();
+
+    for (i = 0; i < nitems; i++)
+    {
+        const gr_complex &x = in[i + d_preroll];
+        bool pass;
+
+        d_pwr = d_alpha * (x.real() * x.real() + x.imag() * x.imag()) +
+                (1.0f - d_alpha) * d_pwr;
+        if (d_pwr >= d_level)
+            d_hold = d_preroll + 1;
+
+        pass = (d_hold > 0);
+        if (pass)
+            d_hold--;
+
+        if (pass != d_open)
+        {
+            // copy or clear the previous run
+            if (d_open)
+                std::copy(in + start, in + i, out + start);
+            else
+                std::fill(out + start, out + i, zero);
+
+            passed += d_open ? i - start : 0;
+            d_edges.push_back(i);
+            d_open = pass;
+            start = i;
+        }
+    }
+
+    if (d_open)
+        std::copy(in + start, in + nitems, out + start);
+    else
+        std::fill(out + start, out + nitems, zero);
+    passed += d_open ? nitems - start : 0;
+
+    return passed;
+}
+
+/*! \brief Set squelch threshold.
+ *  \param level_db The new threshold in dBFS.
+ */
+void rx_sql_cc::set_threshold(double level_db)
+{
+    d_level = powf(10.0, level_db / 10.0);
+}
+
+/*! \brief Set the averaging coefficient of the power estimate. */
+void rx_sql_cc::set_alpha(double alpha)
+{
+    d_alpha = alpha;
+}
@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_SQL_H
+#define RX_SQL_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/gr_complex.h>
+#include <pmt/pmt.h>
+#include <vector>
+
+/*! Tag on the first sample passed after the squelch opened. */
+#define RX_SQL_SOB_KEY  "squelch_sob"
+
+/*! Tag on the first sample muted after the squelch closed. */
+#define RX_SQL_EOB_KEY  "squelch_eob"
+
+
+class rx_sql_cc;
+
+typedef boost::shared_ptr<rx_sql_cc> rx_sql_cc_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_sql_cc.
+ *  \param sample_rate The sample rate.
+ *  \param level_db The squelch threshold in dBFS.
+ *  \param alpha The averaging coefficient of the power estimate.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the rx_sql_cc constructor is private.
+ * make_rx_sql_cc is the public interface for creating new instances.
+ */
+rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double level_db = -150.0,
+                              double alpha = 0.001);
+
+
+/*! \brief Squelch with pre-roll and gate tags.
+ *  \ingroup DSP
+ *
+ * The power estimate and threshold are the same as in
+ * gr::analog::simple_squelch_cc, but the output is delayed by a short
+ * pre-roll. When the squelch opens, the samples received during the
+ * pre-roll are passed as well so the start of a transmission is not lost
+ * while the power estimate rises.
+ *
+ * The first passed sample is tagged with RX_SQL_SOB_KEY and the first muted
+ * sample with RX_SQL_EOB_KEY. Downstream blocks use the tags to skip their
+ * processing while the squelch is closed and to reset their state when it
+ * opens again: rx_agc_cc, fm_discriminator_cf, stereo_demod, rx_anf_cc,
+ * rx_nr_ff and the audio rx_fft_f.
+ *
+ * The audio resamplers (resampler_xx) wrap the GNU Radio filters and
+ * process the muted zeros like any other input. The UDP sink streams the
+ * silence on purpose so that clients see a continuous stream.
+ */
+class rx_sql_cc : public gr::sync_block
+{
+    friend rx_sql_cc_sptr make_rx_sql_cc(double sample_rate, double level_db,
+                                         double alpha);
+
+protected:
+    rx_sql_cc(double sample_rate, double level_db, double alpha);
+
+public:
+    ~rx_sql_cc();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    int process(const gr_complex *in, gr_complex *out, int nitems);
+
+    void set_threshold(double level_db);
+    void set_alpha(double alpha);
+
+    /*! \brief Pre-roll in samples, the history needed by process(). */
+    int preroll() const { return d_preroll; }
+
+    /*! \brief Whether the last output sample was passed. */
+    bool is_open() const { return d_open; }
+
+private:
+    float   d_level;        /*! Threshold (linear power). */
+    float   d_alpha;        /*! Averaging coefficient. */
+    float   d_pwr;          /*! Average power. */
+    int     d_preroll;      /*! Output delay in samples. */
+    int     d_hold;         /*! Samples left to pass. */
+    bool    d_open;         /*! Current gate state. */
+
+    std::vector<int>    d_edges;    /*! Gate changes in the last call. */
+    pmt::pmt_t          d_sob_key;
+    pmt::pmt_t          d_eob_key;
+};
+
+#endif /* RX_SQL_H */
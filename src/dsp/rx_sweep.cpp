@@ -0,0 +1,385 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include <volk/volk.h>
+#include "dsp/rx_sweep.h"
+
+/* Fraction of the spectrum kept for each step. */
+#define SWEEP_USABLE_FRACTION 0.75
+
+
+rx_sweep_c_sptr make_rx_sweep_c(double start, double stop, double quad_rate,
+                                unsigned int fftsize, unsigned int averages,
+                                double settle_time,
+                                std::function<void (double)> tune)
+{
+    return gnuradio::get_initial_sptr(new rx_sweep_c(start, stop, quad_rate,
+                                                     fftsize, averages,
+                                                     settle_time, tune));
+}
+
+rx_sweep_c::rx_sweep_c(double start, double stop, double quad_rate,
+                       unsigned int fftsize, unsigned int averages,
+                       double settle_time, std::function<void (double)> tune)
+    : gr::sync_block ("rx_sweep_c",
+          gr::io_signature::make(1, 1, sizeof(gr_complex)),
+          gr::io_signature::make(0, 0, 0)),
+      d_start(start),
+      d_quad_rate(quad_rate),
+      d_fftsize(fftsize),
+      d_averages(std::max(1u, averages)),
+      d_tune(tune),
+      d_buf_pos(0),
+      d_num_avg(0),
+      d_discard(0),
+      d_step(0),
+      d_dir(1),
+      d_num_sweeps(0),
+      d_hop_request(false),
+      d_hop_pending(false),
+      d_running(false),
+      d_started(false)
+{
+    d_usable = (unsigned int)(d_fftsize * SWEEP_USABLE_FRACTION) & ~1u;
+    if (d_usable < 2)
+        d_usable = 2;
+
+    d_bin_hz = d_quad_rate / (double)d_fftsize;
+    d_step_hz = d_bin_hz * (double)d_usable;
+    d_num_steps = std::max(1, (int)ceil((stop - start) / d_step_hz));
+    d_settle = (unsigned long)(settle_time * d_quad_rate);
+
+    d_fft = new gr::fft::fft_complex(d_fftsize, true);
+    d_window = gr::filter::firdes::window(gr::filter::firdes::WIN_HANN,
+                                          d_fftsize, 6.76);
+
+    d_pwr.resize(d_fftsize, 0.0f);
+    d_acc.resize(d_fftsize, 0.0f);
+    d_pano.resize(d_num_steps * d_usable, -140.0f);
+    d_step_time.resize(d_num_steps, 0);
+}
+
+rx_sweep_c::~rx_sweep_c()
+{
+    stop();
+    delete d_fft;
+}
+
+/*! \brief Start the hop thread and tune to the first step.
+ *
+ * The flow graph calls stop() and start() whenever it is locked and
+ * unlocked. The sweep continues where it was in that case and a hop that
+ * was interrupted is done again.
+ */
+bool rx_sweep_c::start()
+{
+    if (!d_running)
+    {
+        d_running = true;
+        d_thread = std::thread(&rx_sweep_c::hop_thread, this);
+        if (!d_started)
+        {
+            d_started = true;
+            d_dir = 1;
+            request_hop(0);
+        }
+        else if (d_hop_pending)
+        {
+            request_hop(d_step);
+        }
+    }
+
+    return gr::sync_block::start();
+}
+
+/*! \brief Stop the hop thread. */
+bool rx_sweep_c::stop()
+{
+    if (d_running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(d_hop_mutex);
+            d_running = false;
+        }
+        d_hop_cond.notify_one();
+        d_thread.join();
+    }
+
+    return gr::sync_block::stop();
+}
+
+/*! \brief Sweep work method.
+ *
+ * Samples are dropped while a hop is in progress and for the settle time
+ * after it. The remaining samples are windowed directly into the FFT input
+ * buffer and the power spectra are accumulated until the step is complete.
+ */
+int rx_sweep_c::work(int noutput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items)
+{
+    const gr_complex *in = (const gr_complex*)input_items[0];
+    unsigned int      i = 0;
+    unsigned int      n;
+    (void) output_items;
+
+    if (d_hop_pending)
+        return noutput_items;
+
+    if (d_discard > 0)
+    {
+        n = (unsigned int)std::min<unsigned long>(d_discard, noutput_items);
+        d_discard -= n;
+        i = n;
+    }
+
+    while (i < (unsigned int)noutput_items)
+    {
+        n = std::min(d_fftsize - d_buf_pos, noutput_items - i);
+        volk_32fc_32f_multiply_32fc(d_fft->get_inbuf() + d_buf_pos, in + i,
+                                    &d_window[d_buf_pos], n);
+        d_buf_pos += n;
+        i += n;
+
+        if (d_buf_pos < d_fftsize)
+            break;
+
+        d_buf_pos = 0;
+        d_fft->execute();
+        volk_32fc_magnitude_squared_32f(&d_pwr[0], d_fft->get_outbuf(), d_fftsize);
+        volk_32f_x2_add_32f(&d_acc[0], &d_acc[0], &d_pwr[0], d_fftsize);
+
+        if (++d_num_avg < d_averages)
+            continue;
+
+        finish_step();
+
+        if (d_num_steps == 1)
+        {
+            d_num_sweeps++;
+            continue;
+        }
+
+        // Reverse direction at the ends of the range. The end step is
+        // measured again on the way back so no hop is needed.
+        int next = (int)d_step + d_dir;
+        if (next < 0 || next >= (int)d_num_steps)
+        {
+            d_dir = -d_dir;
+            d_num_sweeps++;
+            continue;
+        }
+
+        // the rest of the samples belong to the old frequency
+        request_hop(next);
+        break;
+    }
+
+    return noutput_items;
+}
+
+/*! \brief Get the stitched spectrum.
+ *  \param data Buffer for the spectrum in dBFS.
+ *  \param size The size of the buffer on input, number of bins on output.
+ *
+ * If the panorama has more bins than the buffer, adjacent bins are combined
+ * using peak detection so that narrow signals remain visible.
+ */
+void rx_sweep_c::get_panorama(float *data, unsigned int &size)
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+    unsigned int total = d_pano.size();
+    unsigned int factor;
+    unsigned int i, j;
+
+    if (size == 0)
+        return;
+
+    factor = (total + size - 1) / size;
+    size = (total + factor - 1) / factor;
+
+    for (i = 0; i < size; i++)
+    {
+        unsigned int first = i * factor;
+        unsigned int last = std::min(first + factor, total);
+        float        peak = d_pano[first];
+
+        for (j = first + 1; j < last; j++)
+            peak = std::max(peak, d_pano[j]);
+
+        data[i] = peak;
+    }
+}
+
+/*! \brief Get the upper edge of the panorama. */
+double rx_sweep_c::get_stop_freq() const
+{
+    return d_start + d_step_hz * (double)d_num_steps;
+}
+
+/*! \brief Save the panorama to a file.
+ *  \param filename The name of the file.
+ *  \param csv Use rtl_power compatible CSV format if true.
+ *  \returns True if the file was written.
+ *
+ * The CSV file contains one line per step:
+ * date, time, Hz low, Hz high, Hz step, samples, dB, dB, ...
+ *
+ * The binary file contains the start frequency and bin width as double,
+ * the number of bins as uint32 followed by the bins as float32 in dBFS.
+ * All values are in host byte order.
+ */
+bool rx_sweep_c::save(const std::string &filename, bool csv)
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+    std::ofstream file;
+
+    file.open(filename.c_str(), csv ? std::ios::out : std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << __func__ << ": couldn't open " << filename << std::endl;
+        return false;
+    }
+
+    if (csv)
+    {
+        char        tstr[32];
+        struct tm   tm;
+        unsigned int step, i;
+
+        for (step = 0; step < d_num_steps; step++)
+        {
+            double low = d_start + d_step_hz * (double)step;
+
+            localtime_r(&d_step_time[step], &tm);
+            strftime(tstr, sizeof(tstr), "%Y-%m-%d, %H:%M:%S", &tm);
+            file << tstr << ", " << (long long)low << ", "
+                 << (long long)(low + d_step_hz) << ", "
+                 << d_bin_hz << ", " << d_averages * d_fftsize;
+
+            for (i = 0; i < d_usable; i++)
+                file << ", " << d_pano[step * d_usable + i];
+            file << std::endl;
+        }
+    }
+    else
+    {
+        uint32_t num_bins = d_pano.size();
+
+        file.write((const char *)&d_start, sizeof(double));
+        file.write((const char *)&d_bin_hz, sizeof(double));
+        file.write((const char *)&num_bins, sizeof(uint32_t));
+        file.write((const char *)&d_pano[0], sizeof(float) * num_bins);
+    }
+
+    file.close();
+
+    return !file.fail();
+}
+
+/*! \brief Center frequency of a step. */
+double rx_sweep_c::step_freq(unsigned int step) const
+{
+    return d_start + d_step_hz * ((double)step + 0.5);
+}
+
+/*! \brief Copy the averaged spectrum of the current step to the panorama.
+ *
+ * Only the central d_usable bins are kept. The FFT output has DC in bin 0,
+ * the panorama has the lowest frequency first.
+ */
+void rx_sweep_c::finish_step()
+{
+    std::lock_guard<std::mutex> lock(d_mutex);
+    float           scale = 1.0f / ((float)d_averages * (float)d_fftsize * (float)d_fftsize);
+    float          *out = &d_pano[d_step * d_usable];
+    unsigned int    first = (d_fftsize - d_usable) / 2;
+    unsigned int    dc = d_usable / 2;
+    unsigned int    j;
+
+    for (j = 0; j < d_usable; j++)
+    {
+        unsigned int k = (first + j + d_fftsize / 2) % d_fftsize;
+        out[j] = 10.0f * log10f(d_acc[k] * scale + 1.0e-20f);
+    }
+
+    // remove LO leakage
+    out[dc] = 0.5f * (out[dc - 1] + out[dc + 1]);
+
+    d_step_time[d_step] = time(0);
+
+    std::fill(d_acc.begin(), d_acc.end(), 0.0f);
+    d_num_avg = 0;
+}
+
+/*! \brief Ask the hop thread to tune to a new step.
+ *
+ * Called from the streaming thread. The state of the step is reset here so
+ * that only the streaming thread touches it; work() doesn't use it until the
+ * hop is complete.
+ */
+void rx_sweep_c::request_hop(unsigned int step)
+{
+    d_discard = d_settle;
+    d_buf_pos = 0;
+    d_num_avg = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(d_hop_mutex);
+        d_step = step;
+        d_hop_request = true;
+        d_hop_pending = true;
+    }
+    d_hop_cond.notify_one();
+}
+
+/*! \brief Hop thread.
+ *
+ * Tuning can take several milliseconds so it is done here instead of in
+ * work(). The streaming thread drops samples until the hop is complete and
+ * then discards the settle samples. This thread only clears d_hop_pending.
+ */
+void rx_sweep_c::hop_thread()
+{
+    std::unique_lock<std::mutex> lock(d_hop_mutex);
+
+    while (true)
+    {
+        d_hop_cond.wait(lock, [this] { return d_hop_request || !d_running; });
+        if (!d_running)
+            break;
+
+        d_hop_request = false;
+        double freq = step_freq(d_step);
+
+        lock.unlock();
+        d_tune(freq);
+        d_hop_pending = false;
+        lock.lock();
+    }
+}
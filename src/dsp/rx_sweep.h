@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef RX_SWEEP_H
+#define RX_SWEEP_H
+
+#include <gnuradio/sync_block.h>
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/gr_complex.h>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class rx_sweep_c;
+
+typedef boost::shared_ptr<rx_sweep_c> rx_sweep_c_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of rx_sweep_c.
+ *  \param start The lower edge of the sweep range in Hz.
+ *  \param stop The upper edge of the sweep range in Hz.
+ *  \param quad_rate The sample rate of the input.
+ *  \param fftsize The FFT size used for each step.
+ *  \param averages The number of FFTs averaged for each step.
+ *  \param settle_time The time to wait for the tuner after a hop (seconds).
+ *  \param tune The function used to set the hardware frequency.
+ *
+ * This is effectively the public constructor. To avoid accidental use
+ * of raw pointers, the rx_sweep_c constructor is private.
+ * make_rx_sweep_c is the public interface for creating new instances.
+ */
+rx_sweep_c_sptr make_rx_sweep_c(double start, double stop, double quad_rate,
+                                unsigned int fftsize, unsigned int averages,
+                                double settle_time,
+                                std::function<void (double)> tune);
+
+
+/*! \brief Wideband spectrum sweeper.
+ *  \ingroup DSP
+ *
+ * This block steps the hardware frequency across a range that is wider than
+ * the sample rate and stitches the spectra into one panorama, similar to
+ * rtl_power.
+ *
+ * For each step the block discards the samples received while the tuner
+ * settles, averages a number of FFTs and keeps only the central part of the
+ * spectrum to avoid the roll-off of the anti-aliasing filters. The DC bin is
+ * replaced by the average of its neighbours.
+ *
+ * The hops are done by a worker thread as soon as a step is complete so that
+ * the streaming thread is never blocked by the tuner. Consecutive sweeps run
+ * in alternating directions so that every hop is a single step and the tuner
+ * never has to settle after a jump across the full range.
+ */
+class rx_sweep_c : public gr::sync_block
+{
+    friend rx_sweep_c_sptr make_rx_sweep_c(double start, double stop,
+                                           double quad_rate,
+                                           unsigned int fftsize,
+                                           unsigned int averages,
+                                           double settle_time,
+                                           std::function<void (double)> tune);
+
+protected:
+    rx_sweep_c(double start, double stop, double quad_rate,
+               unsigned int fftsize, unsigned int averages,
+               double settle_time, std::function<void (double)> tune);
+
+public:
+    ~rx_sweep_c();
+
+    bool start();
+    bool stop();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    void get_panorama(float *data, unsigned int &size);
+    double get_start_freq() const { return d_start; }
+    double get_stop_freq() const;
+    unsigned int get_num_sweeps() const { return d_num_sweeps; }
+
+    bool save(const std::string &filename, bool csv);
+
+private:
+    double          d_start;        /*! Lower edge of the range. */
+    double          d_quad_rate;    /*! Input sample rate. */
+    unsigned int    d_fftsize;      /*! FFT size. */
+    unsigned int    d_averages;     /*! Number of FFTs per step. */
+    unsigned int    d_usable;       /*! Number of bins kept per step. */
+    unsigned int    d_num_steps;    /*! Number of steps in the range. */
+    double          d_bin_hz;       /*! Width of a bin in Hz. */
+    double          d_step_hz;      /*! Distance between steps in Hz. */
+    unsigned long   d_settle;       /*! Samples to discard after a hop. */
+
+    std::function<void (double)>    d_tune; /*! Tune callback. */
+
+    gr::fft::fft_complex   *d_fft;      /*! FFT object. */
+    std::vector<float>      d_window;   /*! FFT window taps. */
+    std::vector<float>      d_pwr;      /*! Power of the last FFT. */
+    std::vector<float>      d_acc;      /*! Accumulated power for this step. */
+    std::vector<float>      d_pano;     /*! Stitched spectrum in dBFS. */
+    std::vector<time_t>     d_step_time;/*! Time when each step was completed. */
+
+    unsigned int    d_buf_pos;      /*! Samples in FFT input buffer. */
+    unsigned int    d_num_avg;      /*! FFTs accumulated in this step. */
+    unsigned long   d_discard;      /*! Samples left to discard. */
+    unsigned int    d_step;         /*! Current step. */
+    int             d_dir;          /*! Sweep direction (+1 or -1). */
+    std::atomic<unsigned int> d_num_sweeps; /*! Completed sweeps. */
+
+    std::mutex              d_mutex;    /*! Protects panorama data. */
+    std::mutex              d_hop_mutex;
+    std::condition_variable d_hop_cond;
+    std::thread             d_thread;   /*! Worker thread doing the hops. */
+    bool                    d_hop_request;  /*! Hop requested (hop thread). */
+    std::atomic<bool>       d_hop_pending;  /*! Hop in progress (work). */
+    bool                    d_running;
+    bool                    d_started;  /*! The first step has been requested. */
+
+    double step_freq(unsigned int step) const;
+    void finish_step();
+    void request_hop(unsigned int step);
+    void hop_thread();
+};
+
+#endif /* RX_SWEEP_H */
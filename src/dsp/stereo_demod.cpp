@@ -22,8 +22,14 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/math.h>
+#include <gnuradio/sincos.h>
+#include <volk/volk.h>
+#include <algorithm>
 #include <math.h>
 #include <iostream>
+#include <dsp/rx_sql.h>
 #include <dsp/stereo_demod.h>
 
 
@@ -41,133 +47,333 @@ static const int MAX_IN  = 1; /* Maximum number of input streams. */
 static const int MIN_OUT = 2; /* Minimum number of output streams. */
 static const int MAX_OUT = 2; /* Maximum number of output streams. */
 
-#define STEREO_DEMOD_PARANOIC
+#define STEREO_MAX_IN        4096   /* Max input samples per call. */
+#define STEREO_OUT_MARGIN    64     /* Output space for resampler jitter. */
+#define STEREO_FLT_SIZE      32     /* Number of polyphase filters. */
+#define STEREO_MPX_RATE      120e3  /* Minimum MPX rate. */
+#define STEREO_MPX_BW        54e3   /* MPX bandwidth incl. L-R sidebands. */
+
+#define PILOT_LOOP_BW        0.001f /* PLL loop bandwidth (rad/sample). */
+#define PILOT_ARM_BW         1000.0 /* Phase detector bandwidth (Hz). */
+#define PILOT_LOCK_LEVEL     1.0e-4f    /* Pilot power to enable stereo. */
+#define PILOT_UNLOCK_LEVEL   2.5e-5f    /* Pilot power to disable stereo. */
 
 /*! \brief Create stereo demodulator object.
  *
  * Use make_stereo_demod() instead.
  */
 stereo_demod::stereo_demod(float input_rate, float audio_rate, bool stereo, bool oirt)
-    : gr::hier_block2("stereo_demod",
-                     gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
-                     gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
+    : gr::block("stereo_demod",
+                gr::io_signature::make (MIN_IN,  MAX_IN,  sizeof (float)),
+                gr::io_signature::make (MIN_OUT, MAX_OUT, sizeof (float))),
+    d_dec(0),
+    d_nco_r(1.0f),
+    d_nco_i(0.0f),
+    d_zr(0.0f),
+    d_zi(0.0f),
+    d_blend(0.0f),
+    d_pilot_lock(false),
+    d_sql_open(true),
+    d_sql_acc(0.0),
     d_input_rate(input_rate),
     d_audio_rate(audio_rate),
     d_stereo(stereo),
     d_oirt(oirt)
 {
-  double cutof_freq = d_oirt ? 15e3 : 17e3;
-  lpf0 = make_lpf_ff(d_input_rate, cutof_freq, 2e3); // FIXME
-  audio_rr0 = make_resampler_ff(d_audio_rate/d_input_rate);
-  deemph0 = make_fm_deemph(d_audio_rate, 50.0e-6);
-
-  if (d_stereo)
-  {
-    lpf1 = make_lpf_ff(d_input_rate, cutof_freq, 2e3); // FIXME
-    audio_rr1 = make_resampler_ff(d_audio_rate/d_input_rate);
-    deemph1 = make_fm_deemph(d_audio_rate, 50.0e-6);
-
-    if (!d_oirt)
+    double pilot = d_oirt ? 31250.0 : 19000.0;
+
+    /* Audio bandwidth, limited by the output rate. The stop band starts
+       at the pilot or at the output Nyquist frequency. */
+    double cutof_freq = std::min(d_oirt ? 15e3 : 17e3, 0.4 * d_audio_rate);
+    double stop_freq = std::min(pilot, 0.5 * d_audio_rate);
+
+    /* Integer decimation to the MPX rate, only the MPX bandwidth must be
+       free from aliases. */
+    d_decim = std::max(1, (int)(d_input_rate / STEREO_MPX_RATE));
+    d_mpx_rate = d_input_rate / d_decim;
+    if (d_decim > 1)
     {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
-                                       1.0,          // gain,
-		                                   d_input_rate, // sampling_freq
-                                       18800.,       // low_cutoff_freq
-                                       19200.,       // high_cutoff_freq
-                                       300.);        // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.001,    // loop_bw FIXME
-                                2*M_PI * 19200 / input_rate,  // max_freq
-                                2*M_PI * 18800 / input_rate); // min_freq
-        subtone = gr::blocks::multiply_cc::make();
-    } else {
-        d_tone_taps = gr::filter::firdes::complex_band_pass(
-                                       1.0,          // gain,
-                                           d_input_rate, // sampling_freq
-                                       31200.,       // low_cutoff_freq
-                                       31300.,       // high_cutoff_freq
-                                       100.);        // transition_width
-        pll = gr::analog::pll_refout_cc::make(0.001,    // loop_bw FIXME
-                                2*M_PI * 31200 / input_rate,  // max_freq
-                                2*M_PI * 31300 / input_rate); // min_freq
-    }
+        std::vector<float> dec_taps = gr::filter::firdes::low_pass(
+                    1.0, d_input_rate, d_mpx_rate / 2.0,
+                    d_mpx_rate - 2.0 * STEREO_MPX_BW);
 
-    tone = gr::filter::fir_filter_fcc::make(1, d_tone_taps);
-
-    lo = gr::blocks::complex_to_imag::make();
-
-#ifdef STEREO_DEMOD_PARANOIC
-    d_pll_taps = gr::filter::firdes::band_pass(
-                                       1.0,          // gain,
-		                                   d_input_rate, // sampling_freq
-                                       37600.,       // low_cutoff_freq
-                                       38400.,       // high_cutoff_freq
-                                       400.);        // transition_width
-    lo2 = gr::filter::fir_filter_fff::make(1, d_pll_taps);
-#endif
-
-    mixer = gr::blocks::multiply_ff::make();
-
-    cdp = gr::blocks::multiply_const_ff::make( 3.61); // ±0.02
-    cdm = gr::blocks::multiply_const_ff::make(-3.61); // ±0.02
-
-    add0 = gr::blocks::add_ff::make();
-    add1 = gr::blocks::add_ff::make();
-
-    /* connect block */
-    if (!d_oirt) {
-        connect(self(), 0, tone, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, subtone, 0);
-        connect(pll, 0, subtone, 1);
-        connect(subtone, 0, lo, 0);
-
-#ifdef STEREO_DEMOD_PARANOIC
-        connect(lo,  0, lo2, 0);
-        connect(lo2, 0, mixer, 0);
-#else
-        connect(lo, 0, mixer, 0);
-#endif
-    } else {
-        connect(self(), 0, tone, 0);
-        connect(tone, 0, pll, 0);
-        connect(pll, 0, lo, 0);
-        connect(lo, 0, mixer, 0);
+        d_dec = new gr::filter::kernel::fir_filter_fff(1, dec_taps);
+        d_dec_buf.assign(d_dec->ntaps() - 1 + STEREO_MAX_IN, 0.0f);
+        d_mpx.resize(STEREO_MAX_IN / d_decim);
     }
 
-    connect(self(), 0, mixer, 1);
-
-    connect(self(), 0, lpf0, 0);
-    connect(mixer,  0, lpf1, 0);
-
-    connect(lpf0, 0, audio_rr0, 0); // sum
-    connect(lpf1, 0, audio_rr1, 0);
-
-    connect(audio_rr1, 0, cdp,  0); // +delta
-    connect(audio_rr1, 0, cdm,  0); // -delta
-
-    connect(audio_rr0, 0, add0,   0);
-    connect(cdp,       0, add0,   1);
-    connect(add0,      0, deemph0, 0);
-    connect(deemph0,   0, self(), 0); // left = sum + delta
-
-    connect(audio_rr0, 0, add1,   0);
-    connect(cdm,       0, add1,   1);
-    connect(add1,      0, deemph1, 0);
-    connect(deemph1,   0, self(), 1); // right = sum + delta
-  }
-  else // if (!d_stereo)
-  {
-    /* connect block */
-    connect(self(), 0, lpf0, 0);
-    connect(lpf0,   0, audio_rr0, 0);
-    connect(audio_rr0, 0, deemph0, 0);
-    connect(deemph0, 0, self(), 0);
-    connect(deemph0, 0, self(), 1);
-  }
+    /* Low-pass filter and resampling in one polyphase filter. The pilot
+       tone is in the stop band. */
+    float  rate = d_audio_rate / d_mpx_rate;
+    std::vector<float> taps = gr::filter::firdes::low_pass(
+                STEREO_FLT_SIZE, STEREO_FLT_SIZE * d_mpx_rate,
+                cutof_freq, stop_freq - cutof_freq);
+
+    d_rr_sum = new gr::filter::kernel::pfb_arb_resampler_fff(rate, taps, STEREO_FLT_SIZE);
+    d_rr_diff = new gr::filter::kernel::pfb_arb_resampler_fff(rate, taps, STEREO_FLT_SIZE);
+    d_hist = d_rr_sum->taps_per_filter() - 1;
+    d_len = d_hist;
+
+    d_sum.assign(d_hist + STEREO_MAX_IN, 0.0f);
+    d_diff.assign(d_sum.size(), 0.0f);
+    d_carrier.resize(STEREO_MAX_IN);
+    d_diff_out.resize((size_t)(STEREO_MAX_IN * std::max(1.0f, rate)) + STEREO_OUT_MARGIN);
+
+    /* PLL, same loop filter as gr::blocks::control_loop */
+    float damping = sqrtf(2.0f) / 2.0f;
+    float denom = 1.0f + 2.0f * damping * PILOT_LOOP_BW + PILOT_LOOP_BW * PILOT_LOOP_BW;
+
+    d_alpha = (4.0f * damping * PILOT_LOOP_BW) / denom;
+    d_beta = (4.0f * PILOT_LOOP_BW * PILOT_LOOP_BW) / denom;
+    d_freq = 2.0 * M_PI * pilot / d_mpx_rate;
+    d_min_freq = 2.0 * M_PI * (pilot - 200.0) / d_mpx_rate;
+    d_max_freq = 2.0 * M_PI * (pilot + 200.0) / d_mpx_rate;
+    d_arm_alpha = 1.0 - exp(-2.0 * M_PI * PILOT_ARM_BW / d_mpx_rate);
+    d_blend_alpha = 1.0 - exp(-2.0 * M_PI * 10.0 / d_mpx_rate);
+
+    /* 50 us de-emphasis at the audio rate, see fm_discriminator_cf */
+    double  tau = 50.0e-6;
+    double  w_ca = 2.0 * d_audio_rate * tan(1.0 / (2.0 * tau * d_audio_rate));
+    double  k = -w_ca / (2.0 * d_audio_rate);
+
+    d_deemph_p1 = (1.0 + k) / (1.0 - k);
+    d_deemph_b0 = -k / (1.0 - k);
+    d_x1[0] = d_x1[1] = 0.0f;
+    d_y1[0] = d_y1[1] = 0.0f;
+
+    d_sob_key = pmt::intern(RX_SQL_SOB_KEY);
+    d_eob_key = pmt::intern(RX_SQL_EOB_KEY);
+
+    set_relative_rate(d_audio_rate / d_input_rate);
+    set_min_noutput_items(2 * STEREO_OUT_MARGIN);
 }
 
 
 stereo_demod::~stereo_demod()
 {
+    delete d_dec;
+    delete d_rr_sum;
+    delete d_rr_diff;
+}
+
+void stereo_demod::forecast(int noutput_items,
+                            gr_vector_int &ninput_items_required)
+{
+    int nin = (int)((noutput_items - STEREO_OUT_MARGIN) * d_input_rate / d_audio_rate);
+
+    ninput_items_required[0] = std::max(d_decim, std::min(nin, STEREO_MAX_IN));
+}
 
+/*! \brief MPX decoder work method.
+ *
+ * L+R is the decimated input, L-R is the decimated input multiplied with the
+ * regenerated sub-carrier. Both are resampled and the left and right
+ * channels are calculated from the resampler outputs.
+ *
+ * While the squelch is closed only silence is produced.
+ */
+int stereo_demod::general_work(int noutput_items,
+                               gr_vector_int &ninput_items,
+                               gr_vector_const_void_star &input_items,
+                               gr_vector_void_star &output_items)
+{
+    const float *in = (const float *) input_items[0];
+    float *out0 = (float *) output_items[0];
+    float *out1 = (float *) output_items[1];
+    const float *mpx = in;
+    int    nin, n, n_read, produced;
+
+    nin = (int)((noutput_items - STEREO_OUT_MARGIN) * d_input_rate / d_audio_rate);
+    nin = std::min(std::min(nin, ninput_items[0]), STEREO_MAX_IN);
+    nin -= nin % d_decim;
+    if (nin <= 0)
+        return 0;
+
+    nin = squelch_tags(nin);
+    if (!d_sql_open)
+    {
+        // muted input, output silence at the resampled rate
+        consume_each(nin);
+        d_sql_acc += nin * d_audio_rate / d_input_rate;
+        produced = (int)d_sql_acc;
+        d_sql_acc -= produced;
+        std::fill(out0, out0 + produced, 0.0f);
+        std::fill(out1, out1 + produced, 0.0f);
+        return produced;
+    }
+
+    n = nin;
+    if (d_dec)
+    {
+        int hist = d_dec->ntaps() - 1;
+
+        std::copy(in, in + nin, d_dec_buf.begin() + hist);
+        n = nin / d_decim;
+        d_dec->filterNdec(&d_mpx[0], &d_dec_buf[0], n, d_decim);
+        std::copy(d_dec_buf.begin() + nin, d_dec_buf.begin() + nin + hist,
+                  d_dec_buf.begin());
+        mpx = &d_mpx[0];
+    }
+    consume_each(nin);
+
+    // d_sum and d_diff hold the resampler history followed by the new samples
+    std::copy(mpx, mpx + n, d_sum.begin() + d_len);
+    if (d_stereo)
+    {
+        pilot_pll(mpx, n);
+        volk_32f_x2_multiply_32f(&d_diff[d_len], mpx, &d_carrier[0], n);
+    }
+    d_len += n;
+
+    produced = d_rr_sum->filter(out0, &d_sum[0], d_len - d_hist, n_read);
+    if (d_stereo)
+        d_rr_diff->filter(&d_diff_out[0], &d_diff[0], d_len - d_hist, n_read);
+
+    n_read = std::min(n_read, d_len);
+    std::copy(d_sum.begin() + n_read, d_sum.begin() + d_len, d_sum.begin());
+    std::copy(d_diff.begin() + n_read, d_diff.begin() + d_len, d_diff.begin());
+    d_len -= n_read;
+
+    if (d_stereo)
+    {
+        // left = sum + delta, right = sum - delta
+        volk_32f_x2_subtract_32f(out1, out0, &d_diff_out[0], produced);
+        volk_32f_x2_add_32f(out0, out0, &d_diff_out[0], produced);
+        deemph(out0, produced, d_x1[0], d_y1[0]);
+        deemph(out1, produced, d_x1[1], d_y1[1]);
+    }
+    else
+    {
+        deemph(out0, produced, d_x1[0], d_y1[0]);
+        std::copy(out0, out0 + produced, out1);
+    }
+
+    return produced;
+}
+
+/*! \brief Apply the squelch tags at the start of the input.
+ *  \param nin The number of input samples available.
+ *  \returns The number of input samples to process with the new state.
+ *
+ * Tags within the first decimation period change the squelch state, the
+ * input is truncated before the next tag so each call is either muted or
+ * not. The decoder state is cleared when the squelch opens.
+ */
+int stereo_demod::squelch_tags(int nin)
+{
+    uint64_t start = nitems_read(0);
+
+    get_tags_in_range(d_tags, 0, start, start + nin);
+    std::sort(d_tags.begin(), d_tags.end(), gr::tag_t::offset_compare);
+
+    for (size_t t = 0; t < d_tags.size(); t++)
+    {
+        int  pos = (int)(d_tags[t].offset - start);
+        bool open;
+
+        if (pmt::eq(d_tags[t].key, d_sob_key))
+            open = true;
+        else if (pmt::eq(d_tags[t].key, d_eob_key))
+            open = false;
+        else
+            continue;
+
+        if (pos >= d_decim)
+            return pos - pos % d_decim;
+
+        if (open && !d_sql_open)
+            reset();
+        d_sql_open = open;
+    }
+
+    return nin;
+}
+
+/*! \brief Clear the filter and PLL state.
+ *
+ * The PLL keeps its frequency, the stereo blend starts again from mono.
+ */
+void stereo_demod::reset()
+{
+    std::fill(d_dec_buf.begin(), d_dec_buf.end(), 0.0f);
+    std::fill(d_sum.begin(), d_sum.end(), 0.0f);
+    std::fill(d_diff.begin(), d_diff.end(), 0.0f);
+    d_len = d_hist;
+
+    d_zr = 0.0f;
+    d_zi = 0.0f;
+    d_blend = 0.0f;
+    d_pilot_lock = false;
+
+    d_x1[0] = d_x1[1] = 0.0f;
+    d_y1[0] = d_y1[1] = 0.0f;
+}
+
+/*! \brief Lock to the pilot tone and regenerate the sub-carrier.
+ *
+ * The input is mixed down with the NCO and low-pass filtered. The phase
+ * of the result is the phase error. For a pilot sin(wt) the NCO locks to
+ * the pilot phase, so the sub-carrier is sin(2wt) for FM and the pilot
+ * itself for OIRT. The sub-carrier is scaled by 2 to compensate for the
+ * mixing loss.
+ */
+void stereo_demod::pilot_pll(const float *in, int nitems)
+{
+    float   level, rot_r, rot_i, mag;
+    float   freq0 = d_freq;
+    float   c = d_nco_r;
+    float   s = d_nco_i;
+    int     i;
+
+    // the NCO is a phasor rotated by the block start frequency; the loop
+    // correction is small and applied as exp(j*d) ~ 1 - d^2/2 + j*d
+    gr::sincosf(freq0, &rot_i, &rot_r);
+
+    for (i = 0; i < nitems; i++)
+    {
+        float err, d, t, dr;
+
+        d_zr += d_arm_alpha * (in[i] * c - d_zr);
+        d_zi += d_arm_alpha * (-in[i] * s - d_zi);
+        err = gr::fast_atan2f(d_zr, -d_zi);
+
+        d_blend += d_blend_alpha * ((d_pilot_lock ? 1.0f : 0.0f) - d_blend);
+        d_carrier[i] = 2.0f * d_blend * (d_oirt ? s : 2.0f * s * c);
+
+        d_freq += d_beta * err;
+        d_freq = std::min(std::max(d_freq, d_min_freq), d_max_freq);
+        d = d_freq - freq0 + d_alpha * err;
+        dr = 1.0f - 0.5f * d * d;
+
+        t = c * rot_r - s * rot_i;
+        s = s * rot_r + c * rot_i;
+        c = t;
+        t = c * dr - s * d;
+        s = s * dr + c * d;
+        c = t;
+    }
+
+    // remove the rounding errors of the rotations
+    mag = 1.0f / sqrtf(c * c + s * s);
+    d_nco_r = c * mag;
+    d_nco_i = s * mag;
+
+    level = d_zr * d_zr + d_zi * d_zi;
+    if (level > PILOT_LOCK_LEVEL)
+        d_pilot_lock = true;
+    else if (level < PILOT_UNLOCK_LEVEL)
+        d_pilot_lock = false;
+}
+
+/*! \brief FM de-emphasis, same as fm_discriminator_cf. */
+void stereo_demod::deemph(float *buf, int nitems, float &x1, float &y1)
+{
+    for (int i = 0; i < nitems; i++)
+    {
+        float x = buf[i];
+
+        buf[i] = d_deemph_b0 * (x + x1) + d_deemph_p1 * y1;
+        x1 = x;
+        y1 = buf[i];
+    }
 }
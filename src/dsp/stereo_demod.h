@@ -24,29 +24,11 @@
 #ifndef STEREO_DEMOD_H
 #define STEREO_DEMOD_H
 
-#include <gnuradio/hier_block2.h>
-#include <gnuradio/filter/firdes.h>
-
-#if GNURADIO_VERSION < 0x030800
-#include <gnuradio/filter/fir_filter_fcc.h>
-#include <gnuradio/filter/fir_filter_fff.h>
-#include <gnuradio/blocks/multiply_cc.h>
-#include <gnuradio/blocks/multiply_ff.h>
-#include <gnuradio/blocks/multiply_const_ff.h>
-#include <gnuradio/blocks/add_ff.h>
-#else
-#include <gnuradio/filter/fir_filter_blk.h>
-#include <gnuradio/blocks/multiply.h>
-#include <gnuradio/blocks/multiply_const.h>
-#include <gnuradio/blocks/add_blk.h>
-#endif
-
-#include <gnuradio/analog/pll_refout_cc.h>
-#include <gnuradio/blocks/complex_to_imag.h>
+#include <gnuradio/block.h>
+#include <gnuradio/filter/fir_filter.h>
+#include <gnuradio/filter/pfb_arb_resampler.h>
+#include <gnuradio/tags.h>
 #include <vector>
-#include "dsp/fm_deemph.h"
-#include "dsp/lpf.h"
-#include "dsp/resampler_xx.h"
 
 
 class stereo_demod;
@@ -73,8 +55,21 @@ stereo_demod_sptr make_stereo_demod(float quad_rate=120e3,
  *
  * This class implements the stereo demodulator for 87.5...108 MHz band.
  *
+ * The complete MPX decoder is done in one block. High input rates are first
+ * decimated by an integer factor to an MPX rate of at least 120 kHz. A PLL
+ * then locks to the pilot
+ * tone (19 kHz, or 31.25 kHz for OIRT) and regenerates the sub-carrier
+ * which is used to demodulate L-R. L+R and L-R are low-pass filtered and
+ * decimated to the audio rate by polyphase resamplers, then matrixed to
+ * left and right and de-emphasized.
+ *
+ * The L-R signal is faded out when the pilot is lost, so weak stations
+ * fall back to mono.
+ *
+ * The squelch tags from rx_sql_cc are followed: the decoder is bypassed
+ * while the squelch is closed and reset when it opens.
  */
-class stereo_demod : public gr::hier_block2
+class stereo_demod : public gr::block
 {
     friend stereo_demod_sptr make_stereo_demod(float input_rate,
                                                float audio_rate,
@@ -87,32 +82,71 @@ protected:
 public:
     ~stereo_demod();
 
+    void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+
+    int general_work(int noutput_items,
+                     gr_vector_int &ninput_items,
+                     gr_vector_const_void_star &input_items,
+                     gr_vector_void_star &output_items);
+
+    bool pilot_detected() const { return d_pilot_lock; }
+
 private:
-    /* GR blocks */
-    gr::filter::fir_filter_fcc::sptr  tone;  /*!< Pilot tone BPF. */
-    gr::analog::pll_refout_cc::sptr   pll;   /*!< Pilot tone PLL. */
-    gr::blocks::multiply_cc::sptr subtone;   /*!< Stereo subtone. */
-    gr::blocks::complex_to_imag::sptr lo;    /*!< Complex tone imag. */
-    gr::filter::fir_filter_fff::sptr  lo2;   /*!< Subtone BPF. */
-    gr::blocks::multiply_ff::sptr mixer;     /*!< Balance mixer. */
-    lpf_ff_sptr lpf0;              /*!< Low-pass filter #0. */
-    lpf_ff_sptr lpf1;              /*!< Low-pass filter #1. */
-    resampler_ff_sptr audio_rr0;   /*!< Audio resampler #0. */
-    resampler_ff_sptr audio_rr1;   /*!< Audio resampler #1. */
-    fm_deemph_sptr deemph0;        /*!< FM de-emphasis #0. */
-    fm_deemph_sptr deemph1;        /*!< FM de-emphasis #1. */
-    gr::blocks::multiply_const_ff::sptr cdp; /*!< Channel delta (plus). */
-    gr::blocks::multiply_const_ff::sptr cdm; /*!< Channel delta (minus). */
-    gr::blocks::add_ff::sptr add0;           /*!< Left stereo channel. */
-    gr::blocks::add_ff::sptr add1;           /*!< Right stereo channel. */
+    void pilot_pll(const float *in, int nitems);
+    void deemph(float *buf, int nitems, float &x1, float &y1);
+    int  squelch_tags(int nin);
+    void reset();
+
+    /* MPX decimator */
+    gr::filter::kernel::fir_filter_fff *d_dec;
+    std::vector<float> d_dec_buf;        /*! Decimator input incl. history. */
+    std::vector<float> d_mpx;            /*! Decimated MPX signal. */
+    int   d_decim;                       /*! Decimation to the MPX rate. */
+    float d_mpx_rate;                    /*! MPX rate. */
+
+    /* resamplers */
+    gr::filter::kernel::pfb_arb_resampler_fff *d_rr_sum;
+    gr::filter::kernel::pfb_arb_resampler_fff *d_rr_diff;
+    std::vector<float> d_sum;            /*! L+R incl. resampler history. */
+    std::vector<float> d_diff;           /*! L-R incl. resampler history. */
+    std::vector<float> d_carrier;        /*! Regenerated sub-carrier. */
+    std::vector<float> d_diff_out;       /*! Resampled L-R. */
+    int   d_len;                         /*! Samples in d_sum and d_diff. */
+    int   d_hist;                        /*! Resampler history. */
+
+    /* pilot PLL */
+    float d_nco_r;                       /*! NCO phasor, cos(phase). */
+    float d_nco_i;                       /*! NCO phasor, sin(phase). */
+    float d_freq;                        /*! NCO frequency (rad/sample). */
+    float d_min_freq;
+    float d_max_freq;
+    float d_alpha;                       /*! Loop filter gains. */
+    float d_beta;
+    float d_arm_alpha;                   /*! Phase detector low-pass. */
+    float d_zr;                          /*! Mixed down pilot. */
+    float d_zi;
+    float d_blend;                       /*! L-R gain, 0 when no pilot. */
+    float d_blend_alpha;
+    bool  d_pilot_lock;                  /*! Pilot detected. */
+
+    /* squelch */
+    bool  d_sql_open;                    /*! Squelch state from the input tags. */
+    double d_sql_acc;                    /*! Fractional output while muted. */
+    std::vector<gr::tag_t> d_tags;
+    pmt::pmt_t d_sob_key;
+    pmt::pmt_t d_eob_key;
+
+    /* de-emphasis */
+    float d_deemph_b0;
+    float d_deemph_p1;
+    float d_x1[2];                       /*! De-emphasis state. */
+    float d_y1[2];
 
     /* other parameters */
     float d_input_rate;                  /*! Input rate. */
     float d_audio_rate;                  /*! Audio rate. */
     bool  d_stereo;                      /*! On/off stereo mode. */
     bool  d_oirt;
-    std::vector<gr_complex> d_tone_taps; /*! Tone BPF taps. */
-    std::vector<float> d_pll_taps;       /*! Subtone BPF taps. */
 };
 
 
@@ -0,0 +1,403 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <gnuradio/io_signature.h>
+#include "interfaces/async_file_sink.h"
+
+/* Size of the blocks written to disk. */
+#define ASYNC_SINK_CHUNK        (1024 * 1024)
+
+/* Alignment needed for direct I/O. */
+#define ASYNC_SINK_ALIGN        4096
+
+/* Disk space reserved ahead of the write position. */
+#define ASYNC_SINK_RESERVE      (256ULL * 1024 * 1024)
+
+
+async_file_sink_sptr make_async_file_sink(size_t itemsize,
+                                          const std::string &filename,
+                                          size_t buffer_size, size_t backlog)
+{
+    return gnuradio::get_initial_sptr(new async_file_sink(itemsize, filename,
+                                                          buffer_size, backlog));
+}
+
+async_file_sink::async_file_sink(size_t itemsize, const std::string &filename,
+                                 size_t buffer_size, size_t backlog)
+    : gr::sync_block ("async_file_sink",
+          gr::io_signature::make(1, 1, itemsize),
+          gr::io_signature::make(0, 0, 0)),
+      d_itemsize(itemsize),
+      d_buf(0),
+      d_fd(-1),
+      d_direct(false),
+      d_head(0),
+      d_tail(0),
+      d_dropped(0),
+      d_writing(false),
+      d_open_pending(false),
+      d_finished(false),
+      d_write_errors(0),
+      d_start(0),
+      d_reserved(0),
+      d_running(true)
+{
+    // whole blocks so that a block never wraps around
+    d_size = std::max<size_t>(4, (buffer_size + ASYNC_SINK_CHUNK - 1) / ASYNC_SINK_CHUNK);
+    d_size *= ASYNC_SINK_CHUNK;
+
+    // one more block because the oldest data is discarded in blocks
+    if (backlog > 0)
+        d_backlog = std::min(d_size, (backlog / ASYNC_SINK_CHUNK + 2) * ASYNC_SINK_CHUNK);
+    else
+        d_backlog = d_size;
+
+    if (!filename.empty())
+    {
+        if (!open_file(filename))
+            throw std::runtime_error("can't open file " + filename + ": " + strerror(errno));
+        d_writing = true;
+    }
+
+    if (posix_memalign((void **)&d_buf, ASYNC_SINK_ALIGN, d_size) != 0)
+    {
+        if (d_fd >= 0)
+            ::close(d_fd);
+        throw std::runtime_error("can't allocate recording buffer");
+    }
+
+    d_thread = std::thread(&async_file_sink::writer_thread, this);
+}
+
+async_file_sink::~async_file_sink()
+{
+    close();
+    d_thread.join();
+    free(d_buf);
+}
+
+/*! \brief Copy the samples to the ring buffer.
+ *
+ * Only this thread moves d_head and only the writer thread moves d_tail, so
+ * no lock is needed. Before a file is opened the writer thread is idle and
+ * this thread discards the oldest blocks so that at most d_backlog bytes
+ * are kept. After open() the buffer is handed over to the writer thread at
+ * the start of the next call, when this thread is not using the tail.
+ */
+int async_file_sink::work(int noutput_items,
+                          gr_vector_const_void_star &input_items,
+                          gr_vector_void_star &output_items)
+{
+    const char *in = (const char *) input_items[0];
+    uint64_t    head = d_head.load(std::memory_order_relaxed);
+    uint64_t    tail = d_tail.load(std::memory_order_acquire);
+    bool        writing = d_writing.load(std::memory_order_acquire);
+    size_t      space, items, len, pos, first;
+    (void) output_items;
+
+    if (!writing && d_open_pending.load(std::memory_order_acquire))
+    {
+        // the file starts with the data that is still in the buffer
+        start_writing(tail);
+        writing = true;
+    }
+
+    if (!writing)
+    {
+        uint64_t need = head + (uint64_t)noutput_items * d_itemsize;
+
+        // keep the tail on a block boundary but never pass the block being
+        // filled
+        if (need - tail > d_backlog)
+        {
+            tail = need - d_backlog + ASYNC_SINK_CHUNK - 1;
+            tail -= tail % ASYNC_SINK_CHUNK;
+            tail = std::min(tail, head - head % ASYNC_SINK_CHUNK);
+            d_tail.store(tail, std::memory_order_relaxed);
+        }
+    }
+
+    space = d_size - (size_t)(head - tail);
+    items = std::min<size_t>(noutput_items, space / d_itemsize);
+    len = items * d_itemsize;
+    pos = (size_t)(head % d_size);
+    first = std::min(len, d_size - pos);
+
+    memcpy(d_buf + pos, in, first);
+    memcpy(d_buf, in + first, len - first);
+    d_head.store(head + len, std::memory_order_release);
+
+    d_dropped += noutput_items - items;
+
+    // wake up the writer once a block is ready
+    if (writing && (head + len) / ASYNC_SINK_CHUNK != head / ASYNC_SINK_CHUNK)
+        d_cond.notify_one();
+
+    return noutput_items;
+}
+
+/*! \brief Open the file of a pre-trigger sink.
+ *  \param filename The name of the file. An existing file is overwritten.
+ *  \returns True if the file was opened.
+ *
+ * The data in the buffer is written to the beginning of the file, followed
+ * by all new samples. The buffer is handed over to the writer thread by the
+ * next call to work(), or by close() if the block has been disconnected
+ * before that.
+ */
+bool async_file_sink::open(const std::string &filename)
+{
+    if (d_writing || d_open_pending)
+        return false;
+
+    if (!open_file(filename))
+    {
+        std::cout << __func__ << ": can't open file " << filename << ": "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+
+    d_open_pending.store(true, std::memory_order_release);
+
+    return true;
+}
+
+/*! \brief Let the writer thread write the buffer from start on.
+ *
+ * Called by the thread that owns the tail while no file is written.
+ */
+void async_file_sink::start_writing(uint64_t start)
+{
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_start = start;
+        d_writing = true;
+        d_open_pending = false;
+    }
+    d_cond.notify_one();
+}
+
+/*! \brief Write the remaining data and close the file.
+ *
+ * Returns immediately, the writer thread writes the rest of the buffer and
+ * closes the file. Use is_finished() to check when this is done; the
+ * destructor waits for it. Call this after the block has been disconnected
+ * from the flow graph.
+ */
+void async_file_sink::close()
+{
+    // opened but work() has not been called since
+    if (!d_writing && d_open_pending)
+        start_writing(d_tail.load(std::memory_order_acquire));
+
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (!d_running)
+            return;
+        d_running = false;
+    }
+    d_cond.notify_one();
+}
+
+/*! \brief Number of items in the file.
+ *
+ * Before the file is opened, this is the number of items in the buffer.
+ */
+uint64_t async_file_sink::get_items() const
+{
+    uint64_t head = d_head;
+    uint64_t start = d_writing ? d_start : d_tail.load();
+
+    return (head - start) / d_itemsize;
+}
+
+/*! \brief Buffer fill level between 0 and 1. */
+float async_file_sink::get_fill() const
+{
+    uint64_t tail = d_tail;
+    uint64_t head = d_head;
+
+    return (float)(head - tail) / (float)d_size;
+}
+
+/*! \brief Writer thread.
+ *
+ * Writes complete blocks while recording and waits as long as no file is
+ * open. The buffer position d_start is written at the beginning of the
+ * file. When the sink is closed the rest of the buffer is flushed and the
+ * file is closed.
+ */
+void async_file_sink::writer_thread()
+{
+    bool running = true;
+    bool writing = false;
+
+    while (running)
+    {
+        {
+            std::unique_lock<std::mutex> lock(d_mutex);
+            d_cond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !d_running || (d_writing &&
+                       d_head - d_tail >= (uint64_t)ASYNC_SINK_CHUNK);
+            });
+            running = d_running;
+            writing = d_writing;
+        }
+
+        if (!writing)
+            continue;
+
+        uint64_t tail = d_tail.load(std::memory_order_relaxed);
+        while (d_head.load(std::memory_order_acquire) - tail >= ASYNC_SINK_CHUNK)
+        {
+            reserve(tail - d_start + ASYNC_SINK_CHUNK);
+            write_block(d_buf + tail % d_size, ASYNC_SINK_CHUNK, tail - d_start);
+            tail += ASYNC_SINK_CHUNK;
+            d_tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    if (writing)
+        flush();
+
+    if (d_fd >= 0)
+        ::close(d_fd);
+    d_fd = -1;
+    d_finished = true;
+}
+
+/*! \brief Write the last partial block.
+ *
+ * The block is padded to the alignment, written and the file is truncated
+ * to the real length. close() is called after the block has been
+ * disconnected so d_head doesn't move anymore.
+ */
+void async_file_sink::flush()
+{
+    uint64_t tail = d_tail.load(std::memory_order_relaxed);
+    size_t   rest = (size_t)(d_head.load(std::memory_order_acquire) - tail);
+
+    if (rest > 0)
+    {
+        size_t padded = (rest + ASYNC_SINK_ALIGN - 1) & ~(size_t)(ASYNC_SINK_ALIGN - 1);
+
+        write_block(d_buf + tail % d_size, padded, tail - d_start);
+        d_tail.store(tail + rest, std::memory_order_release);
+    }
+
+    if (ftruncate(d_fd, (off_t)(d_tail.load() - d_start)) != 0)
+        std::cout << __func__ << ": " << strerror(errno) << std::endl;
+}
+
+/*! \brief Open the file for writing.
+ *  \returns False if the file can not be opened, errno is set.
+ */
+bool async_file_sink::open_file(const std::string &filename)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#ifdef O_DIRECT
+    d_fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+    d_direct = (d_fd >= 0);
+#endif
+    if (d_fd < 0)
+        d_fd = ::open(filename.c_str(), flags, 0644);
+    if (d_fd < 0)
+        return false;
+
+#ifdef F_NOCACHE
+    fcntl(d_fd, F_NOCACHE, 1);
+#endif
+
+    return true;
+}
+
+/*! \brief Write a block to the file.
+ *  \param data The data.
+ *  \param len The number of bytes.
+ *  \param offset The position of the block in the file.
+ *
+ * Falls back to normal writes if the file system rejects direct I/O. On
+ * errors the data is lost and counted, but the writer continues so that the
+ * buffer doesn't fill up.
+ */
+void async_file_sink::write_block(const char *data, size_t len, uint64_t offset)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::pwrite(d_fd, data, len, (off_t)offset);
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+#ifdef O_DIRECT
+            if (errno == EINVAL && d_direct)
+            {
+                fcntl(d_fd, F_SETFL, fcntl(d_fd, F_GETFL) & ~O_DIRECT);
+                d_direct = false;
+                continue;
+            }
+#endif
+            if (d_write_errors == 0)
+                std::cout << __func__ << ": " << strerror(errno) << std::endl;
+            d_write_errors++;
+            return;
+        }
+
+        data += n;
+        len -= n;
+        offset += n;
+    }
+}
+
+/*! \brief Reserve disk space ahead of the write position.
+ *
+ * Reduces fragmentation and file system work during the recording. The
+ * file size is not changed so the recording can be played back while it
+ * is being written.
+ */
+void async_file_sink::reserve(uint64_t end)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    if (end <= d_reserved)
+        return;
+
+    if (fallocate(d_fd, FALLOC_FL_KEEP_SIZE, (off_t)d_reserved,
+                  (off_t)ASYNC_SINK_RESERVE) == 0)
+        d_reserved += ASYNC_SINK_RESERVE;
+    else
+        d_reserved = UINT64_MAX;    // not supported, don't try again
+#else
+    (void) end;
+#endif
+}
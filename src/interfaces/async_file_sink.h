@@ -0,0 +1,144 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef ASYNC_FILE_SINK_H
+#define ASYNC_FILE_SINK_H
+
+#include <gnuradio/sync_block.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+
+class async_file_sink;
+
+typedef boost::shared_ptr<async_file_sink> async_file_sink_sptr;
+
+
+/*! \brief Return a shared_ptr to a new instance of async_file_sink.
+ *  \param itemsize The size of an item in bytes.
+ *  \param filename The name of the file. An existing file is overwritten.
+ *                  If empty, the file is opened later using open().
+ *  \param buffer_size The size of the ring buffer in bytes.
+ *  \param backlog The amount of data kept before the file is opened, in
+ *                 bytes. 0 to use the whole buffer.
+ *  \throws std::runtime_error if the file can not be opened.
+ */
+async_file_sink_sptr make_async_file_sink(size_t itemsize,
+                                          const std::string &filename,
+                                          size_t buffer_size,
+                                          size_t backlog = 0);
+
+
+/*! \brief File sink with a writer thread.
+ *  \ingroup IO
+ *
+ * The work function only copies the samples into a large ring buffer and
+ * never waits for the disk. A writer thread empties the buffer in blocks of
+ * ASYNC_SINK_CHUNK bytes. If the disk can not keep up and the buffer is
+ * full, the samples that don't fit are dropped and counted instead of
+ * blocking the flow graph. Failed writes are counted as well; each block
+ * is written at its own file offset so that a failed block leaves a gap
+ * instead of shifting the rest of the recording.
+ *
+ * close() only tells the writer thread to write the rest of the buffer and
+ * close the file; is_finished() tells when it is done.
+ *
+ * Where supported the file is opened with O_DIRECT (Linux) or F_NOCACHE
+ * (Mac OS X) and disk space is reserved ahead of the write position. The
+ * buffer and the blocks are aligned so that direct writes are possible.
+ *
+ * When created without a file name the sink works as a pre-trigger buffer
+ * ("time machine"): the ring holds the most recent backlog bytes and the
+ * oldest blocks are discarded. When a file is opened later the data
+ * already in the ring is written first, followed by the new samples, so the
+ * file starts up to one backlog before the trigger without any gap. The
+ * rest of the ring absorbs disk delays as during a normal recording.
+ * Nothing is allocated after the sink has been created.
+ *
+ * open() only opens the file; the next call to work() hands the buffer over
+ * to the writer thread, so the flow graph doesn't have to be locked.
+ */
+class async_file_sink : public gr::sync_block
+{
+    friend async_file_sink_sptr make_async_file_sink(size_t itemsize,
+                                                     const std::string &filename,
+                                                     size_t buffer_size,
+                                                     size_t backlog);
+
+protected:
+    async_file_sink(size_t itemsize, const std::string &filename,
+                    size_t buffer_size, size_t backlog);
+
+public:
+    ~async_file_sink();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+    bool open(const std::string &filename);
+    void close();
+
+    bool     is_writing() const { return d_writing || d_open_pending; }
+    bool     is_finished() const { return d_finished; }
+    uint64_t get_items() const;
+    uint64_t get_dropped() const { return d_dropped; }
+    uint64_t get_write_errors() const { return d_write_errors; }
+    float    get_fill() const;
+
+private:
+    size_t          d_itemsize;     /*! Item size in bytes. */
+    char           *d_buf;          /*! The ring buffer. */
+    size_t          d_size;         /*! Size of the ring buffer. */
+    size_t          d_backlog;      /*! Bytes kept before the file is opened. */
+    int             d_fd;           /*! File descriptor. */
+    bool            d_direct;       /*! File is opened for direct I/O. */
+
+    std::atomic<uint64_t>   d_head;     /*! Bytes written to the buffer. */
+    std::atomic<uint64_t>   d_tail;     /*! Bytes written to the file. */
+    std::atomic<uint64_t>   d_dropped;  /*! Items dropped. */
+    std::atomic<bool>       d_writing;  /*! The writer thread owns the tail. */
+    std::atomic<bool>       d_open_pending; /*! File opened, not handed over yet. */
+    std::atomic<bool>       d_finished; /*! The writer thread is done. */
+    std::atomic<uint64_t>   d_write_errors; /*! Failed writes. */
+    uint64_t                d_start;    /*! Buffer position of the file start. */
+
+    uint64_t        d_reserved;     /*! Bytes of disk space reserved. */
+
+    std::mutex              d_mutex;
+    std::condition_variable d_cond;
+    std::thread             d_thread;   /*! Writer thread. */
+    bool                    d_running;
+
+    bool open_file(const std::string &filename);
+    void start_writing(uint64_t start);
+    void writer_thread();
+    void flush();
+    void write_block(const char *data, size_t len, uint64_t offset);
+    void reserve(uint64_t end);
+};
+
+#endif /* ASYNC_FILE_SINK_H */
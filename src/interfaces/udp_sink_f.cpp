@@ -25,6 +25,8 @@
 #include <gnuradio/blocks/udp_sink.h>
 #include <gnuradio/io_signature.h>
 
+#include <algorithm>
+
 #include "udp_sink_f.h"
 
 
@@ -43,20 +45,45 @@ static const int MAX_IN = 2;  /*!< Maximum number of input streams. */
 static const int MIN_OUT = 0; /*!< Minimum number of output streams. */
 static const int MAX_OUT = 0; /*!< Maximum number of output streams. */
 
+#ifdef GQRX_OS_MACX
+// There seems to be excessive packet loss (even to localhost) on OS X
+// unless the buffer size is limited.
+#define UDP_MAX_PAYLOAD 512
+#else
+#define UDP_MAX_PAYLOAD 1472
+#endif
+
+/* Audio duration per packet at low sample rates (seconds). */
+#define UDP_PACKET_TIME 0.02
+
+/*! \brief Select the UDP payload size for a stream.
+ *
+ * The payload is limited to UDP_PACKET_TIME of audio so that low sample
+ * rates do not add latency.
+ */
+static int udp_payload_size(float audio_rate, bool stereo)
+{
+    int frame = sizeof(short) * (stereo ? 2 : 1);
+    int size = frame * (int)(audio_rate * UDP_PACKET_TIME);
+
+    size = std::max(std::min(size, UDP_MAX_PAYLOAD), 64);
+
+    return size - size % frame;
+}
+
 udp_sink_f::udp_sink_f()
     : gr::hier_block2("udp_sink_f",
                       gr::io_signature::make(MIN_IN, MAX_IN, sizeof(float)),
-                      gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float)))
+                      gr::io_signature::make(MIN_OUT, MAX_OUT, sizeof(float))),
+      d_audio_rate(48000.0),
+      d_streaming(false),
+      d_port(7355),
+      d_stereo(false)
 {
 
     d_f2s = gr::blocks::float_to_short::make(1, 32767);
-#ifdef GQRX_OS_MACX
-    // There seems to be excessive packet loss (even to localhost) on OS X
-    // unless the buffer size is limited.
-    d_sink = gr::blocks::udp_sink::make(sizeof(short), "localhost", 7355, 512);
-#else
-    d_sink = gr::blocks::udp_sink::make(sizeof(short), "localhost", 7355);
-#endif
+    d_sink = gr::blocks::udp_sink::make(sizeof(short), "localhost", 7355,
+                                        UDP_MAX_PAYLOAD);
     d_sink->disconnect();
 
     d_inter = gr::blocks::interleave::make(sizeof(float));
@@ -78,8 +105,15 @@ udp_sink_f::~udp_sink_f()
  */
 void udp_sink_f::start_streaming(const std::string host, int port, bool stereo)
 {
+    d_host = host;
+    d_port = port;
+    d_stereo = stereo;
+    d_streaming = true;
+
     lock();
     disconnect_all();
+    d_sink = gr::blocks::udp_sink::make(sizeof(short), host, port,
+                                        udp_payload_size(d_audio_rate, stereo));
 
     if (stereo)
     {
@@ -95,13 +129,13 @@ void udp_sink_f::start_streaming(const std::string host, int port, bool stereo)
         connect(self(), 1, d_null0, 0);
     }
     unlock();
-
-    d_sink->connect(host, port);
 }
 
 
 void udp_sink_f::stop_streaming(void)
 {
+    d_streaming = false;
+
     lock();
     disconnect_all();
     connect(self(), 0, d_null0, 0);
@@ -110,3 +144,16 @@ void udp_sink_f::stop_streaming(void)
 
     d_sink->disconnect();
 }
+
+/*! \brief Set the sample rate of the audio stream.
+ *  \param audio_rate The new sample rate.
+ *
+ * The rate is only used to select the packet size. An active stream is
+ * restarted with the new packet size.
+ */
+void udp_sink_f::set_audio_rate(float audio_rate)
+{
+    d_audio_rate = audio_rate;
+    if (d_streaming)
+        start_streaming(d_host, d_port, d_stereo);
+}
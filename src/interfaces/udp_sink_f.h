@@ -45,6 +45,8 @@ public:
     void start_streaming(const std::string host, int port, bool stereo);
     void stop_streaming(void);
 
+    void set_audio_rate(float audio_rate);
+
 private:
     gr::blocks::udp_sink::sptr        d_sink;   /*!< The gnuradio UDP sink. */
     gr::blocks::float_to_short::sptr  d_f2s;    /*!< Converts float to short. */
@@ -52,6 +54,12 @@ private:
     gr::blocks::null_sink::sptr       d_null0;  /*!< Null sink for mono. */
     gr::blocks::null_sink::sptr       d_null1;  /*!< Null sink for mono. */
 
+    float        d_audio_rate;  /*!< Sample rate of the stream. */
+    bool         d_streaming;   /*!< Streaming is active. */
+    std::string  d_host;        /*!< Current client. */
+    int          d_port;
+    bool         d_stereo;
+
 };
 
 
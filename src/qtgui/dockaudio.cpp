@@ -33,6 +33,9 @@ DockAudio::DockAudio(QWidget *parent) :
     QDockWidget(parent),
     ui(new Ui::DockAudio),
     autoSpan(true),
+    sample_rate(48000),
+    fft_min(0),
+    fft_max(24000),
     rx_freq(144000000)
 {
     ui->setupUi(this);
@@ -87,6 +90,13 @@ DockAudio::~DockAudio()
 
 void DockAudio::setFftRange(quint64 minf, quint64 maxf)
 {
+    fft_min = minf;
+    fft_max = maxf;
+
+    // the span can not exceed the audio bandwidth
+    maxf = qMin(maxf, (quint64)(sample_rate / 2));
+    minf = qMin(minf, maxf);
+
     if (autoSpan)
     {
         qint32 span = (qint32)(maxf - minf);
@@ -98,6 +108,21 @@ void DockAudio::setFftRange(quint64 minf, quint64 maxf)
     }
 }
 
+/*! \brief Set the audio sample rate.
+ *  \param rate The new sample rate in Hz.
+ *
+ * The last FFT range is applied again so that it fits the new bandwidth.
+ */
+void DockAudio::setSampleRate(int rate)
+{
+    if (rate <= 0 || rate == sample_rate)
+        return;
+
+    sample_rate = rate;
+    ui->audioSpectrum->setSampleRate(rate);
+    setFftRange(fft_min, fft_max);
+}
+
 void DockAudio::setNewFftData(float *fftData, int size)
 {
     ui->audioSpectrum->setNewFftData(fftData, size);
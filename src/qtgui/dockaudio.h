@@ -51,6 +51,7 @@ public:
     ~DockAudio();
 
     void setFftRange(quint64 minf, quint64 maxf);
+    void setSampleRate(int rate);
     void setNewFftData(float *fftData, int size);
     int  fftRate() const { return 10; }
 
@@ -123,6 +124,9 @@ private:
     bool           udp_stereo;   /*! Enable stereo streaming for UDP. */
 
     bool           autoSpan;     /*! Whether to allow mode-dependent auto span. */
+    int            sample_rate;  /*! Audio sample rate. */
+    quint64        fft_min;      /*! Requested lower edge of the FFT span. */
+    quint64        fft_max;      /*! Requested upper edge of the FFT span. */
 
     qint64         rx_freq;      /*! RX frequency used in filenames. */
 };
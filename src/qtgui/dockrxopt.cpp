@@ -86,6 +86,8 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     ui->nbOptButton->setMinimumSize(32, 24);
     ui->nb2Button->setMinimumSize(32, 24);
     ui->nb1Button->setMinimumSize(32, 24);
+    ui->nrButton->setMinimumSize(32, 24);
+    ui->anfButton->setMinimumSize(32, 24);
 #endif
 
     ui->filterFreq->setup(7, -filterOffsetRange/2, filterOffsetRange/2, 1,
@@ -114,6 +116,7 @@ DockRxOpt::DockRxOpt(qint64 filterOffsetRange, QWidget *parent) :
     // Noise blanker options
     nbOpt = new CNbOptions(this);
     connect(nbOpt, SIGNAL(thresholdChanged(int,double)), this, SLOT(nbOpt_thresholdChanged(int,double)));
+    connect(nbOpt, SIGNAL(nrStrengthChanged(double)), this, SLOT(nbOpt_nrStrengthChanged(double)));
 }
 
 DockRxOpt::~DockRxOpt()
@@ -726,6 +729,18 @@ void DockRxOpt::on_nb2Button_toggled(bool checked)
     emit noiseBlankerChanged(2, checked, (float) nbOpt->nbThreshold(2));
 }
 
+/** Noise reduction button has been toggled. */
+void DockRxOpt::on_nrButton_toggled(bool checked)
+{
+    emit noiseReductionChanged(checked, (float) nbOpt->nrStrength());
+}
+
+/** Automatic notch button has been toggled. */
+void DockRxOpt::on_anfButton_toggled(bool checked)
+{
+    emit autoNotchToggled(checked);
+}
+
 /** Noise blanker threshold has been changed. */
 void DockRxOpt::nbOpt_thresholdChanged(int nbid, double value)
 {
@@ -735,6 +750,12 @@ void DockRxOpt::nbOpt_thresholdChanged(int nbid, double value)
         emit noiseBlankerChanged(nbid, ui->nb2Button->isChecked(), (float) value);
 }
 
+/** Noise reduction strength has been changed. */
+void DockRxOpt::nbOpt_nrStrengthChanged(double value)
+{
+    emit noiseReductionChanged(ui->nrButton->isChecked(), (float) value);
+}
+
 void DockRxOpt::on_nbOptButton_clicked()
 {
     nbOpt->show();
@@ -177,6 +177,12 @@ signals:
     /** Signal emitted when noise blanker status has changed. */
     void noiseBlankerChanged(int nbid, bool on, float threshold);
 
+    /** Signal emitted when noise reduction status has changed. */
+    void noiseReductionChanged(bool on, float strength);
+
+    /** Signal emitted when the automatic notch is toggled. */
+    void autoNotchToggled(bool on);
+
     void cwOffsetChanged(int offset);
 
 private slots:
@@ -193,10 +199,13 @@ private slots:
     void on_sqlSpinBox_valueChanged(double value);
     void on_nb1Button_toggled(bool checked);
     void on_nb2Button_toggled(bool checked);
+    void on_nrButton_toggled(bool checked);
+    void on_anfButton_toggled(bool checked);
     void on_nbOptButton_clicked();
 
     // Signals coming from noise blanker pop-up
     void nbOpt_thresholdChanged(int nbid, double value);
+    void nbOpt_nrStrengthChanged(double value);
 
     // Signals coming from demod options pop-up
     void demodOpt_fmMaxdevSelected(float max_dev);
@@ -175,6 +175,18 @@ CIoConfig::CIoConfig(QSettings * settings,
     ui->outDevCombo->setEditable(true);
 #endif // WITH_PULSEAUDIO
 
+    // Output rate; 0 selects the lowest rate that fits the demodulator
+    int outrate = settings->value("output/sample_rate", 48000).toInt();
+    ui->outSrCombo->addItem(tr("Auto"), 0);
+    ui->outSrCombo->addItem("8 kHz", 8000);
+    ui->outSrCombo->addItem("16 kHz", 16000);
+    ui->outSrCombo->addItem("24 kHz", 24000);
+    ui->outSrCombo->addItem("32 kHz", 32000);
+    ui->outSrCombo->addItem("44.1 kHz", 44100);
+    ui->outSrCombo->addItem("48 kHz", 48000);
+    idx = ui->outSrCombo->findData(outrate);
+    ui->outSrCombo->setCurrentIndex(idx < 0 ? ui->outSrCombo->count() - 1 : idx);
+
     // Signals and slots
     connect(this, SIGNAL(accepted()), this, SLOT(saveConfig()));
     connect(ui->inDevCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(inputDeviceSelected(int)));
@@ -286,6 +298,12 @@ void CIoConfig::saveConfig()
         m_settings->remove("output/device");
     }
 
+    int_val = ui->outSrCombo->itemData(ui->outSrCombo->currentIndex()).toInt();
+    if (int_val == 48000)
+        m_settings->remove("output/sample_rate");
+    else
+        m_settings->setValue("output/sample_rate", int_val);
+
     // input settings
     m_settings->setValue("input/device", ui->inDevEdit->text());  // "OK" button disabled if empty
 
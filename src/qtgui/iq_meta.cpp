@@ -0,0 +1,392 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QList>
+#include <algorithm>
+#include <limits>
+
+#include "bookmarks.h"
+#include "iq_meta.h"
+
+/* Time between index entries in milliseconds. */
+#define IQ_META_INDEX_MS 1000
+
+
+/*! \brief SigMF datatype of a recording format. */
+static QString datatypeFromFormat(const QString &format)
+{
+    if (format == "cs16")
+        return "ci16_le";
+    if (format == "cs8")
+        return "ci8";
+    if (format == "cf16")
+        return "cf16_le";
+
+    return "cf32_le";
+}
+
+/*! \brief Recording format of a SigMF datatype or empty if unsupported. */
+static QString formatFromDatatype(const QString &datatype)
+{
+    if (datatype == "cf32_le")
+        return "fc";
+    if (datatype == "ci16_le")
+        return "cs16";
+    if (datatype == "ci8")
+        return "cs8";
+    if (datatype == "cf16_le")
+        return "cf16";
+
+    return QString();
+}
+
+static bool annotationLessThan(const QJsonValue &a, const QJsonValue &b)
+{
+    return a.toObject()["core:sample_start"].toDouble() <
+           b.toObject()["core:sample_start"].toDouble();
+}
+
+
+CIqMeta::CIqMeta() :
+    sample_rate(0.0),
+    active(false),
+    time_offset(0),
+    next_index(0),
+    capture_freq(0.0),
+    capture_start(0),
+    sql_start(-1),
+    sql_low(0.0),
+    sql_high(0.0)
+{
+}
+
+/*! \brief Name of the metadata file belonging to a recording. */
+QString CIqMeta::metaFileName(const QString &datafile)
+{
+    QFileInfo info(datafile);
+
+    return info.path() + "/" + info.completeBaseName() + ".sigmf-meta";
+}
+
+/*! \brief Start a new recording.
+ *  \param datafile The name of the I/Q file.
+ *  \param format The sample format (fc, cs16, cs8 or cf16).
+ *  \param sample_rate The sample rate of the recording.
+ *  \param frequency The center frequency in Hz.
+ *  \param start_time The time of the first sample.
+ *  \param hw Description of the input device.
+ *
+ * The metadata file is written immediately so that it exists even if the
+ * recording is not stopped properly. The start time may be in the past if
+ * the recording begins with buffered samples.
+ */
+void CIqMeta::start(const QString &datafile, const QString &format,
+                    double sample_rate, double frequency,
+                    const QDateTime &start_time, const QString &hw)
+{
+    QJsonObject ext;
+    QJsonObject cap;
+
+    meta_file = metaFileName(datafile);
+    data_format = format;
+    this->sample_rate = sample_rate;
+
+    ext["name"] = "gqrx";
+    ext["version"] = "1.0.0";
+    ext["optional"] = true;
+
+    global = QJsonObject();
+    global["core:datatype"] = datatypeFromFormat(format);
+    global["core:sample_rate"] = sample_rate;
+    global["core:version"] = "1.0.0";
+    global["core:dataset"] = QFileInfo(datafile).fileName();
+    global["core:hw"] = hw;
+    global["core:recorder"] = QString("%1 %2")
+            .arg(QCoreApplication::applicationName())
+            .arg(QCoreApplication::applicationVersion());
+    global["core:extensions"] = QJsonArray() << ext;
+
+    cap["core:sample_start"] = 0;
+    cap["core:frequency"] = frequency;
+    cap["core:datetime"] = start_time.toUTC()
+            .toString("yyyy-MM-dd'T'HH:mm:ss.zzz'Z'");
+
+    captures = QJsonArray() << cap;
+    annotations = QJsonArray();
+    index = QJsonArray();
+    index.append(QJsonArray() << 0.0 << 0.0);
+
+    capture_freq = frequency;
+    capture_start = 0;
+    sql_start = -1;
+    next_index = IQ_META_INDEX_MS;
+    time_offset = qMax<qint64>(0, start_time.msecsTo(QDateTime::currentDateTimeUtc()));
+    timer.start();
+    active = true;
+
+    save();
+}
+
+/*! \brief Update the metadata of the ongoing recording.
+ *  \param sample The number of samples recorded so far.
+ *  \param frequency The current center frequency.
+ *  \param sql_open Whether the squelch is open.
+ *  \param chan_low Lower edge of the receiver channel.
+ *  \param chan_high Upper edge of the receiver channel.
+ *
+ * This should be called periodically, e.g. every 100 ms. A new capture
+ * segment is started when the frequency changes and the periods with open
+ * squelch are stored as annotations.
+ */
+void CIqMeta::update(quint64 sample, double frequency, bool sql_open,
+                     double chan_low, double chan_high)
+{
+    if (!active)
+        return;
+
+    if (frequency != capture_freq)
+    {
+        QJsonObject cap;
+
+        endCapture(sample);
+
+        cap["core:sample_start"] = (double)sample;
+        cap["core:frequency"] = frequency;
+        cap["core:datetime"] = QDateTime::currentDateTimeUtc()
+                .toString("yyyy-MM-dd'T'HH:mm:ss.zzz'Z'");
+        captures.append(cap);
+
+        capture_freq = frequency;
+        capture_start = sample;
+    }
+
+    if (sql_open && sql_start < 0)
+    {
+        sql_start = (qint64)sample;
+        sql_low = chan_low;
+        sql_high = chan_high;
+    }
+    else if (!sql_open && sql_start >= 0)
+    {
+        addAnnotation(sql_start, sample - sql_start, "Squelch open",
+                      sql_low, sql_high);
+        sql_start = -1;
+    }
+
+    qint64 ms = elapsed();
+    if (ms >= next_index)
+    {
+        index.append(QJsonArray() << ms / 1000.0 << (double)sample);
+        next_index = ms - ms % IQ_META_INDEX_MS + IQ_META_INDEX_MS;
+    }
+}
+
+/*! \brief Finish the recording and write the metadata file.
+ *  \param sample The total number of samples recorded.
+ */
+void CIqMeta::stop(quint64 sample)
+{
+    if (!active)
+        return;
+
+    endCapture(sample);
+    index.append(QJsonArray() << elapsed() / 1000.0 << (double)sample);
+    active = false;
+
+    save();
+}
+
+/*! \brief Time since the first sample of the recording in ms. */
+qint64 CIqMeta::elapsed() const
+{
+    return timer.elapsed() + time_offset;
+}
+
+/*! \brief Close the current capture segment.
+ *
+ * Bookmarks within the captured bandwidth are added as annotations covering
+ * the whole segment.
+ */
+void CIqMeta::endCapture(quint64 sample)
+{
+    if (sql_start >= 0)
+    {
+        addAnnotation(sql_start, sample - sql_start, "Squelch open",
+                      sql_low, sql_high);
+        sql_start = -1;
+    }
+
+    if (sample <= capture_start)
+        return;
+
+    QList<BookmarkInfo> bookmarks = Bookmarks::Get().getBookmarksInRange(
+                (qint64)(capture_freq - sample_rate / 2.0),
+                (qint64)(capture_freq + sample_rate / 2.0));
+
+    for (int i = 0; i < bookmarks.size(); i++)
+    {
+        const BookmarkInfo &info = bookmarks.at(i);
+
+        addAnnotation(capture_start, sample - capture_start, info.name,
+                      info.frequency - info.bandwidth / 2,
+                      info.frequency + info.bandwidth / 2);
+    }
+}
+
+void CIqMeta::addAnnotation(quint64 start, quint64 count, const QString &label,
+                            double low, double high)
+{
+    QJsonObject ann;
+
+    ann["core:sample_start"] = (double)start;
+    ann["core:sample_count"] = (double)count;
+    ann["core:label"] = label;
+    if (high > low)
+    {
+        ann["core:freq_lower_edge"] = low;
+        ann["core:freq_upper_edge"] = high;
+    }
+
+    annotations.append(ann);
+}
+
+/*! \brief Write the metadata file.
+ *
+ * SigMF requires the annotations to be sorted by their first sample.
+ */
+bool CIqMeta::save()
+{
+    QJsonObject root;
+    QJsonObject glob = global;
+    QList<QJsonValue> sorted;
+    QJsonArray ann;
+
+    for (int i = 0; i < annotations.size(); i++)
+        sorted.append(annotations.at(i));
+    std::stable_sort(sorted.begin(), sorted.end(), annotationLessThan);
+    for (int i = 0; i < sorted.size(); i++)
+        ann.append(sorted.at(i));
+
+    glob["gqrx:index"] = index;
+    root["global"] = glob;
+    root["captures"] = captures;
+    root["annotations"] = ann;
+
+    QFile file(meta_file);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Couldn't write" << meta_file;
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+
+    return true;
+}
+
+/*! \brief Load the metadata of a recording.
+ *  \param datafile The name of the I/Q file.
+ *  \returns True if a metadata file with a supported format and a valid
+ *           index was found. Otherwise all fields are cleared.
+ */
+bool CIqMeta::load(const QString &datafile)
+{
+    index_ms.clear();
+    data_format.clear();
+    sample_rate = 0.0;
+
+    QFile file(metaFileName(datafile));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+    if (!doc.isObject())
+        return false;
+
+    QJsonObject glob = doc.object()["global"].toObject();
+    data_format = formatFromDatatype(glob["core:datatype"].toString());
+    sample_rate = glob["core:sample_rate"].toDouble();
+
+    bool ok = !data_format.isEmpty() && sample_rate > 0.0;
+
+    QJsonArray idx = glob["gqrx:index"].toArray();
+    for (int i = 0; ok && i < idx.size(); i++)
+    {
+        QJsonArray entry = idx.at(i).toArray();
+
+        if (entry.size() != 2 || !entry.at(0).isDouble() || !entry.at(1).isDouble())
+        {
+            ok = false;
+            break;
+        }
+        index_ms.append(qMakePair((qint64)(entry.at(0).toDouble() * 1000.0),
+                                  (qint64)entry.at(1).toDouble()));
+    }
+
+    // sampleAt() needs the index in time order
+    if (ok && !std::is_sorted(index_ms.begin(), index_ms.end()))
+        ok = false;
+
+    // don't leave a partial result behind
+    if (!ok)
+    {
+        index_ms.clear();
+        data_format.clear();
+        sample_rate = 0.0;
+    }
+
+    return ok;
+}
+
+/*! \brief Get the sample recorded at a given time.
+ *  \param msec Time since the start of the recording in ms.
+ *  \returns The sample offset or -1 if the recording has no index.
+ *
+ * The offset is interpolated between the index entries and extrapolated
+ * using the sample rate after the last one.
+ */
+qint64 CIqMeta::sampleAt(qint64 msec) const
+{
+    if (index_ms.isEmpty())
+        return -1;
+
+    QVector<QPair<qint64, qint64> >::const_iterator it;
+    it = std::upper_bound(index_ms.begin(), index_ms.end(),
+                          qMakePair(msec, std::numeric_limits<qint64>::max()));
+
+    if (it == index_ms.begin())
+        return (qint64)(msec * sample_rate / 1000.0);
+
+    const QPair<qint64, qint64> &prev = *(it - 1);
+    if (it == index_ms.end() || it->first == prev.first)
+        return prev.second + (qint64)((msec - prev.first) * sample_rate / 1000.0);
+
+    return prev.second + (it->second - prev.second) * (msec - prev.first) /
+            (it->first - prev.first);
+}
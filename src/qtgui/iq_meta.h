@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef IQ_META_H
+#define IQ_META_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+
+/*! \brief SigMF metadata for I/Q recordings.
+ *
+ * The metadata is stored next to the recording in a file with the same base
+ * name and the extension .sigmf-meta. The recording itself keeps its .raw
+ * name and is referenced using core:dataset.
+ *
+ * Besides the core fields the file contains a coarse index, gqrx:index,
+ * with one [seconds, sample] pair per second of recording. This allows to
+ * seek to a point in time without scanning the data and remains correct if
+ * samples were lost during the recording.
+ */
+class CIqMeta
+{
+public:
+    CIqMeta();
+
+    /* recording */
+    void    start(const QString &datafile, const QString &format,
+                  double sample_rate, double frequency,
+                  const QDateTime &start_time, const QString &hw);
+    void    update(quint64 sample, double frequency, bool sql_open,
+                   double chan_low, double chan_high);
+    void    stop(quint64 sample);
+    bool    isActive() const { return active; }
+
+    /* playback */
+    bool    load(const QString &datafile);
+    QString format() const { return data_format; }
+    double  sampleRate() const { return sample_rate; }
+    qint64  sampleAt(qint64 msec) const;
+
+    static QString metaFileName(const QString &datafile);
+
+private:
+    bool    save();
+    void    endCapture(quint64 sample);
+    qint64  elapsed() const;
+    void    addAnnotation(quint64 start, quint64 count, const QString &label,
+                          double low, double high);
+
+private:
+    QString         meta_file;      /*!< Name of the .sigmf-meta file. */
+    QJsonObject     global;         /*!< The global object. */
+    QJsonArray      captures;       /*!< Capture segments. */
+    QJsonArray      annotations;    /*!< Annotations. */
+    QJsonArray      index;          /*!< [seconds, sample] pairs. */
+
+    QString         data_format;    /*!< Sample format (fc, cs16, ...). */
+    double          sample_rate;
+    bool            active;         /*!< A recording is in progress. */
+
+    QElapsedTimer   timer;          /*!< Time since start of recording. */
+    qint64          time_offset;    /*!< Time from the first sample to start() in ms. */
+    qint64          next_index;     /*!< Time of next index entry in ms. */
+    double          capture_freq;   /*!< Frequency of the current capture. */
+    quint64         capture_start;  /*!< First sample of the current capture. */
+    qint64          sql_start;      /*!< First sample with squelch open or -1. */
+    double          sql_low;        /*!< Channel edges while squelch is open. */
+    double          sql_high;
+
+    QVector<QPair<qint64, qint64> > index_ms;   /*!< Loaded index in ms. */
+};
+
+#endif // IQ_META_H
@@ -31,7 +31,10 @@
 #include <QTime>
 
 #include <math.h>
+#include <string.h>
+#include <vector>
 
+#include "dsp/iq_format.h"
 #include "iq_tool.h"
 #include "ui_iq_tool.h"
 
@@ -51,6 +54,12 @@ CIqTool::CIqTool(QWidget *parent) :
 
     //ui->recDirEdit->setText(QDir::currentPath());
 
+    // the short names are used in the file names
+    ui->formatCombo->addItem(tr("32 bit float"), "fc");
+    ui->formatCombo->addItem(tr("16 bit int"), "cs16");
+    ui->formatCombo->addItem(tr("8 bit int"), "cs8");
+    ui->formatCombo->addItem(tr("16 bit float"), "cf16");
+
     recdir = new QDir(QDir::homePath(), "*.raw");
 
     error_palette = new QPalette();
@@ -58,12 +67,20 @@ CIqTool::CIqTool(QWidget *parent) :
 
     timer = new QTimer(this);
     connect(timer, SIGNAL(timeout()), this, SLOT(timeoutFunction()));
+
+    // the time machine buffer is reallocated on each change; wait until the
+    // user has stopped stepping through the values
+    tm_timer = new QTimer(this);
+    tm_timer->setSingleShot(true);
+    tm_timer->setInterval(500);
+    connect(tm_timer, SIGNAL(timeout()), this, SLOT(tmTimeout()));
 }
 
 CIqTool::~CIqTool()
 {
     timer->stop();
     delete timer;
+    delete tm_timer;
     delete ui;
     delete recdir;
     delete error_palette;
@@ -84,6 +101,48 @@ void CIqTool::setSampleRate(qint64 sr)
     }
 }
 
+/*! \brief Show the state of the current recording.
+ *  \param samples The number of samples recorded.
+ *  \param clipped The number of clipped I or Q values.
+ *  \param dropped The number of samples lost because the disk was too slow.
+ *  \param fill The fill level of the recording buffer (0 to 1).
+ *  \param write_errors The number of blocks that could not be written.
+ */
+void CIqTool::setRecordingStats(quint64 samples, quint64 clipped,
+                                quint64 dropped, float fill,
+                                quint64 write_errors)
+{
+    QString text = tr("Buffer: %1%").arg(fill * 100.f, 0, 'f', 0);
+
+    if (dropped > 0)
+        text += tr("  Dropped: %1").arg(dropped);
+
+    if (write_errors > 0)
+        text += tr("  Write errors: %1").arg(write_errors);
+
+    if (samples > 0 && ui->formatCombo->currentData().toString() != "fc")
+        text += tr("  Clipped: %1 (%2%)")
+                .arg(clipped)
+                .arg(50.0 * clipped / samples, 0, 'f', 3);
+
+    ui->statsLabel->setText(text);
+}
+
+/*! \brief Show the state of a stopped recording.
+ *  \param finished False while the rest of the buffer is being written.
+ *  \param write_errors The number of blocks that could not be written.
+ */
+void CIqTool::setRecordingFinished(bool finished, quint64 write_errors)
+{
+    if (!finished)
+        ui->statsLabel->setText(tr("Writing file..."));
+    else if (write_errors > 0)
+        ui->statsLabel->setText(tr("Write errors: %1, file is incomplete")
+                                .arg(write_errors));
+    else
+        ui->statsLabel->setText(tr("File complete"));
+}
+
 /*! \brief Slot activated when the user selects a file. */
 void CIqTool::on_listWidget_currentTextChanged(const QString &currentText)
 {
@@ -91,8 +150,20 @@ void CIqTool::on_listWidget_currentTextChanged(const QString &currentText)
     current_file = currentText;
     QFileInfo info(*recdir, current_file);
 
+    // Get format and rate from the SigMF metadata, if any
+    if (meta.load(info.absoluteFilePath()))
+    {
+        sample_rate = (int)meta.sampleRate();
+        current_format = meta.format();
+    }
+    else
+    {
+        sample_rate = sampleRateFromFileName(currentText);
+        current_format = formatFromFileName(currentText);
+    }
+
     // Get duration of selected recording and update label
-    sample_rate = sampleRateFromFileName(currentText);
+    bytes_per_sample = iq_format_size(iq_format_from_name(current_format.toStdString()));
     rec_len = (int)(info.size() / (sample_rate * bytes_per_sample));
 
     refreshTimeWidgets();
@@ -127,7 +198,7 @@ void CIqTool::on_playButton_clicked(bool checked)
             ui->listWidget->setEnabled(false);
             ui->recButton->setEnabled(false);
             emit startPlayback(recdir->absoluteFilePath(current_file),
-                               (float)sample_rate);
+                               (float)sample_rate, current_format);
         }
     }
     else
@@ -185,7 +256,8 @@ void CIqTool::on_plotButton_clicked()
     int chunk_size = sample_rate / plot_spp * bytes_per_sample;
 
     char *readbuf = (char*)malloc(chunk_size);
-    struct iqt_cplx *cplxbuf = (iqt_cplx *)readbuf;  // FIXME: We assume gr_complex
+    std::vector<float> cplxbuf(2 * (chunk_size / bytes_per_sample));
+    iq_format fmt = iq_format_from_name(current_format.toStdString());
 
     qDebug() << "*** NUM POINTS:" << num_points;
     qDebug() << "*** CHUNK SIZE:" << chunk_size;
@@ -193,23 +265,44 @@ void CIqTool::on_plotButton_clicked()
     for (int i = 0; i < num_points; i++)
     {
         // read data chunk
-        if (!file->seek(i * chunk_size))
+        if (!file->seek(sampleOffset(i * plot_spp) * bytes_per_sample))
         {
             continue;
         }
 
         qint64 read = file->read(readbuf, chunk_size);
+        int nsamples = read / bytes_per_sample;
+
+        if (nsamples <= 0)
+            continue;
+
+        // convert to float I/Q
+        switch (fmt)
+        {
+        case IQ_FMT_CS16:
+            iq_decoder_c::decode_cs16(&cplxbuf[0], (const int16_t *)readbuf, 2 * nsamples);
+            break;
+        case IQ_FMT_CS8:
+            iq_decoder_c::decode_cs8(&cplxbuf[0], (const int8_t *)readbuf, 2 * nsamples);
+            break;
+        case IQ_FMT_CF16:
+            iq_decoder_c::decode_cf16(&cplxbuf[0], (const uint16_t *)readbuf, 2 * nsamples);
+            break;
+        default:
+            memcpy(&cplxbuf[0], readbuf, nsamples * bytes_per_sample);
+            break;
+        }
 
         // calculate average and max
         float val, avg=0.0, max=0.0;
-        for (int j = 0; j < read/bytes_per_sample; j++)
+        for (int j = 0; j < nsamples; j++)
         {
-            val = fabs(cplxbuf[j].re);
+            val = fabs(cplxbuf[2 * j]);
             avg += val;
             if (val > max)
                 max = val;
         }
-        avg /= read/bytes_per_sample;
+        avg /= nsamples;
 
         qDebug() << i << "   AVG:" << avg << "  MAX:" << max;
 
@@ -230,8 +323,7 @@ void CIqTool::on_slider_valueChanged(int value)
 {
     refreshTimeWidgets();
 
-    qint64 seek_pos = (qint64)(value)*sample_rate;
-    emit seek(seek_pos);
+    emit seek(sampleOffset(value));
 }
 
 
@@ -243,8 +335,11 @@ void CIqTool::on_recButton_clicked(bool checked)
     if (checked)
     {
         ui->playButton->setEnabled(false);
+        ui->formatCombo->setEnabled(false);
+        ui->statsLabel->clear();
         //ui->plotButton->setEnabled(false);
-        emit startRecording(recdir->path());
+        emit startRecording(recdir->path(),
+                            ui->formatCombo->currentData().toString());
 
         refreshDir();
         ui->listWidget->setCurrentRow(ui->listWidget->count()-1);
@@ -252,11 +347,56 @@ void CIqTool::on_recButton_clicked(bool checked)
     else
     {
         ui->playButton->setEnabled(true);
+        ui->formatCombo->setEnabled(true);
         //ui->plotButton->setEnabled(true);
         emit stopRecording();
     }
 }
 
+/*! \brief Start recording unless already recording or playing. */
+void CIqTool::startRecorder()
+{
+    if (is_recording || is_playing)
+        return;
+
+    ui->recButton->setChecked(true);
+    on_recButton_clicked(true);
+}
+
+/*! \brief Stop the ongoing recording, if any. */
+void CIqTool::stopRecorder()
+{
+    if (!is_recording)
+        return;
+
+    ui->recButton->setChecked(false);
+    on_recButton_clicked(false);
+}
+
+/*! \brief New sample format selected.
+ *
+ * The time machine uses the recording format and has to be recreated.
+ */
+void CIqTool::on_formatCombo_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    tm_timer->start();
+}
+
+/*! \brief New time machine length selected. */
+void CIqTool::on_timeMachineSpin_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    tm_timer->start();
+}
+
+/*! \brief Apply the time machine settings once they stopped changing. */
+void CIqTool::tmTimeout(void)
+{
+    emit timeMachineChanged(ui->timeMachineSpin->value(),
+                            ui->formatCombo->currentData().toString());
+}
+
 /*! \brief Cancel a recording.
  *
  * This slot can be activated to cancel an ongoing recording. Cancelling an
@@ -269,6 +409,7 @@ void CIqTool::cancelRecording()
 {
     ui->recButton->setChecked(false);
     ui->playButton->setEnabled(true);
+    ui->formatCombo->setEnabled(true);
     is_recording = false;
 }
 
@@ -307,6 +448,17 @@ void CIqTool::saveSettings(QSettings *settings)
     else
         settings->remove("baseband/rec_dir");
 
+    QString format = ui->formatCombo->currentData().toString();
+    if (format != "fc")
+        settings->setValue("baseband/rec_format", format);
+    else
+        settings->remove("baseband/rec_format");
+
+    int tm = ui->timeMachineSpin->value();
+    if (tm > 0)
+        settings->setValue("baseband/time_machine", tm);
+    else
+        settings->remove("baseband/time_machine");
 }
 
 void CIqTool::readSettings(QSettings *settings)
@@ -317,6 +469,13 @@ void CIqTool::readSettings(QSettings *settings)
     // Location of baseband recordings
     QString dir = settings->value("baseband/rec_dir", QDir::homePath()).toString();
     ui->recDirEdit->setText(dir);
+
+    QString format = settings->value("baseband/rec_format", "fc").toString();
+    int idx = ui->formatCombo->findData(format);
+    if (idx >= 0)
+        ui->formatCombo->setCurrentIndex(idx);
+
+    ui->timeMachineSpin->setValue(settings->value("baseband/time_machine", 0).toInt());
 }
 
 
@@ -429,6 +588,36 @@ void CIqTool::refreshTimeWidgets(void)
 }
 
 
+/*! \brief Extract sample format from file name
+ *
+ * Recordings made before the format was selectable end in _fc.raw.
+ */
+QString CIqTool::formatFromFileName(const QString &filename)
+{
+    QStringList list = QFileInfo(filename).completeBaseName().split('_');
+
+    // gqrx_yymmdd_hhmmss_freq_samprate_format.raw
+    if (list.size() < 6)
+        return "fc";
+
+    return list.at(5);
+}
+
+/*! \brief Sample offset of a point in time in the selected recording.
+ *
+ * Uses the index in the SigMF metadata if available, otherwise the nominal
+ * sample rate.
+ */
+qint64 CIqTool::sampleOffset(int seconds) const
+{
+    qint64 offset = meta.sampleAt((qint64)seconds * 1000);
+
+    if (offset < 0)
+        offset = (qint64)seconds * sample_rate;
+
+    return offset;
+}
+
 /*! \brief Extract sample rate from file name */
 qint64 CIqTool::sampleRateFromFileName(const QString &filename)
 {
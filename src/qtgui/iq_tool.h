@@ -32,18 +32,13 @@
 #include <QString>
 #include <QTimer>
 
+#include "iq_meta.h"
+
 namespace Ui {
     class CIqTool;
 }
 
 
-struct iqt_cplx
-{
-    float re;
-    float im;
-};
-
-
 /*! \brief User interface for I/Q recording and playback. */
 class CIqTool : public QDialog
 {
@@ -54,6 +49,10 @@ public:
     ~CIqTool();
 
     void setSampleRate(qint64 sr);
+    void setRecordingStats(quint64 samples, quint64 clipped,
+                           quint64 dropped, float fill,
+                           quint64 write_errors);
+    void setRecordingFinished(bool finished, quint64 write_errors);
     
     void closeEvent(QCloseEvent *event);
     void showEvent(QShowEvent * event);
@@ -62,30 +61,39 @@ public:
     void readSettings(QSettings *settings);
 
 signals:
-    void startRecording(const QString recdir);
+    void startRecording(const QString recdir, const QString format);
     void stopRecording();
-    void startPlayback(const QString filename, float samprate);
+    void startPlayback(const QString filename, float samprate,
+                       const QString format);
     void stopPlayback();
     void seek(qint64 seek_pos);
+    void timeMachineChanged(int seconds, const QString format);
 
 public slots:
     void cancelRecording();
     void cancelPlayback();
+    void startRecorder();
+    void stopRecorder();
 
 private slots:
     void on_recDirEdit_textChanged(const QString &text);
     void on_recDirButton_clicked();
     void on_recButton_clicked(bool checked);
+    void on_formatCombo_currentIndexChanged(int index);
+    void on_timeMachineSpin_valueChanged(int value);
     void on_playButton_clicked(bool checked);
     void on_plotButton_clicked();
     void on_slider_valueChanged(int value);
     void on_listWidget_currentTextChanged(const QString &currentText);
     void timeoutFunction(void);
+    void tmTimeout(void);
 
 private:
     void refreshDir(void);
     void refreshTimeWidgets(void);
     qint64 sampleRateFromFileName(const QString &filename);
+    QString formatFromFileName(const QString &filename);
+    qint64 sampleOffset(int seconds) const;
 
 
 private:
@@ -93,13 +101,16 @@ private:
 
     QDir        *recdir;
     QTimer      *timer;
+    QTimer      *tm_timer;      /*!< Delays time machine changes. */
     QPalette    *error_palette; /*!< Palette used to indicate an error. */
 
     QString current_file;      /*!< Selected file in file browser. */
+    QString current_format;    /*!< Sample format of the selected file. */
+    CIqMeta meta;              /*!< Metadata of the selected file. */
 
     bool    is_recording;
     bool    is_playing;
-    int     bytes_per_sample;  /*!< Bytes per sample (fc = 4) */
+    int     bytes_per_sample;  /*!< Bytes per sample (fc = 8) */
     int     sample_rate;       /*!< Current sample rate. */
     int     rec_len;           /*!< Length of a recording in seconds */
     int     plot_spp;          /*!< [seconds / datapoint] */
@@ -55,6 +55,11 @@ double CNbOptions::nbThreshold(int nbid)
         return ui->nb2Threshold->value();
 }
 
+double CNbOptions::nrStrength()
+{
+    return ui->nrStrength->value();
+}
+
 void CNbOptions::on_nb1Threshold_valueChanged(double val)
 {
     emit thresholdChanged(1, val);
@@ -64,3 +69,8 @@ void CNbOptions::on_nb2Threshold_valueChanged(double val)
 {
     emit thresholdChanged(2, val);
 }
+
+void CNbOptions::on_nrStrength_valueChanged(double val)
+{
+    emit nrStrengthChanged(val);
+}
@@ -41,13 +41,16 @@ public:
     void closeEvent(QCloseEvent *event);
 
     double nbThreshold(int nbid);
+    double nrStrength();
 
 signals:
     void thresholdChanged(int nb, double val);
+    void nrStrengthChanged(double val);
 
 private slots:
     void on_nb1Threshold_valueChanged(double val);
     void on_nb2Threshold_valueChanged(double val);
+    void on_nrStrength_valueChanged(double val);
 
 private:
     Ui::CNbOptions *ui;
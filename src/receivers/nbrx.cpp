@@ -20,6 +20,7 @@
  * the Free Software Foundation, Inc., 51 Franklin Street,
  * Boston, MA 02110-1301, USA.
  */
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "receivers/nbrx.h"
@@ -27,6 +28,45 @@
 // NB: Remeber to adjust filter ranges in MainWindow
 #define PREF_QUAD_RATE  96000.f
 
+// Lowest channel rate, used for CW and SSB
+#define MIN_CHAN_RATE   12000.f
+
+// Filter edge relative to the channel rate for switching up and down
+#define CHAN_RATE_UP    0.4
+#define CHAN_RATE_DOWN  0.3
+
+/*! \brief Lowest channel rate where the filter edge stays below a limit. */
+static float nbrx_lowest_rate(double edge, double limit)
+{
+    float  rate = MIN_CHAN_RATE;
+
+    while ((rate < PREF_QUAD_RATE) && (edge > limit * rate))
+        rate *= 2.f;
+
+    return rate;
+}
+
+/*! \brief Select the channel rate for a filter.
+ *  \param current The current channel rate, 0 if there is none.
+ *
+ * The channel rate is the lowest of 12, 24, 48 and 96 kHz where the filter
+ * including its transition band and the CW offset stays below 0.4 times
+ * the channel rate. A higher current rate is only left when the filter
+ * also stays below 0.3 times the lower rate, so that moving the filter
+ * edges around a limit doesn't rebuild the receiver on every step.
+ */
+static float nbrx_chan_rate(double low, double high, double tw, double cw_offset,
+                            float current)
+{
+    double edge = std::max(std::abs(low), std::abs(high)) + tw + std::abs(cw_offset);
+    float  rate = nbrx_lowest_rate(edge, CHAN_RATE_UP);
+
+    if (current > rate)
+        rate = std::min(current, nbrx_lowest_rate(edge, CHAN_RATE_DOWN));
+
+    return rate;
+}
+
 nbrx_sptr make_nbrx(float quad_rate, float audio_rate)
 {
     return gnuradio::get_initial_sptr(new nbrx(quad_rate, audio_rate));
@@ -37,51 +77,35 @@ nbrx::nbrx(float quad_rate, float audio_rate)
       d_running(false),
       d_quad_rate(quad_rate),
       d_audio_rate(audio_rate),
+      d_filter_low(-5000.0),
+      d_filter_high(5000.0),
+      d_filter_tw(1000.0),
+      d_cw_offset(0.0),
+      d_sql_level(-150.0),
+      d_sql_alpha(0.001),
+      d_max_dev(5000.0),
+      d_tau(75.0e-6),
+      d_dcr(true),
+      d_nr_on(false),
+      d_nr_strength(0.5),
+      d_anf_on(false),
       d_demod(NBRX_DEMOD_FM)
 {
-    iq_resamp = make_resampler_cc(PREF_QUAD_RATE/d_quad_rate);
-
-    nb = make_rx_nb_cc(PREF_QUAD_RATE, 3.3, 2.5);
-    filter = make_rx_filter(PREF_QUAD_RATE, -5000.0, 5000.0, 1000.0);
-    agc = make_rx_agc_cc(PREF_QUAD_RATE, true, -100, 0, 0, 500, false);
-    sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
-    meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
+    d_chan_rate = nbrx_chan_rate(d_filter_low, d_filter_high, d_filter_tw,
+                                 d_cw_offset, 0.f);
+    iq_resamp = make_resampler_cc(d_chan_rate/d_quad_rate);
+
+    nb = make_rx_nb_cc(d_chan_rate, 3.3, 2.5);
+    agc = make_rx_agc_cc(d_chan_rate, true, -100, 0, 0, 500, false);
+    meter = make_rx_meter_c(DETECTOR_TYPE_RMS, d_chan_rate);
+    meter->set_integration_time(RX_METER_INT_TIME);
     demod_raw = gr::blocks::complex_to_float::make(1);
     demod_ssb = gr::blocks::complex_to_real::make(1);
-    demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 5000.0, 75.0e-6);
-    demod_am = make_rx_demod_am(PREF_QUAD_RATE, true);
+    anf_in = gr::blocks::float_to_complex::make(1);
+    anf_out = gr::blocks::complex_to_real::make(1);
 
-    audio_rr0.reset();
-    audio_rr1.reset();
-    if (d_audio_rate != PREF_QUAD_RATE)
-    {
-        std::cout << "Resampling audio " << PREF_QUAD_RATE << " -> "
-                  << d_audio_rate << std::endl;
-        audio_rr0 = make_resampler_ff(d_audio_rate/PREF_QUAD_RATE);
-        audio_rr1 = make_resampler_ff(d_audio_rate/PREF_QUAD_RATE);
-    }
-
-    demod = demod_fm;
-    connect(self(), 0, iq_resamp, 0);
-    connect(iq_resamp, 0, nb, 0);
-    connect(nb, 0, filter, 0);
-    connect(filter, 0, meter, 0);
-    connect(filter, 0, sql, 0);
-    connect(sql, 0, agc, 0);
-    connect(agc, 0, demod, 0);
-
-    if (audio_rr0)
-    {
-        connect(demod, 0, audio_rr0, 0);
-
-        connect(audio_rr0, 0, self(), 0); // left  channel
-        connect(audio_rr0, 0, self(), 1); // right channel
-    }
-    else
-    {
-        connect(demod, 0, self(), 0);
-        connect(demod, 0, self(), 1);
-    }
+    create_blocks();
+    connect_blocks();
 }
 
 bool nbrx::start()
@@ -107,25 +131,47 @@ void nbrx::set_quad_rate(float quad_rate)
 #endif
         d_quad_rate = quad_rate;
         lock();
-        iq_resamp->set_rate(PREF_QUAD_RATE/d_quad_rate);
+        iq_resamp->set_rate(d_chan_rate/d_quad_rate);
         unlock();
     }
 }
 
 void nbrx::set_audio_rate(float audio_rate)
 {
-    (void) audio_rate;
-    std::cout << "**** FIXME: nbrx::set_audio_rate() not implemented" << std::endl;
+    if (std::abs(d_audio_rate-audio_rate) > 0.5)
+    {
+#ifndef QT_NO_DEBUG_OUTPUT
+        std::cout << "Changing NB_RX audio rate: "  << d_audio_rate << " -> " << audio_rate << std::endl;
+#endif
+        lock();
+        disconnect_all();
+        d_audio_rate = audio_rate;
+        create_audio_blocks();
+        connect_blocks();
+        unlock();
+    }
 }
 
 void nbrx::set_filter(double low, double high, double tw)
 {
-    filter->set_param(low, high, tw);
+    d_filter_low = low;
+    d_filter_high = high;
+    d_filter_tw = tw;
+    if (!update_chan_rate())
+        filter->set_param(low, high, tw);
 }
 
 void nbrx::set_cw_offset(double offset)
 {
-    filter->set_cw_offset(offset);
+    d_cw_offset = offset;
+    if (!update_chan_rate())
+        filter->set_cw_offset(offset);
+}
+
+void nbrx::prefetch_filter(double low, double high, double tw)
+{
+    rx_filter::prefetch(nbrx_chan_rate(low, high, tw, d_cw_offset, d_chan_rate),
+                        low, high, tw, d_cw_offset);
 }
 
 float nbrx::get_signal_level(bool dbfs)
@@ -137,6 +183,11 @@ float nbrx::get_signal_level(bool dbfs)
 
 }
 
+void nbrx::get_signal_stats(rx_meter_stats &stats)
+{
+    meter->get_stats(stats);
+}
+
 void nbrx::set_nb_on(int nbid, bool on)
 {
     if (nbid == 1)
@@ -153,13 +204,46 @@ void nbrx::set_nb_threshold(int nbid, float threshold)
         nb->set_threshold2(threshold);
 }
 
+void nbrx::set_nr_on(bool on)
+{
+    if (on == d_nr_on)
+        return;
+
+    lock();
+    disconnect_all();
+    d_nr_on = on;
+    connect_blocks();
+    unlock();
+}
+
+void nbrx::set_nr_strength(float strength)
+{
+    d_nr_strength = strength;
+    nr->set_strength(strength);
+}
+
+void nbrx::set_anf_on(bool on)
+{
+    if (on == d_anf_on)
+        return;
+
+    lock();
+    disconnect_all();
+    d_anf_on = on;
+    anf->reset();
+    connect_blocks();
+    unlock();
+}
+
 void nbrx::set_sql_level(double level_db)
 {
+    d_sql_level = level_db;
     sql->set_threshold(level_db);
 }
 
 void nbrx::set_sql_alpha(double alpha)
 {
+    d_sql_alpha = alpha;
     sql->set_alpha(alpha);
 }
 
@@ -195,78 +279,148 @@ void nbrx::set_agc_manual_gain(int gain)
 
 void nbrx::set_demod(int rx_demod)
 {
-    nbrx_demod current_demod = d_demod;
-
     /* check if new demodulator selection is valid */
     if ((rx_demod < NBRX_DEMOD_NONE) || (rx_demod >= NBRX_DEMOD_NUM))
         return;
 
-    if (rx_demod == current_demod) {
+    if (rx_demod == d_demod) {
         /* nothing to do */
         return;
     }
 
-    disconnect(agc, 0, demod, 0);
-    if (audio_rr0)
-    {
-        if (current_demod == NBRX_DEMOD_NONE)
-        {
-            disconnect(demod, 0, audio_rr0, 0);
-            disconnect(demod, 1, audio_rr1, 0);
+    d_demod = (nbrx_demod) rx_demod;
+    disconnect_all();
+    anf->reset();   // AM and SSB notch different signals
+    connect_blocks();
+}
 
-            disconnect(audio_rr0, 0, self(), 0);
-            disconnect(audio_rr1, 0, self(), 1);
-        }
-        else
-        {
-            disconnect(demod, 0, audio_rr0, 0);
+void nbrx::set_fm_maxdev(float maxdev_hz)
+{
+    d_max_dev = maxdev_hz;
+    demod_fm->set_max_dev(maxdev_hz);
+}
 
-            disconnect(audio_rr0, 0, self(), 0);
-            disconnect(audio_rr0, 0, self(), 1);
-        }
-    }
-    else
+void nbrx::set_fm_deemph(double tau)
+{
+    d_tau = tau;
+    demod_fm->set_tau(tau);
+}
+
+void nbrx::set_am_dcr(bool enabled)
+{
+    d_dcr = enabled;
+    demod_am->set_dcr(enabled);
+}
+
+/*! \brief Switch to a new channel rate if the filter requires it.
+ *  \returns True if the blocks were recreated with the current filter.
+ */
+bool nbrx::update_chan_rate()
+{
+    float rate = nbrx_chan_rate(d_filter_low, d_filter_high, d_filter_tw,
+                                d_cw_offset, d_chan_rate);
+
+    if (rate == d_chan_rate)
+        return false;
+
+#ifndef QT_NO_DEBUG_OUTPUT
+    std::cout << "Changing NB_RX channel rate: "  << d_chan_rate << " -> " << rate << std::endl;
+#endif
+    lock();
+    disconnect_all();
+    d_chan_rate = rate;
+    iq_resamp->set_rate(d_chan_rate/d_quad_rate);
+    create_blocks();
+    connect_blocks();
+    unlock();
+
+    return true;
+}
+
+/*! \brief Create the blocks running at the channel rate.
+ *
+ * The noise blanker, meter and AGC keep their settings, only their sample
+ * rate is updated.
+ */
+void nbrx::create_blocks()
+{
+    nb->set_sample_rate(d_chan_rate);
+    meter->set_sample_rate(d_chan_rate);
+    agc->set_sample_rate(d_chan_rate);
+
+    filter = make_rx_filter(d_chan_rate, d_filter_low, d_filter_high, d_filter_tw);
+    if (d_cw_offset != 0.0)
+        filter->set_cw_offset(d_cw_offset);
+    sql = make_rx_sql_cc(d_chan_rate, d_sql_level, d_sql_alpha);
+    anf = make_rx_anf_cc(d_chan_rate);
+    demod_fm = make_rx_demod_fm(d_chan_rate, d_max_dev, d_tau);
+    demod_am = make_rx_demod_am(d_chan_rate, d_dcr);
+    create_audio_blocks();
+}
+
+/*! \brief Create the blocks running at the audio rate.
+ *
+ * The audio resamplers are only created if the audio rate differs from the
+ * channel rate.
+ */
+void nbrx::create_audio_blocks()
+{
+    nr = make_rx_nr_ff(d_audio_rate, d_nr_strength);
+
+    audio_rr0.reset();
+    audio_rr1.reset();
+    if (d_audio_rate != d_chan_rate)
     {
-        if (current_demod == NBRX_DEMOD_NONE)
-        {
-            disconnect(demod, 0, self(), 0);
-            disconnect(demod, 1, self(), 1);
-        }
-        else
-        {
-            disconnect(demod, 0, self(), 0);
-            disconnect(demod, 0, self(), 1);
-        }
+        std::cout << "Resampling audio " << d_chan_rate << " -> "
+                  << d_audio_rate << std::endl;
+        audio_rr0 = make_resampler_ff(d_audio_rate/d_chan_rate);
+        audio_rr1 = make_resampler_ff(d_audio_rate/d_chan_rate);
     }
+}
 
-    switch (rx_demod) {
+/*! \brief Connect the blocks for the current demodulator. */
+void nbrx::connect_blocks()
+{
+    switch (d_demod) {
 
     case NBRX_DEMOD_NONE:
-        d_demod = NBRX_DEMOD_NONE;
         demod = demod_raw;
         break;
 
     case NBRX_DEMOD_SSB:
-        d_demod = NBRX_DEMOD_SSB;
         demod = demod_ssb;
         break;
 
     case NBRX_DEMOD_AM:
-        d_demod = NBRX_DEMOD_AM;
         demod = demod_am;
         break;
 
     case NBRX_DEMOD_FM:
     default:
-        d_demod = NBRX_DEMOD_FM;
         demod = demod_fm;
         break;
     }
 
-    connect(agc, 0, demod, 0);
-    if (audio_rr0)
+    connect(self(), 0, iq_resamp, 0);
+    connect(iq_resamp, 0, nb, 0);
+    connect(nb, 0, filter, 0);
+    connect(filter, 0, meter, 0);
+    connect(filter, 0, sql, 0);
+    connect(sql, 0, agc, 0);
+
+    if (d_anf_on && (d_demod == NBRX_DEMOD_SSB))
+    {
+        connect(agc, 0, anf, 0);
+        connect(anf, 0, demod, 0);
+    }
+    else
+    {
+        connect(agc, 0, demod, 0);
+    }
+
+    if (d_demod == NBRX_DEMOD_NONE)
     {
-        if (d_demod == NBRX_DEMOD_NONE)
+        if (audio_rr0)
         {
             connect(demod, 0, audio_rr0, 0);
             connect(demod, 1, audio_rr1, 0);
@@ -276,38 +430,34 @@ void nbrx::set_demod(int rx_demod)
         }
         else
         {
-            connect(demod, 0, audio_rr0, 0);
-
-            connect(audio_rr0, 0, self(), 0);
-            connect(audio_rr0, 0, self(), 1);
+            connect(demod, 0, self(), 0);
+            connect(demod, 1, self(), 1);
         }
     }
     else
     {
-        if (d_demod == NBRX_DEMOD_NONE)
+        gr::basic_block_sptr audio = demod;
+
+        // the notch would remove the AM carrier, use it on the audio
+        if (d_anf_on && (d_demod == NBRX_DEMOD_AM))
         {
-            connect(demod, 0, self(), 0);
-            connect(demod, 1, self(), 1);
+            connect(demod, 0, anf_in, 0);
+            connect(anf_in, 0, anf, 0);
+            connect(anf, 0, anf_out, 0);
+            audio = anf_out;
         }
-        else
+        if (audio_rr0)
         {
-            connect(demod, 0, self(), 0);
-            connect(demod, 0, self(), 1);
+            connect(audio, 0, audio_rr0, 0);
+            audio = audio_rr0;
+        }
+        if (d_nr_on)
+        {
+            connect(audio, 0, nr, 0);
+            audio = nr;
         }
-    }
-}
-
-void nbrx::set_fm_maxdev(float maxdev_hz)
-{
-    demod_fm->set_max_dev(maxdev_hz);
-}
-
-void nbrx::set_fm_deemph(double tau)
-{
-    demod_fm->set_tau(tau);
-}
 
-void nbrx::set_am_dcr(bool enabled)
-{
-    demod_am->set_dcr(enabled);
+        connect(audio, 0, self(), 0); // left  channel
+        connect(audio, 0, self(), 1); // right channel
+    }
 }
@@ -23,17 +23,20 @@
 #ifndef NBRX_H
 #define NBRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
 #include <gnuradio/basic_block.h>
 #include <gnuradio/blocks/complex_to_float.h>
 #include <gnuradio/blocks/complex_to_real.h>
+#include <gnuradio/blocks/float_to_complex.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
+#include "dsp/rx_sql.h"
 #include "dsp/rx_agc_xx.h"
 #include "dsp/rx_demod_fm.h"
 #include "dsp/rx_demod_am.h"
+#include "dsp/rx_anf.h"
+#include "dsp/rx_nr.h"
 //#include "dsp/resampler_ff.h"
 #include "dsp/resampler_xx.h"
 
@@ -48,6 +51,14 @@ nbrx_sptr make_nbrx(float quad_rate, float audio_rate);
  *  \ingroup RX
  *
  * This block provides receiver for AM, narrow band FM and SSB modes.
+ *
+ * The channel is processed at 12, 24, 48 or 96 kHz depending on the filter
+ * width, so narrow filters need less processing. The blocks running at the
+ * channel rate are recreated when the filter moves to another rate.
+ *
+ * The optional automatic notch runs between the AGC and the AM and SSB
+ * demodulators. The optional noise reduction runs on the mono audio after
+ * the audio resampler. Both are only connected while they are enabled.
  */
 class nbrx : public receiver_base_cf
 {
@@ -73,14 +84,25 @@ public:
 
     void set_filter(double low, double high, double tw);
     void set_cw_offset(double offset);
+    void prefetch_filter(double low, double high, double tw);
 
     float get_signal_level(bool dbfs);
+    void get_signal_stats(rx_meter_stats &stats);
 
     /* Noise blanker */
     bool has_nb() { return true; }
     void set_nb_on(int nbid, bool on);
     void set_nb_threshold(int nbid, float threshold);
 
+    /* Noise reduction */
+    bool has_nr() { return true; }
+    void set_nr_on(bool on);
+    void set_nr_strength(float strength);
+
+    /* Automatic notch */
+    bool has_anf() { return true; }
+    void set_anf_on(bool on);
+
     /* Squelch parameter */
     bool has_sql() { return true; }
     void set_sql_level(double level_db);
@@ -107,10 +129,30 @@ public:
     void set_am_dcr(bool enabled);
 
 private:
+    bool update_chan_rate();
+    void create_blocks();
+    void create_audio_blocks();
+    void connect_blocks();
+
     bool   d_running;          /*!< Whether receiver is running or not. */
     float  d_quad_rate;        /*!< Input sample rate. */
+    float  d_chan_rate;        /*!< Channel sample rate. */
     int    d_audio_rate;       /*!< Audio output rate. */
 
+    /* settings needed to recreate the blocks */
+    double d_filter_low;
+    double d_filter_high;
+    double d_filter_tw;
+    double d_cw_offset;
+    double d_sql_level;
+    double d_sql_alpha;
+    float  d_max_dev;
+    double d_tau;
+    bool   d_dcr;
+    bool   d_nr_on;
+    float  d_nr_strength;
+    bool   d_anf_on;
+
     nbrx_demod                d_demod;    /*!< Current demodulator. */
 
     resampler_cc_sptr         iq_resamp;   /*!< Baseband resampler. */
@@ -119,13 +161,17 @@ private:
     rx_nb_cc_sptr             nb;         /*!< Noise blanker. */
     rx_meter_c_sptr           meter;      /*!< Signal strength. */
     rx_agc_cc_sptr            agc;        /*!< Receiver AGC. */
-    gr::analog::simple_squelch_cc::sptr sql;        /*!< Squelch. */
+    rx_sql_cc_sptr            sql;        /*!< Squelch. */
+    rx_anf_cc_sptr            anf;        /*!< Automatic notch. */
+    gr::blocks::float_to_complex::sptr  anf_in;     /*!< AM audio to the notch. */
+    gr::blocks::complex_to_real::sptr   anf_out;    /*!< Notched AM audio. */
     gr::blocks::complex_to_float::sptr  demod_raw;  /*!< Raw I/Q passthrough. */
     gr::blocks::complex_to_real::sptr   demod_ssb;  /*!< SSB demodulator. */
     rx_demod_fm_sptr          demod_fm;   /*!< FM demodulator. */
     rx_demod_am_sptr          demod_am;   /*!< AM demodulator. */
     resampler_ff_sptr         audio_rr0;  /*!< Audio resampler. */
     resampler_ff_sptr         audio_rr1;  /*!< Audio resampler. */
+    rx_nr_ff_sptr             nr;         /*!< Audio noise reduction. */
 
     gr::basic_block_sptr      demod;    // dummy pointer used for simplifying reconf
 };
@@ -0,0 +1,183 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <cmath>
+#include <iostream>
+#include "receivers/nbrx_fused.h"
+
+// Same channel rate as nbrx
+#define PREF_QUAD_RATE  96000.f
+
+nbrx_fused_sptr make_nbrx_fused(float quad_rate, float audio_rate)
+{
+    return gnuradio::get_initial_sptr(new nbrx_fused(quad_rate, audio_rate));
+}
+
+nbrx_fused::nbrx_fused(float quad_rate, float audio_rate)
+    : receiver_base_cf("NBRX_FUSED"),
+      d_running(false),
+      d_quad_rate(quad_rate),
+      d_audio_rate(audio_rate)
+{
+    strip = make_rx_channel_strip_cf(d_quad_rate, PREF_QUAD_RATE, d_audio_rate);
+    strip->meter()->set_integration_time(RX_METER_INT_TIME);
+
+    connect(self(), 0, strip, 0);
+    connect(strip, 0, self(), 0); // left  channel
+    connect(strip, 1, self(), 1); // right channel
+}
+
+bool nbrx_fused::start()
+{
+    d_running = true;
+
+    return true;
+}
+
+bool nbrx_fused::stop()
+{
+    d_running = false;
+
+    return true;
+}
+
+void nbrx_fused::set_quad_rate(float quad_rate)
+{
+    if (std::abs(d_quad_rate-quad_rate) > 0.5)
+    {
+#ifndef QT_NO_DEBUG_OUTPUT
+        std::cout << "Changing NBRX_FUSED quad rate: "  << d_quad_rate << " -> " << quad_rate << std::endl;
+#endif
+        d_quad_rate = quad_rate;
+        strip->set_quad_rate(d_quad_rate);
+    }
+}
+
+void nbrx_fused::set_audio_rate(float audio_rate)
+{
+    d_audio_rate = audio_rate;
+    strip->set_audio_rate(d_audio_rate);
+}
+
+void nbrx_fused::set_filter(double low, double high, double tw)
+{
+    strip->set_filter(low, high, tw);
+}
+
+void nbrx_fused::set_cw_offset(double offset)
+{
+    strip->set_cw_offset(offset);
+}
+
+void nbrx_fused::prefetch_filter(double low, double high, double tw)
+{
+    strip->prefetch_filter(low, high, tw);
+}
+
+float nbrx_fused::get_signal_level(bool dbfs)
+{
+    if (dbfs)
+        return strip->meter()->get_level_db();
+    else
+        return strip->meter()->get_level();
+}
+
+void nbrx_fused::get_signal_stats(rx_meter_stats &stats)
+{
+    strip->meter()->get_stats(stats);
+}
+
+void nbrx_fused::set_nb_on(int nbid, bool on)
+{
+    if (nbid == 1)
+        strip->nb()->set_nb1_on(on);
+    else if (nbid == 2)
+        strip->nb()->set_nb2_on(on);
+}
+
+void nbrx_fused::set_nb_threshold(int nbid, float threshold)
+{
+    if (nbid == 1)
+        strip->nb()->set_threshold1(threshold);
+    else if (nbid == 2)
+        strip->nb()->set_threshold2(threshold);
+}
+
+void nbrx_fused::set_sql_level(double level_db)
+{
+    strip->set_sql_level(level_db);
+}
+
+void nbrx_fused::set_sql_alpha(double alpha)
+{
+    strip->set_sql_alpha(alpha);
+}
+
+void nbrx_fused::set_agc_on(bool agc_on)
+{
+    strip->agc()->set_agc_on(agc_on);
+}
+
+void nbrx_fused::set_agc_hang(bool use_hang)
+{
+    strip->agc()->set_use_hang(use_hang);
+}
+
+void nbrx_fused::set_agc_threshold(int threshold)
+{
+    strip->agc()->set_threshold(threshold);
+}
+
+void nbrx_fused::set_agc_slope(int slope)
+{
+    strip->agc()->set_slope(slope);
+}
+
+void nbrx_fused::set_agc_decay(int decay_ms)
+{
+    strip->agc()->set_decay(decay_ms);
+}
+
+void nbrx_fused::set_agc_manual_gain(int gain)
+{
+    strip->agc()->set_manual_gain(gain);
+}
+
+void nbrx_fused::set_demod(int demod)
+{
+    strip->set_demod(demod);
+}
+
+void nbrx_fused::set_fm_maxdev(float maxdev_hz)
+{
+    strip->set_fm_maxdev(maxdev_hz);
+}
+
+void nbrx_fused::set_fm_deemph(double tau)
+{
+    strip->set_fm_deemph(tau);
+}
+
+void nbrx_fused::set_am_dcr(bool enabled)
+{
+    strip->set_am_dcr(enabled);
+}
@@ -0,0 +1,103 @@
+/* -*- c++ -*- */
+/*
+ * Gqrx SDR: Software defined radio receiver powered by GNU Radio and Qt
+ *           http://gqrx.dk/
+ *
+ * Copyright 2026 Gqrx developers.
+ *
+ * Gqrx is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * Gqrx is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gqrx; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef NBRX_FUSED_H
+#define NBRX_FUSED_H
+
+#include "receivers/receiver_base.h"
+#include "dsp/rx_channel_strip.h"
+
+class nbrx_fused;
+
+typedef boost::shared_ptr<nbrx_fused> nbrx_fused_sptr;
+
+/*! \brief Public constructor of nbrx_fused_sptr. */
+nbrx_fused_sptr make_nbrx_fused(float quad_rate, float audio_rate);
+
+/*! \brief Narrow band analog receiver using a single block.
+ *  \ingroup RX
+ *
+ * This receiver provides the same modes and controls as nbrx but all the
+ * processing is done by one rx_channel_strip_cf block, which reduces the
+ * overhead per receiver.
+ *
+ * Unlike nbrx the channel rate doesn't follow the filter width, the strip
+ * always runs at 96 kHz.
+ */
+class nbrx_fused : public receiver_base_cf
+{
+public:
+    nbrx_fused(float quad_rate, float audio_rate);
+    virtual ~nbrx_fused() { };
+
+    bool start();
+    bool stop();
+
+    void set_quad_rate(float quad_rate);
+    void set_audio_rate(float audio_rate);
+
+    void set_filter(double low, double high, double tw);
+    void set_cw_offset(double offset);
+    void prefetch_filter(double low, double high, double tw);
+
+    float get_signal_level(bool dbfs);
+    void get_signal_stats(rx_meter_stats &stats);
+
+    /* Noise blanker */
+    bool has_nb() { return true; }
+    void set_nb_on(int nbid, bool on);
+    void set_nb_threshold(int nbid, float threshold);
+
+    /* Squelch parameter */
+    bool has_sql() { return true; }
+    void set_sql_level(double level_db);
+    void set_sql_alpha(double alpha);
+
+    /* AGC */
+    bool has_agc() { return true; }
+    void set_agc_on(bool agc_on);
+    void set_agc_hang(bool use_hang);
+    void set_agc_threshold(int threshold);
+    void set_agc_slope(int slope);
+    void set_agc_decay(int decay_ms);
+    void set_agc_manual_gain(int gain);
+
+    void set_demod(int demod);
+
+    /* FM parameters */
+    bool has_fm() { return true; }
+    void set_fm_maxdev(float maxdev_hz);
+    void set_fm_deemph(double tau);
+
+    /* AM parameters */
+    bool has_am() { return true; }
+    void set_am_dcr(bool enabled);
+
+private:
+    bool   d_running;          /*!< Whether receiver is running or not. */
+    float  d_quad_rate;        /*!< Input sample rate. */
+    int    d_audio_rate;       /*!< Audio output rate. */
+
+    rx_channel_strip_cf_sptr  strip;    /*!< The channel strip. */
+};
+
+#endif // NBRX_FUSED_H
@@ -21,6 +21,7 @@
  * Boston, MA 02110-1301, USA.
  */
 #include <gnuradio/io_signature.h>
+#include <cstring>
 #include "receivers/receiver_base.h"
 
 
@@ -42,6 +43,13 @@ receiver_base_cf::~receiver_base_cf()
 
 }
 
+void receiver_base_cf::prefetch_filter(double low, double high, double tw)
+{
+    (void) low;
+    (void) high;
+    (void) tw;
+}
+
 bool receiver_base_cf::has_nb()
 {
     return false;
@@ -59,6 +67,31 @@ void receiver_base_cf::set_nb_threshold(int nbid, float threshold)
     (void) threshold;
 }
 
+bool receiver_base_cf::has_nr()
+{
+    return false;
+}
+
+void receiver_base_cf::set_nr_on(bool on)
+{
+    (void) on;
+}
+
+void receiver_base_cf::set_nr_strength(float strength)
+{
+    (void) strength;
+}
+
+bool receiver_base_cf::has_anf()
+{
+    return false;
+}
+
+void receiver_base_cf::set_anf_on(bool on)
+{
+    (void) on;
+}
+
 bool receiver_base_cf::has_sql()
 {
     return false;
@@ -134,10 +167,9 @@ void receiver_base_cf::set_am_dcr(bool enabled)
     (void) enabled;
 }
 
-void receiver_base_cf::get_rds_data(std::string &outbuff, int &num)
+void receiver_base_cf::get_rds_state(gr::rds::station_state &state)
 {
-        (void) outbuff;
-        (void) num;
+    memset(&state, 0, sizeof(state));
 }
 
 void receiver_base_cf::start_rds_decoder()
@@ -156,3 +188,12 @@ bool receiver_base_cf::is_rds_decoder_active()
 {
     return false;
 }
+
+void receiver_base_cf::get_rds_stats(unsigned long &good,
+                                     unsigned long &corrected,
+                                     unsigned long &failed)
+{
+    good = 0;
+    corrected = 0;
+    failed = 0;
+}
@@ -24,6 +24,11 @@
 #define RECEIVER_BASE_H
 
 #include <gnuradio/hier_block2.h>
+#include "dsp/rds/parser.h"
+#include "dsp/rx_meter.h"
+
+/*! Integration time of the signal meters in seconds. */
+#define RX_METER_INT_TIME 0.1
 
 
 class receiver_base_cf;
@@ -58,16 +63,29 @@ public:
     virtual void set_cw_offset(double offset) = 0;
 
     virtual float get_signal_level(bool dbfs) = 0;
+    virtual void get_signal_stats(rx_meter_stats &stats) = 0;
 
     virtual void set_demod(int demod) = 0;
 
     /* the rest is optional */
 
+    /* Design the taps of a filter that is likely to be used soon */
+    virtual void prefetch_filter(double low, double high, double tw);
+
     /* Noise blanker */
     virtual bool has_nb();
     virtual void set_nb_on(int nbid, bool on);
     virtual void set_nb_threshold(int nbid, float threshold);
 
+    /* Noise reduction */
+    virtual bool has_nr();
+    virtual void set_nr_on(bool on);
+    virtual void set_nr_strength(float strength);
+
+    /* Automatic notch */
+    virtual bool has_anf();
+    virtual void set_anf_on(bool on);
+
     /* Squelch parameter */
     virtual bool has_sql();
     virtual void set_sql_level(double level_db);
@@ -91,11 +109,13 @@ public:
     virtual bool has_am();
     virtual void set_am_dcr(bool enabled);
 
-    virtual void get_rds_data(std::string &outbuff, int &num);
+    virtual void get_rds_state(gr::rds::station_state &state);
     virtual void start_rds_decoder();
     virtual void stop_rds_decoder();
     virtual void reset_rds_parser();
     virtual bool is_rds_decoder_active();
+    virtual void get_rds_stats(unsigned long &good, unsigned long &corrected,
+                               unsigned long &failed);
 
 };
 
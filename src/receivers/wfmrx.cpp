@@ -26,7 +26,20 @@
 #include "receivers/wfmrx.h"
 
 #define PREF_QUAD_RATE   240e3 // Nominal channel spacing is 200 kHz
-#define PREF_MIDLE_RATE  120e3 // Midle rate for stereo decoder
+
+/*! \brief Select the channel rate for an input rate.
+ *
+ * The channel rate is the input rate divided by an integer, so the input
+ * resampler is a polyphase decimator. It is at least PREF_QUAD_RATE, lower
+ * input rates are resampled to PREF_QUAD_RATE.
+ */
+static float wfm_chan_rate(float quad_rate)
+{
+    if (quad_rate < PREF_QUAD_RATE)
+        return PREF_QUAD_RATE;
+
+    return quad_rate / floorf(quad_rate / PREF_QUAD_RATE);
+}
 
 wfmrx_sptr make_wfmrx(float quad_rate, float audio_rate)
 {
@@ -38,35 +51,25 @@ wfmrx::wfmrx(float quad_rate, float audio_rate)
       d_running(false),
       d_quad_rate(quad_rate),
       d_audio_rate(audio_rate),
+      d_filter_low(-80000.0),
+      d_filter_high(80000.0),
+      d_filter_tw(20000.0),
+      d_max_dev(75000.0),
+      d_tau(0.0),
+      d_sql_level(-150.0),
+      d_sql_alpha(0.001),
       d_demod(WFMRX_DEMOD_MONO)
 {
-    iq_resamp = make_resampler_cc(PREF_QUAD_RATE/d_quad_rate);
-
-    filter = make_rx_filter(PREF_QUAD_RATE, -80000.0, 80000.0, 20000.0);
-    sql = gr::analog::simple_squelch_cc::make(-150.0, 0.001);
-    meter = make_rx_meter_c(DETECTOR_TYPE_RMS);
-    demod_fm = make_rx_demod_fm(PREF_QUAD_RATE, 75000.0, 0.0);
-    midle_rr = make_resampler_ff(PREF_MIDLE_RATE/PREF_QUAD_RATE);
-    stereo = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true);
-    stereo_oirt = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, true, true);
-    mono   = make_stereo_demod(PREF_MIDLE_RATE, d_audio_rate, false);
+    d_chan_rate = wfm_chan_rate(d_quad_rate);
+    iq_resamp = make_resampler_cc(d_chan_rate/d_quad_rate);
 
     /* create rds blocks but dont connect them */
-    rds = make_rx_rds(PREF_QUAD_RATE);
     rds_decoder = gr::rds::decoder::make(0, 0);
     rds_parser = gr::rds::parser::make(0, 0, 0);
-    rds_store = make_rx_rds_store();
     rds_enabled = false;
 
-    connect(self(), 0, iq_resamp, 0);
-    connect(iq_resamp, 0, filter, 0);
-    connect(filter, 0, meter, 0);
-    connect(filter, 0, sql, 0);
-    connect(sql, 0, demod_fm, 0);
-    connect(demod_fm, 0, midle_rr, 0);
-    connect(midle_rr, 0, mono, 0);
-    connect(mono, 0, self(), 0); // left  channel
-    connect(mono, 1, self(), 1); // right channel
+    create_blocks();
+    connect_blocks();
 }
 
 wfmrx::~wfmrx()
@@ -97,21 +100,53 @@ void wfmrx::set_quad_rate(float quad_rate)
 #endif
         d_quad_rate = quad_rate;
         lock();
-        iq_resamp->set_rate(PREF_QUAD_RATE/d_quad_rate);
+        if (std::abs(d_chan_rate - wfm_chan_rate(d_quad_rate)) > 0.5)
+        {
+            // new rate plan, recreate the blocks running at the channel rate
+            disconnect_all();
+            d_chan_rate = wfm_chan_rate(d_quad_rate);
+            create_blocks();
+            connect_blocks();
+        }
+        iq_resamp->set_rate(d_chan_rate/d_quad_rate);
         unlock();
     }
 }
 
 void wfmrx::set_audio_rate(float audio_rate)
 {
-    (void) audio_rate;
+    if (std::abs(d_audio_rate-audio_rate) > 0.5)
+    {
+        // only the stereo decoders resample to the audio rate
+        stereo_demod_sptr demod = audio_demod();
+
+        lock();
+        disconnect(demod_fm, 0, demod, 0);
+        disconnect(demod, 0, self(), 0); // left  channel
+        disconnect(demod, 1, self(), 1); // right channel
+        d_audio_rate = audio_rate;
+        create_audio_blocks();
+        demod = audio_demod();
+        connect(demod_fm, 0, demod, 0);
+        connect(demod, 0, self(), 0); // left  channel
+        connect(demod, 1, self(), 1); // right channel
+        unlock();
+    }
 }
 
 void wfmrx::set_filter(double low, double high, double tw)
 {
+    d_filter_low = low;
+    d_filter_high = high;
+    d_filter_tw = tw;
     filter->set_param(low, high, tw);
 }
 
+void wfmrx::prefetch_filter(double low, double high, double tw)
+{
+    rx_filter::prefetch(d_chan_rate, low, high, tw, 0.0);
+}
+
 float wfmrx::get_signal_level(bool dbfs)
 {
     if (dbfs)
@@ -121,6 +156,11 @@ float wfmrx::get_signal_level(bool dbfs)
 
 }
 
+void wfmrx::get_signal_stats(rx_meter_stats &stats)
+{
+    meter->get_stats(stats);
+}
+
 /*
 void nbrx::set_nb_on(int nbid, bool on)
 {
@@ -141,11 +181,13 @@ void nbrx::set_nb_threshold(int nbid, float threshold)
 
 void wfmrx::set_sql_level(double level_db)
 {
+    d_sql_level = level_db;
     sql->set_threshold(level_db);
 }
 
 void wfmrx::set_sql_alpha(double alpha)
 {
+    d_sql_alpha = alpha;
     sql->set_alpha(alpha);
 }
 
@@ -200,19 +242,19 @@ void wfmrx::set_demod(int demod)
 
     case WFMRX_DEMOD_MONO:
     default:
-        disconnect(midle_rr, 0, mono, 0);
+        disconnect(demod_fm, 0, mono, 0);
         disconnect(mono, 0, self(), 0); // left  channel
         disconnect(mono, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO:
-        disconnect(midle_rr, 0, stereo, 0);
+        disconnect(demod_fm, 0, stereo, 0);
         disconnect(stereo, 0, self(), 0); // left  channel
         disconnect(stereo, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO_UKW:
-        disconnect(midle_rr, 0, stereo_oirt, 0);
+        disconnect(demod_fm, 0, stereo_oirt, 0);
         disconnect(stereo_oirt, 0, self(), 0); // left  channel
         disconnect(stereo_oirt, 1, self(), 1); // right channel
         break;
@@ -222,19 +264,19 @@ void wfmrx::set_demod(int demod)
 
     case WFMRX_DEMOD_MONO:
     default:
-        connect(midle_rr, 0, mono, 0);
+        connect(demod_fm, 0, mono, 0);
         connect(mono, 0, self(), 0); // left  channel
         connect(mono, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO:
-        connect(midle_rr, 0, stereo, 0);
+        connect(demod_fm, 0, stereo, 0);
         connect(stereo, 0, self(), 0); // left  channel
         connect(stereo, 1, self(), 1); // right channel
         break;
 
     case WFMRX_DEMOD_STEREO_UKW:
-        connect(midle_rr, 0, stereo_oirt, 0);
+        connect(demod_fm, 0, stereo_oirt, 0);
         connect(stereo_oirt, 0, self(), 0); // left  channel
         connect(stereo_oirt, 1, self(), 1); // right channel
         break;
@@ -247,17 +289,19 @@ void wfmrx::set_demod(int demod)
 
 void wfmrx::set_fm_maxdev(float maxdev_hz)
 {
+    d_max_dev = maxdev_hz;
     demod_fm->set_max_dev(maxdev_hz);
 }
 
 void wfmrx::set_fm_deemph(double tau)
 {
+    d_tau = tau;
     demod_fm->set_tau(tau);
 }
 
-void wfmrx::get_rds_data(std::string &outbuff, int &num)
+void wfmrx::get_rds_state(gr::rds::station_state &state)
 {
-    rds_store->get_message(outbuff, num);
+    rds_parser->get_state(state);
 }
 
 void wfmrx::start_rds_decoder()
@@ -265,7 +309,6 @@ void wfmrx::start_rds_decoder()
     connect(demod_fm, 0, rds, 0);
     connect(rds, 0, rds_decoder, 0);
     msg_connect(rds_decoder, "out", rds_parser, "in");
-    msg_connect(rds_parser, "out", rds_store, "store");
     rds_enabled=true;
 }
 
@@ -275,7 +318,6 @@ void wfmrx::stop_rds_decoder()
     disconnect(demod_fm, 0, rds, 0);
     disconnect(rds, 0, rds_decoder, 0);
     msg_disconnect(rds_decoder, "out", rds_parser, "in");
-    msg_disconnect(rds_parser, "out", rds_store, "store");
     unlock();
     rds_enabled=false;
 }
@@ -289,3 +331,71 @@ bool wfmrx::is_rds_decoder_active()
 {
     return rds_enabled;
 }
+
+/*! \brief Get the RDS block statistics.
+ *  \param good Number of error free blocks.
+ *  \param corrected Number of blocks with corrected burst errors.
+ *  \param failed Number of blocks that could not be corrected.
+ */
+void wfmrx::get_rds_stats(unsigned long &good, unsigned long &corrected,
+                          unsigned long &failed)
+{
+    rds_decoder->get_stats(good, corrected, failed);
+}
+
+/*! \brief Create the blocks running at the channel rate. */
+void wfmrx::create_blocks()
+{
+    filter = make_rx_filter(d_chan_rate, d_filter_low, d_filter_high, d_filter_tw);
+    meter = make_rx_meter_c(DETECTOR_TYPE_RMS, d_chan_rate);
+    meter->set_integration_time(RX_METER_INT_TIME);
+    sql = make_rx_sql_cc(d_chan_rate, d_sql_level, d_sql_alpha);
+    // the stereo and RDS subcarriers need the precise discriminator
+    demod_fm = make_rx_demod_fm(d_chan_rate, d_max_dev, d_tau, true);
+    rds = make_rx_rds(d_chan_rate);
+    create_audio_blocks();
+}
+
+/*! \brief Create the stereo decoders, which resample to the audio rate. */
+void wfmrx::create_audio_blocks()
+{
+    stereo = make_stereo_demod(d_chan_rate, d_audio_rate, true);
+    stereo_oirt = make_stereo_demod(d_chan_rate, d_audio_rate, true, true);
+    mono   = make_stereo_demod(d_chan_rate, d_audio_rate, false);
+}
+
+/*! \brief The stereo decoder of the current demodulator. */
+stereo_demod_sptr wfmrx::audio_demod() const
+{
+    switch (d_demod) {
+    case WFMRX_DEMOD_STEREO:
+        return stereo;
+    case WFMRX_DEMOD_STEREO_UKW:
+        return stereo_oirt;
+    case WFMRX_DEMOD_MONO:
+    default:
+        return mono;
+    }
+}
+
+/*! \brief Connect the blocks for the current demodulator. */
+void wfmrx::connect_blocks()
+{
+    stereo_demod_sptr demod = audio_demod();
+
+    connect(self(), 0, iq_resamp, 0);
+    connect(iq_resamp, 0, filter, 0);
+    connect(filter, 0, meter, 0);
+    connect(filter, 0, sql, 0);
+    connect(sql, 0, demod_fm, 0);
+    connect(demod_fm, 0, demod, 0);
+    connect(demod, 0, self(), 0); // left  channel
+    connect(demod, 1, self(), 1); // right channel
+
+    if (rds_enabled)
+    {
+        connect(demod_fm, 0, rds, 0);
+        connect(rds, 0, rds_decoder, 0);
+        msg_connect(rds_decoder, "out", rds_parser, "in");
+    }
+}
@@ -24,11 +24,11 @@
 #ifndef WFMRX_H
 #define WFMRX_H
 
-#include <gnuradio/analog/simple_squelch_cc.h>
 #include "receivers/receiver_base.h"
 #include "dsp/rx_noise_blanker_cc.h"
 #include "dsp/rx_filter.h"
 #include "dsp/rx_meter.h"
+#include "dsp/rx_sql.h"
 #include "dsp/rx_demod_fm.h"
 #include "dsp/stereo_demod.h"
 #include "dsp/resampler_xx.h"
@@ -47,6 +47,10 @@ wfmrx_sptr make_wfmrx(float quad_rate, float audio_rate);
  *  \ingroup RX
  *
  * This block provides receiver for broadcast FM transmissions.
+ *
+ * The channel rate is an integer fraction of the input rate, so the input
+ * resampler is a polyphase decimator. The stereo decoder resamples the
+ * demodulated signal to the audio rate in one step.
  */
 class wfmrx : public receiver_base_cf
 {
@@ -70,8 +74,10 @@ public:
 
     void set_filter(double low, double high, double tw);
     void set_cw_offset(double offset) { (void)offset; }
+    void prefetch_filter(double low, double high, double tw);
 
     float get_signal_level(bool dbfs);
+    void get_signal_stats(rx_meter_stats &stats);
 
     /* Noise blanker */
     bool has_nb() { return false; }
@@ -99,32 +105,47 @@ public:
     void set_fm_maxdev(float maxdev_hz);
     void set_fm_deemph(double tau);
 
-    void get_rds_data(std::string &outbuff, int &num);
+    void get_rds_state(gr::rds::station_state &state);
     void start_rds_decoder();
     void stop_rds_decoder();
     void reset_rds_parser();
     bool is_rds_decoder_active();
+    void get_rds_stats(unsigned long &good, unsigned long &corrected,
+                       unsigned long &failed);
 
 private:
+    void create_blocks();
+    void create_audio_blocks();
+    stereo_demod_sptr audio_demod() const;
+    void connect_blocks();
+
     bool   d_running;          /*!< Whether receiver is running or not. */
     float  d_quad_rate;        /*!< Input sample rate. */
+    float  d_chan_rate;        /*!< Channel sample rate. */
     int    d_audio_rate;       /*!< Audio output rate. */
 
+    /* settings needed to recreate the blocks */
+    double d_filter_low;
+    double d_filter_high;
+    double d_filter_tw;
+    float  d_max_dev;
+    double d_tau;
+    double d_sql_level;
+    double d_sql_alpha;
+
     wfmrx_demod               d_demod;   /*!< Current demodulator. */
 
     resampler_cc_sptr         iq_resamp; /*!< Baseband resampler. */
     rx_filter_sptr            filter;    /*!< Non-translating bandpass filter.*/
 
     rx_meter_c_sptr           meter;     /*!< Signal strength. */
-    gr::analog::simple_squelch_cc::sptr sql;       /*!< Squelch. */
+    rx_sql_cc_sptr            sql;       /*!< Squelch. */
     rx_demod_fm_sptr          demod_fm;  /*!< FM demodulator. */
-    resampler_ff_sptr         midle_rr;  /*!< Resampler. */
     stereo_demod_sptr         stereo;    /*!< FM stereo demodulator. */
     stereo_demod_sptr         stereo_oirt;    /*!< FM stereo oirt demodulator. */
     stereo_demod_sptr         mono;      /*!< FM stereo demodulator OFF. */
 
     rx_rds_sptr               rds;       /*!< RDS decoder */
-    rx_rds_store_sptr         rds_store; /*!< RDS decoded messages */
     gr::rds::decoder::sptr    rds_decoder;
     gr::rds::parser::sptr     rds_parser;
     bool                      rds_enabled;